@@ -1,12 +1,29 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in vec4 fragTint;
+layout(location = 3) flat in uint fragTextureIndex;
 
 layout(location = 0) out vec4 outColor;
 
-layout(binding = 0) uniform sampler2D texSampler;
+// Every texture lives in one array, draws pick theirs by index
+layout(set = 0, binding = 0) uniform sampler2D Textures[];
+
+#ifdef OVERDRAW
+// One count per pixel. Writing it keeps depth tests from discarding fragments early,
+// so every fragment that gets rasterized is counted
+layout(set = 2, binding = 0, r32ui) uniform uimage2D OverdrawCounts;
+#endif
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord);
-}
\ No newline at end of file
+#ifdef OVERDRAW
+    uint count = imageAtomicAdd(OverdrawCounts, ivec2(gl_FragCoord.xy), 1u) + 1u;
+    // Green when shaded once, red at 8 and above
+    float heat = clamp((float(count) - 1.0) / 7.0, 0.0, 1.0);
+    outColor = vec4(heat, 1.0 - heat, 0.0, 1.0);
+#else
+    outColor = texture(Textures[nonuniformEXT(fragTextureIndex)], fragTexCoord) * fragTint;
+#endif
+}
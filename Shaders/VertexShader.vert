@@ -1,19 +1,86 @@
 #version 450
 
+#ifdef PACKED_VERTEX
+// PackedVertex, the formats unpack to floats on fetch
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec2 inTexCoord;
+// Octahedral normal, and tangent with the bitangent's sign in w
+layout(location = 3) in vec2 inNormal;
+layout(location = 4) in vec4 inTangent;
+#else
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
+#endif
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out vec4 fragTint;
+layout(location = 3) flat out uint fragTextureIndex;
+#ifdef PACKED_VERTEX
+// World space, nothing lit reads them yet
+layout(location = 4) out vec3 fragNormal;
+layout(location = 5) out vec4 fragTangent;
+#endif
 
-layout(set = 1, binding = 1) uniform UniformBufferObject {
-    mat4 model;
+// Camera, written once per frame
+layout(set = 1, binding = 1) uniform FrameData {
     mat4 view;
     mat4 proj;
-} ubo;
+    mat4 viewProj;
+} frame;
+
+#ifdef INDIRECT
+// Batched draws, must match DrawInstanceData. firstInstance of each draw is its slot in the chunk,
+// devices without drawIndirectFirstInstance push the slot as firstDraw instead
+struct DrawData {
+    mat4 model;
+    vec4 tint;
+    vec4 bounds;
+    uint textureIndex;
+    uint batchIndex;
+};
+
+layout(std430, set = 1, binding = 2) readonly buffer DrawDataBuffer {
+    DrawData draws[];
+};
+
+layout(push_constant) uniform DrawBase {
+    uint firstDraw;
+} base;
+#else
+// Per draw, must match DrawPushConstants
+layout(push_constant) uniform DrawConstants {
+    mat4 model;
+    vec4 tint;
+    uint textureIndex;
+} draw;
+#endif
+
+#ifdef PACKED_VERTEX
+// Inverse of the fold in PackVertex
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+#endif
+
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-    fragColor = inColor;
+#ifdef INDIRECT
+    DrawData draw = draws[gl_InstanceIndex + base.firstDraw];
+#endif
+    gl_Position = frame.viewProj * draw.model * vec4(inPosition.xyz, 1.0);
+    fragColor = inColor.rgb;
     fragTexCoord = inTexCoord;
-}
\ No newline at end of file
+    fragTint = draw.tint;
+    fragTextureIndex = draw.textureIndex;
+#ifdef PACKED_VERTEX
+    // Fine for uniform scale, non-uniform scale would need the inverse transpose
+    mat3 normalMatrix = mat3(draw.model);
+    fragNormal = normalize(normalMatrix * octDecode(inNormal));
+    fragTangent = vec4(normalize(normalMatrix * inTangent.xyz), inTangent.w < 0.0 ? -1.0 : 1.0);
+#endif
+}
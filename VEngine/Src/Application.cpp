@@ -8,32 +8,53 @@ namespace VEngine
     void Application::OnInit(const ApplicationSpec &InitSpec)
     {
         VENGINE_DEBUG_TIMER("Initialization!")
+        _TracePath = InitSpec.TracePath;
+        Trace::SetEnabled(!_TracePath.empty());
+        _Headless = InitSpec.Headless;
+        _HeadlessFrames = InitSpec.HeadlessFrames;
 
-        VEngine::WindowData Data;
-        Data.Name = InitSpec.Name;
-        Data.Dimensions = InitSpec.Dimensions;
-        Data.VSync = InitSpec.VSync;
+        if (!_Headless)
+        {
+            VEngine::WindowData Data;
+            Data.Name = InitSpec.Name;
+            Data.Dimensions = InitSpec.Dimensions;
+            Data.VSync = InitSpec.VSync;
 
-        _Window.Init(Data);
-        _Window.SetEventCallback(VENGINE_EVENT_CALLBACK_FN(OnEvent));
+            _Window.Init(Data);
+            _Window.SetEventCallback(VENGINE_EVENT_CALLBACK_FN(OnEvent));
 
-        Input::Init(_Window.GetRawHandle());
+            Input::Init(_Window.GetRawHandle());
+        }
 
         {
             VENGINE_DEBUG_TIMER("Vulkan Init")
             RendererInitSpec RenderSpec;
             RenderSpec.Type = RenderAPIType::VULKAN;
             RenderSpec.window = &_Window;
-            RenderSpec.FramesInFlightCount = 2;
+            RenderSpec.Headless = _Headless;
+            RenderSpec.HeadlessWidth = (int)InitSpec.Dimensions.x;
+            RenderSpec.HeadlessHeight = (int)InitSpec.Dimensions.y;
+            RenderSpec.FramesInFlightCount = InitSpec.FramesInFlight;
+            RenderSpec.PreferredPresentMode = InitSpec.VSync ? PresentMode::FIFO : PresentMode::MAILBOX;
+            RenderSpec.MaxFrameRate = InitSpec.MaxFrameRate;
             Renderer::Init(RenderSpec);
         }
     }
 
     void Application::OnUpdate()
     {
-        while (!_Window.ShouldClose())
+        uint64_t Frame = 0;
+        while (_Running)
         {
-            _Window.PollEvents();
+            if (_Headless ? (_HeadlessFrames > 0 && Frame >= _HeadlessFrames) : _Window.ShouldClose())
+                break;
+            Frame++;
+
+            VENGINE_TRACE_SCOPE("Frame")
+            // Before polling, so the frame works with the freshest input
+            Renderer::WaitForNextFrame();
+            if (!_Headless)
+                _Window.PollEvents();
             auto Startime = GetWindowTime();
             TimeStep ts = Startime - _LastTime;
             _LastTime = Startime;
@@ -41,7 +62,8 @@ namespace VEngine
             for (auto layer : _Stack)
                 layer->OnUpdate(ts);
 
-            _Window.SwapBuffers();
+            if (!_Headless)
+                _Window.SwapBuffers();
         }
     }
 
@@ -52,8 +74,14 @@ namespace VEngine
 
         _Stack.Flush();
         Renderer::Terminate();
-        Input::ShutDown();
-        _Window.Terminate();
+        if (!_Headless)
+        {
+            Input::ShutDown();
+            _Window.Terminate();
+        }
+
+        if (!_TracePath.empty() && Trace::WriteChromeTrace(_TracePath))
+            VENGINE_CORE_PRINTLN("Trace written to " << _TracePath)
     }
 
     void Application::OnEvent(Event &e)
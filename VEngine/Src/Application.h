@@ -8,7 +8,18 @@ namespace VEngine
     {
         std::string Name;
         Vec2 Dimensions;
+        // Fifo when set, mailbox otherwise
         bool VSync = false;
+        // Frames per second, 0 is unlimited
+        float MaxFrameRate = 0.0f;
+        // Frames the cpu may record ahead of the gpu
+        int FramesInFlight = 2;
+        // Cpu and gpu scopes are traced and written here as a chrome trace on terminate, empty is off
+        std::string TracePath;
+        // No window or input, frames of Dimensions go to offscreen images. OnUpdate returns after
+        // HeadlessFrames frames, 0 runs until Close
+        bool Headless = false;
+        uint64_t HeadlessFrames = 0;
     };
 
     class Application
@@ -26,10 +37,16 @@ namespace VEngine
         void OnEvent(Event &e);
 
         void PushLayer(std::shared_ptr<Layer> layer) { _Stack.PushLayer(layer); }
+        // OnUpdate returns after the current frame
+        void Close() { _Running = false; }
 
     private:
         Window _Window;
         LayerStack _Stack;
         double _LastTime = 0.0f;
+        std::string _TracePath;
+        bool _Headless = false;
+        uint64_t _HeadlessFrames = 0;
+        bool _Running = true;
     };
 } // namespace VEngine
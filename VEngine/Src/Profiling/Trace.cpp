@@ -0,0 +1,90 @@
+#include "VePCH.h"
+#include "Trace.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+namespace VEngine
+{
+    // A long capture is capped instead of growing forever
+    static constexpr size_t MAX_TRACE_EVENTS = 1 << 20;
+
+    static std::mutex s_TraceMutex;
+    static std::vector<TraceEvent> s_TraceEvents;
+    static std::atomic<bool> s_TraceEnabled = false;
+    static std::atomic<uint32_t> s_NextThreadId = 0;
+
+    double Trace::NowUs()
+    {
+        static const auto Epoch = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - Epoch).count();
+    }
+
+    void Trace::SetEnabled(bool Enabled)
+    {
+        s_TraceEnabled = Enabled;
+    }
+
+    bool Trace::IsEnabled()
+    {
+        return s_TraceEnabled;
+    }
+
+    void Trace::AddEvent(const TraceEvent &Event)
+    {
+        if (!s_TraceEnabled)
+            return;
+
+        std::lock_guard<std::mutex> Lock(s_TraceMutex);
+        if (s_TraceEvents.size() < MAX_TRACE_EVENTS)
+            s_TraceEvents.push_back(Event);
+    }
+
+    uint32_t Trace::GetThreadId()
+    {
+        thread_local uint32_t Id = s_NextThreadId++;
+        return Id;
+    }
+
+    void Trace::Clear()
+    {
+        std::lock_guard<std::mutex> Lock(s_TraceMutex);
+        s_TraceEvents.clear();
+    }
+
+    static void WriteEscaped(std::ofstream &File, const std::string &Text)
+    {
+        for (char c : Text)
+        {
+            if (c == '"' || c == '\\')
+                File << '\\';
+            File << c;
+        }
+    }
+
+    bool Trace::WriteChromeTrace(const std::string &Path)
+    {
+        std::ofstream File(Path, std::ios::trunc);
+        if (!File.is_open())
+            return false;
+
+        std::lock_guard<std::mutex> Lock(s_TraceMutex);
+        File << "{\"traceEvents\":[\n";
+        File << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+        File << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+
+        File.precision(3);
+        File << std::fixed;
+        for (auto &Event : s_TraceEvents)
+        {
+            File << ",\n{\"name\":\"";
+            WriteEscaped(File, Event.Name);
+            File << "\",\"ph\":\"X\",\"ts\":" << Event.StartUs << ",\"dur\":" << Event.DurationUs
+                 << ",\"pid\":" << uint32_t(Event.Process) << ",\"tid\":" << Event.Thread << "}";
+        }
+        File << "\n]}\n";
+        return true;
+    }
+} // namespace VEngine
@@ -0,0 +1,70 @@
+#pragma once
+
+/*
+    Cpu scopes and gpu timings on one timeline, written out as a chrome trace (chrome://tracing or ui.perfetto.dev).
+*/
+
+namespace VEngine
+{
+    enum class TraceProcess : uint32_t
+    {
+        CPU = 0,
+        GPU = 1
+    };
+
+    struct TraceEvent
+    {
+        std::string Name;
+        // Microseconds on the trace clock, see Trace::NowUs
+        double StartUs = 0.0;
+        double DurationUs = 0.0;
+        TraceProcess Process = TraceProcess::CPU;
+        uint32_t Thread = 0;
+    };
+
+    class Trace
+    {
+    public:
+        // Steady clock, counted from the first time anything asks for it
+        static double NowUs();
+
+        // Off by default, events are dropped until enabled
+        static void SetEnabled(bool Enabled);
+        static bool IsEnabled();
+
+        static void AddEvent(const TraceEvent &Event);
+        // Small id for the calling thread, stable for the life of the thread
+        static uint32_t GetThreadId();
+        static void Clear();
+
+        static bool WriteChromeTrace(const std::string &Path);
+    };
+
+    class TraceScope
+    {
+    public:
+        TraceScope(const char *Name)
+            : _Name(Name), _Start(Trace::NowUs())
+        {
+        }
+
+        ~TraceScope()
+        {
+            if (!Trace::IsEnabled())
+                return;
+
+            TraceEvent Event;
+            Event.Name = _Name;
+            Event.StartUs = _Start;
+            Event.DurationUs = Trace::NowUs() - _Start;
+            Event.Thread = Trace::GetThreadId();
+            Trace::AddEvent(Event);
+        }
+
+    private:
+        const char *_Name;
+        double _Start;
+    };
+} // namespace VEngine
+
+#define VENGINE_TRACE_SCOPE(Name) VEngine::TraceScope _TraceScope(Name);
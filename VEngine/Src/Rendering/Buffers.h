@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
 #include "UUID/UUID.h"
 
 namespace VEngine
@@ -12,6 +13,50 @@ namespace VEngine
         glm::vec2 tex;
     };
 
+    // Half float position and uv, octahedral normal, 8 bit tangent and color, 24 bytes instead of 32
+    struct PackedVertex
+    {
+        uint16_t pos[4];
+        int16_t normal[2];
+        // xyz direction, w the bitangent's sign
+        int8_t tangent[4];
+        uint16_t tex[2];
+        uint32_t color;
+    };
+
+    // How a mesh stores its vertices, every format has its own pipelines
+    enum class VertexFormat
+    {
+        // Vertex
+        STANDARD,
+        // PackedVertex
+        PACKED,
+        COUNT
+    };
+
+    inline PackedVertex PackVertex(const glm::vec3 &Pos, const glm::vec3 &Normal, const glm::vec2 &Tex, const glm::vec4 &Color,
+                                   const glm::vec4 &Tangent = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f))
+    {
+        PackedVertex v;
+        uint64_t HalfPos = glm::packHalf4x16(glm::vec4(Pos, 1.0f));
+        memcpy(v.pos, &HalfPos, sizeof(v.pos));
+
+        // Octahedral, the normal is projected onto an octahedron that is unfolded into a square
+        glm::vec2 Oct = glm::vec2(Normal) / (glm::abs(Normal.x) + glm::abs(Normal.y) + glm::abs(Normal.z));
+        if (Normal.z < 0.0f)
+            Oct = (1.0f - glm::abs(glm::vec2(Oct.y, Oct.x))) * glm::vec2(Oct.x >= 0.0f ? 1.0f : -1.0f, Oct.y >= 0.0f ? 1.0f : -1.0f);
+        uint32_t PackedNormal = glm::packSnorm2x16(Oct);
+        memcpy(v.normal, &PackedNormal, sizeof(v.normal));
+
+        uint32_t PackedTangent = glm::packSnorm4x8(glm::vec4(glm::vec3(Tangent), Tangent.w < 0.0f ? -1.0f : 1.0f));
+        memcpy(v.tangent, &PackedTangent, sizeof(v.tangent));
+
+        uint32_t HalfTex = glm::packHalf2x16(Tex);
+        memcpy(v.tex, &HalfTex, sizeof(v.tex));
+        v.color = glm::packUnorm4x8(Color);
+        return v;
+    }
+
     enum class IndexBufferType
     {
         UINT_8,
@@ -33,6 +78,7 @@ namespace VEngine
         void *Data;
         int SizeInBytes;
         int32_t Count = 0;
+        VertexFormat Format = VertexFormat::STANDARD;
     };
 
     struct IndexBufferDesc
@@ -55,12 +101,14 @@ namespace VEngine
         const UUID &ID() const { return _ID; }
         uint32_t GetSize() const { return _Size; }
         int32_t GetCoutn() const { return _Count; }
+        VertexFormat GetFormat() const { return _Format; }
 
     protected:
         UUID _ID;
         // Size in bytes of the buffer
         uint32_t _Size = 0;
         int32_t _Count = 0;
+        VertexFormat _Format = VertexFormat::STANDARD;
     };
 
     class IndexBuffer
@@ -83,4 +131,28 @@ namespace VEngine
         int32_t _Count = 0;
         IndexBufferType _DataType;
     };
+
+    struct TextureDesc
+    {
+        // KTX2 or DDS with a full mip chain, streamed in from the smallest mips up
+        std::string Path;
+    };
+
+    class Texture
+    {
+    public:
+        Texture() {}
+        virtual ~Texture() {}
+
+        const UUID &ID() const { return _ID; }
+        // Zero until the file was first read
+        uint32_t GetWidth() const { return _Width; }
+        uint32_t GetHeight() const { return _Height; }
+        uint32_t GetMipLevels() const { return _MipLevels; }
+
+    protected:
+        UUID _ID;
+        uint32_t _Width = 0, _Height = 0;
+        uint32_t _MipLevels = 0;
+    };
 } // namespace VEngine
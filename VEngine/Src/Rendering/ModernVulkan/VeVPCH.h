@@ -11,4 +11,21 @@
 #include <functional>
 #include <string.h>
 #include <optional>
+#include <mutex>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <future>
 
+#define PRINTLN(x)              \
+    {                           \
+        std::cout << x << "\n"; \
+    }
+#define VULKAN_SUCCESS_ASSERT(x, errmsg)      \
+    {                                         \
+        if (x != VK_SUCCESS)                  \
+            throw std::runtime_error(errmsg); \
+    }
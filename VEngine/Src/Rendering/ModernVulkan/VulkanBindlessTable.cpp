@@ -0,0 +1,140 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanBindlessTable.h"
+
+namespace VEngine
+{
+    void VulkanBindlessTable::Init(const VulkanBindlessTableSpec &Spec)
+    {
+        _Device = Spec.device;
+
+        VkPhysicalDeviceVulkan12Properties props12{};
+        props12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+        VkPhysicalDeviceProperties2 props{};
+        props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        props.pNext = &props12;
+        vkGetPhysicalDeviceProperties2(Spec.PhysicalDevice, &props);
+
+        _Capacity = std::min({Spec.MaxTextures, props12.maxPerStageDescriptorUpdateAfterBindSamplers,
+                              props12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                              props12.maxDescriptorSetUpdateAfterBindSampledImages,
+                              props12.maxDescriptorSetUpdateAfterBindSamplers});
+
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding = 0;
+        binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        binding.descriptorCount = _Capacity;
+        binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        // Slots can be written while the set is bound and unused ones never have to be valid
+        VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                                VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+        flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        flagsInfo.bindingCount = 1;
+        flagsInfo.pBindingFlags = &bindingFlags;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        layoutInfo.bindingCount = 1;
+        layoutInfo.pBindings = &binding;
+        layoutInfo.pNext = &flagsInfo;
+
+        VULKAN_SUCCESS_ASSERT(vkCreateDescriptorSetLayout(_Device, &layoutInfo, nullptr, &_Layout), "Bindless Layout Failed!");
+
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSize.descriptorCount = _Capacity;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        poolInfo.maxSets = 1;
+
+        VULKAN_SUCCESS_ASSERT(vkCreateDescriptorPool(_Device, &poolInfo, nullptr, &_Pool), "Bindless Pool Failed!");
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = _Pool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &_Layout;
+
+        VULKAN_SUCCESS_ASSERT(vkAllocateDescriptorSets(_Device, &allocInfo, &_Set), "Bindless Set Failed!");
+        PRINTLN("[VULKAN]: Bindless Table Created with " << _Capacity << " texture slots");
+    }
+
+    void VulkanBindlessTable::Destroy()
+    {
+        // Set goes with the pool
+        vkDestroyDescriptorPool(_Device, _Pool, nullptr);
+        vkDestroyDescriptorSetLayout(_Device, _Layout, nullptr);
+        _FreeIndices.clear();
+        _Next = _Count = 0;
+    }
+
+    uint32_t VulkanBindlessTable::Register(VkImageView View, VkSampler Sampler)
+    {
+        uint32_t Index;
+        {
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            if (!_FreeIndices.empty())
+            {
+                Index = _FreeIndices.back();
+                _FreeIndices.pop_back();
+            }
+            else if (_Next < _Capacity)
+                Index = _Next++;
+            else
+                throw std::runtime_error("Bindless Table is full!");
+            _Count++;
+        }
+
+        _Write(Index, View, Sampler);
+        return Index;
+    }
+
+    void VulkanBindlessTable::Update(uint32_t Index, VkImageView View, VkSampler Sampler)
+    {
+        _Write(Index, View, Sampler);
+    }
+
+    void VulkanBindlessTable::Release(uint32_t Index)
+    {
+        if (Index == INVALID_INDEX)
+            return;
+
+        std::lock_guard<std::mutex> Lock(_Mutex);
+        _FreeIndices.push_back(Index);
+        _Count--;
+    }
+
+    void VulkanBindlessTable::_Write(uint32_t Index, VkImageView View, VkSampler Sampler)
+    {
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = View;
+        imageInfo.sampler = Sampler;
+
+        VkWriteDescriptorSet descriptorWrite{};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = _Set;
+        descriptorWrite.dstBinding = 0;
+        descriptorWrite.dstArrayElement = Index;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pImageInfo = &imageInfo;
+
+        vkUpdateDescriptorSets(_Device, 1, &descriptorWrite, 0, nullptr);
+    }
+} // namespace VEngine
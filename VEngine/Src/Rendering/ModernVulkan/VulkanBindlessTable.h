@@ -0,0 +1,53 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanBindlessTableSpec
+    {
+        VkDevice device;
+        VkPhysicalDevice PhysicalDevice;
+        // Clamped to what the device allows for update after bind samplers
+        uint32_t MaxTextures = 16 * 1024;
+    };
+
+    // One descriptor set holding every texture in a single partially bound sampler array.
+    // Textures keep their index for life, shaders pick one through push constants
+    class VulkanBindlessTable
+    {
+    public:
+        static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+        VulkanBindlessTable() {}
+        ~VulkanBindlessTable() {}
+
+        void Init(const VulkanBindlessTableSpec &Spec);
+        void Destroy();
+
+        // Writes the texture into a free slot and returns its index
+        uint32_t Register(VkImageView View, VkSampler Sampler);
+        // Points an existing slot at a new view, index seen by shaders stays the same
+        void Update(uint32_t Index, VkImageView View, VkSampler Sampler);
+        // Slot may be handed out again, the caller makes sure no frame in flight still reads it
+        void Release(uint32_t Index);
+
+        VkDescriptorSetLayout GetLayout() const { return _Layout; }
+        VkDescriptorSet GetSet() const { return _Set; }
+        uint32_t GetCapacity() const { return _Capacity; }
+        uint32_t GetCount() const { return _Count; }
+
+    private:
+        void _Write(uint32_t Index, VkImageView View, VkSampler Sampler);
+
+    private:
+        VkDevice _Device = VK_NULL_HANDLE;
+        VkDescriptorSetLayout _Layout = VK_NULL_HANDLE;
+        VkDescriptorPool _Pool = VK_NULL_HANDLE;
+        VkDescriptorSet _Set = VK_NULL_HANDLE;
+
+        uint32_t _Capacity = 0;
+        uint32_t _Next = 0;
+        uint32_t _Count = 0;
+        std::vector<uint32_t> _FreeIndices;
+        std::mutex _Mutex;
+    };
+} // namespace VEngine
@@ -0,0 +1,174 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanCommandRecorder.h"
+
+namespace VEngine
+{
+    void VulkanCommandRecorder::Init(const VulkanCommandRecorderSpec &Spec)
+    {
+        _Spec = Spec;
+        if (_Spec.ThreadCount == 0)
+            _Spec.ThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+        _Pools.resize(_Spec.FrameCount);
+        for (auto &FramePools : _Pools)
+        {
+            FramePools.resize(_Spec.ThreadCount);
+            for (auto &Pool : FramePools)
+            {
+                VkCommandPoolCreateInfo poolInfo{};
+                poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+                poolInfo.queueFamilyIndex = _Spec.QueueFamilyIndex;
+                // Reset as a whole every frame
+                poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+                VULKAN_SUCCESS_ASSERT(vkCreateCommandPool(_Spec.device, &poolInfo, nullptr, &Pool.Pool), "Recorder Command Pool Failed!");
+            }
+        }
+
+        for (uint32_t i = 1; i < _Spec.ThreadCount; i++)
+            _Workers.emplace_back(&VulkanCommandRecorder::_WorkerLoop, this, i);
+
+        PRINTLN("[VULKAN]: Command Recorder Created with " << _Spec.ThreadCount << " threads");
+    }
+
+    void VulkanCommandRecorder::Destroy()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            _Quit = true;
+        }
+        _Wake.notify_all();
+        for (auto &Worker : _Workers)
+            Worker.join();
+        _Workers.clear();
+
+        // Buffers go with their pools
+        for (auto &FramePools : _Pools)
+            for (auto &Pool : FramePools)
+                vkDestroyCommandPool(_Spec.device, Pool.Pool, nullptr);
+        _Pools.clear();
+    }
+
+    const std::vector<VkCommandBuffer> &VulkanCommandRecorder::Record(int Frame, const VkCommandBufferInheritanceRenderingInfo &Rendering, uint32_t JobCount, const RecordFn &Fn,
+                                                                      VkQueryPipelineStatisticFlags Statistics)
+    {
+        for (auto &Pool : _Pools[Frame])
+        {
+            vkResetCommandPool(_Spec.device, Pool.Pool, 0);
+            Pool.Used = 0;
+        }
+
+        _Recorded.assign(JobCount, VK_NULL_HANDLE);
+        _Frame = Frame;
+        _JobCount = JobCount;
+        _Fn = &Fn;
+        _Error = nullptr;
+
+        _Rendering = Rendering;
+        _Inheritance = {};
+        _Inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        _Inheritance.pNext = &_Rendering;
+        _Inheritance.pipelineStatistics = Statistics;
+        _NextJob = 0;
+
+        // Not worth waking anyone for a single job
+        bool Wake = JobCount > 1 && !_Workers.empty();
+        if (Wake)
+        {
+            {
+                std::lock_guard<std::mutex> Lock(_Mutex);
+                _Busy = (uint32_t)_Workers.size();
+                _Generation++;
+            }
+            _Wake.notify_all();
+        }
+
+        _RunJobs(0);
+
+        if (Wake)
+        {
+            std::unique_lock<std::mutex> Lock(_Mutex);
+            _Done.wait(Lock, [this]
+                       { return _Busy == 0; });
+        }
+
+        if (_Error)
+            std::rethrow_exception(_Error);
+        return _Recorded;
+    }
+
+    void VulkanCommandRecorder::_WorkerLoop(uint32_t Thread)
+    {
+        uint64_t Seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> Lock(_Mutex);
+                _Wake.wait(Lock, [&]
+                           { return _Quit || _Generation != Seen; });
+                if (_Quit)
+                    return;
+                Seen = _Generation;
+            }
+
+            _RunJobs(Thread);
+
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            if (--_Busy == 0)
+                _Done.notify_one();
+        }
+    }
+
+    void VulkanCommandRecorder::_RunJobs(uint32_t Thread)
+    {
+        try
+        {
+            for (uint32_t Job = _NextJob++; Job < _JobCount; Job = _NextJob++)
+            {
+                VkCommandBuffer Cmd = _Acquire(Thread);
+
+                VkCommandBufferBeginInfo beginInfo{};
+                beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+                beginInfo.pInheritanceInfo = &_Inheritance;
+
+                vkBeginCommandBuffer(Cmd, &beginInfo);
+                (*_Fn)(Cmd, Job);
+                vkEndCommandBuffer(Cmd);
+
+                _Recorded[Job] = Cmd;
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            if (!_Error)
+                _Error = std::current_exception();
+        }
+    }
+
+    VkCommandBuffer VulkanCommandRecorder::_Acquire(uint32_t Thread)
+    {
+        auto &Pool = _Pools[_Frame][Thread];
+        if (Pool.Used == Pool.Buffers.size())
+        {
+            VkCommandBufferAllocateInfo info{};
+            info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            info.commandPool = Pool.Pool;
+            info.commandBufferCount = 1;
+            info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+            VkCommandBuffer Cmd;
+            VULKAN_SUCCESS_ASSERT(vkAllocateCommandBuffers(_Spec.device, &info, &Cmd), "Secondary Command Buffer Failed!");
+            Pool.Buffers.push_back(Cmd);
+        }
+        return Pool.Buffers[Pool.Used++];
+    }
+} // namespace VEngine
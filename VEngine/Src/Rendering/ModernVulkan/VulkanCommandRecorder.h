@@ -0,0 +1,71 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanCommandRecorderSpec
+    {
+        VkDevice device;
+        uint32_t QueueFamilyIndex;
+        int FrameCount = 2;
+        // Calling thread included, 0 picks the core count
+        uint32_t ThreadCount = 0;
+    };
+
+    // Records secondary command buffers in parallel. Every thread owns a command pool per frame
+    // in flight so nothing is shared while recording, the calling thread works as thread 0.
+    // Jobs are handed out in any order but come back in job order so the primary always
+    // executes them the same way
+    class VulkanCommandRecorder
+    {
+    public:
+        using RecordFn = std::function<void(VkCommandBuffer Cmd, uint32_t Job)>;
+
+        VulkanCommandRecorder() {}
+        ~VulkanCommandRecorder() {}
+
+        void Init(const VulkanCommandRecorderSpec &Spec);
+        void Destroy();
+
+        // Only call once the gpu is done with Frame, resets all of its pools. Returns one ended
+        // secondary per job, ready for vkCmdExecuteCommands inside rendering described by Rendering.
+        // Statistics has to match a pipeline statistics query open in the primary, needs inheritedQueries
+        const std::vector<VkCommandBuffer> &Record(int Frame, const VkCommandBufferInheritanceRenderingInfo &Rendering, uint32_t JobCount, const RecordFn &Fn,
+                                                   VkQueryPipelineStatisticFlags Statistics = 0);
+
+        uint32_t GetThreadCount() const { return _Spec.ThreadCount; }
+
+    private:
+        void _WorkerLoop(uint32_t Thread);
+        void _RunJobs(uint32_t Thread);
+        VkCommandBuffer _Acquire(uint32_t Thread);
+
+    private:
+        struct ThreadPool
+        {
+            VkCommandPool Pool;
+            std::vector<VkCommandBuffer> Buffers;
+            uint32_t Used = 0;
+        };
+
+        VulkanCommandRecorderSpec _Spec;
+        // [Frame][Thread]
+        std::vector<std::vector<ThreadPool>> _Pools;
+        std::vector<VkCommandBuffer> _Recorded;
+
+        std::vector<std::thread> _Workers;
+        std::mutex _Mutex;
+        std::condition_variable _Wake, _Done;
+        uint64_t _Generation = 0;
+        uint32_t _Busy = 0;
+        bool _Quit = false;
+        std::exception_ptr _Error;
+
+        // What the current Record call is working on
+        std::atomic<uint32_t> _NextJob{0};
+        int _Frame = 0;
+        uint32_t _JobCount = 0;
+        const RecordFn *_Fn = nullptr;
+        VkCommandBufferInheritanceRenderingInfo _Rendering;
+        VkCommandBufferInheritanceInfo _Inheritance;
+    };
+} // namespace VEngine
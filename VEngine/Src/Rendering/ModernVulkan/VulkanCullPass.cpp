@@ -0,0 +1,150 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanResourceFactory.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanShader.h"
+#include "VulkanLinearAllocator.h"
+#include "VulkanDrawBatcher.h"
+#include "VulkanCullPass.h"
+
+namespace VEngine
+{
+    static constexpr uint32_t CULL_GROUP_SIZE = 64;
+
+    enum CullBindings
+    {
+        CULL_DRAW_DATA,
+        CULL_INPUT_COMMANDS,
+        CULL_OUTPUT_COMMANDS,
+        CULL_BATCH_INFO,
+        CULL_BINDING_COUNT
+    };
+
+    // Gribb/Hartmann, planes point inwards. Vulkan depth is 0..w so near is just the z row
+    static void ExtractFrustumPlanes(const glm::mat4 &M, glm::vec4 Planes[6])
+    {
+        glm::vec4 Row[4];
+        for (int i = 0; i < 4; i++)
+            Row[i] = glm::vec4(M[0][i], M[1][i], M[2][i], M[3][i]);
+
+        Planes[0] = Row[3] + Row[0];
+        Planes[1] = Row[3] - Row[0];
+        Planes[2] = Row[3] + Row[1];
+        Planes[3] = Row[3] - Row[1];
+        Planes[4] = Row[2];
+        Planes[5] = Row[3] - Row[2];
+
+        for (int i = 0; i < 6; i++)
+            Planes[i] /= glm::length(glm::vec3(Planes[i]));
+    }
+
+    void VulkanCullPass::Init(const VulkanCullPassSpec &Spec)
+    {
+        _Device = Spec.device;
+        _Compact = Spec.Compact;
+        _MaxDraws = Spec.MaxDraws;
+
+        VkDescriptorSetLayoutBinding bindings[CULL_BINDING_COUNT]{};
+        for (uint32_t i = 0; i < CULL_BINDING_COUNT; i++)
+        {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = CULL_BINDING_COUNT;
+        layoutInfo.pBindings = bindings;
+        VULKAN_SUCCESS_ASSERT(vkCreateDescriptorSetLayout(_Device, &layoutInfo, nullptr, &_Layout), "Cull Layout Failed!");
+
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+        poolSize.descriptorCount = CULL_BINDING_COUNT;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        poolInfo.maxSets = 1;
+        VULKAN_SUCCESS_ASSERT(vkCreateDescriptorPool(_Device, &poolInfo, nullptr, &_Pool), "Cull Pool Failed!");
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = _Pool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &_Layout;
+        VULKAN_SUCCESS_ASSERT(vkAllocateDescriptorSets(_Device, &allocInfo, &_Set), "Cull Set Failed!");
+        SetBuffer(Spec.Buffer);
+
+        VulkanComputePipelineSpec PipelineSpec{};
+        PipelineSpec.Shader = Spec.Shader;
+        PipelineSpec.device = _Device;
+        PipelineSpec.Name = "frustum_cull";
+        PipelineSpec.DescLayouts = {_Layout};
+        PipelineSpec.PushConstantRanges = {{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants)}};
+        PipelineSpec.Cache = Spec.Cache;
+        _Pipeline.Init(PipelineSpec);
+
+        PRINTLN("[VULKAN]: Cull Pass Created" << (_Compact ? " with compaction" : ""));
+    }
+
+    void VulkanCullPass::SetBuffer(VkBuffer Buffer)
+    {
+        // Everything points at the frame allocator, the frame's offsets pick the data at bind time
+        VkDeviceSize Ranges[CULL_BINDING_COUNT] = {sizeof(DrawInstanceData) * _MaxDraws, sizeof(VkDrawIndexedIndirectCommand) * _MaxDraws,
+                                                   sizeof(VkDrawIndexedIndirectCommand) * _MaxDraws, sizeof(DrawBatchInfo) * _MaxDraws};
+        VkDescriptorBufferInfo bufferInfos[CULL_BINDING_COUNT]{};
+        VkWriteDescriptorSet descriptorWrites[CULL_BINDING_COUNT]{};
+        for (uint32_t i = 0; i < CULL_BINDING_COUNT; i++)
+        {
+            bufferInfos[i].buffer = Buffer;
+            bufferInfos[i].offset = 0;
+            bufferInfos[i].range = Ranges[i];
+
+            descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[i].dstSet = _Set;
+            descriptorWrites[i].dstBinding = i;
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(_Device, CULL_BINDING_COUNT, descriptorWrites, 0, nullptr);
+    }
+
+    void VulkanCullPass::Destroy()
+    {
+        _Pipeline.Destroy(_Device);
+        vkDestroyDescriptorPool(_Device, _Pool, nullptr);
+        vkDestroyDescriptorSetLayout(_Device, _Layout, nullptr);
+    }
+
+    void VulkanCullPass::Record(VkCommandBuffer Cmd, const std::vector<VulkanBatchFrame> &Frames, const glm::mat4 &ViewProj)
+    {
+        if (Frames.empty())
+            return;
+
+        CullPushConstants Constants{};
+        ExtractFrustumPlanes(ViewProj, Constants.Planes);
+        Constants.Compact = _Compact;
+
+        // One dispatch per chunk, each sees only its own slots
+        vkCmdBindPipeline(Cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _Pipeline.GetHandle());
+        for (auto &Frame : Frames)
+        {
+            Constants.DrawCount = Frame.DrawCount;
+            uint32_t Offsets[CULL_BINDING_COUNT] = {Frame.DrawDataOffset, Frame.CommandOffset, Frame.DrawCommandOffset, Frame.BatchInfoOffset};
+            vkCmdBindDescriptorSets(Cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _Pipeline.GetLayout(), 0, 1, &_Set, CULL_BINDING_COUNT, Offsets);
+            vkCmdPushConstants(Cmd, _Pipeline.GetLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Constants), &Constants);
+            vkCmdDispatch(Cmd, (Frame.DrawCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+        }
+    }
+} // namespace VEngine
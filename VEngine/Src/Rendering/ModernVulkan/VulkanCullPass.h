@@ -0,0 +1,51 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanCullPassSpec
+    {
+        VkDevice device;
+        Ref<VulkanShader> Shader;
+        VulkanPipelineCache *Cache = nullptr;
+        // Frame allocator buffer every batch frame lives in
+        VkBuffer Buffer;
+        uint32_t MaxDraws = 16 * 1024;
+        // Survivors are packed to the front of their call and counted, needs drawIndirectCount.
+        // Without it culled commands just get an instanceCount of 0
+        bool Compact = false;
+    };
+
+    // Must match the push_constant block in FrustumCull.comp
+    struct CullPushConstants
+    {
+        glm::vec4 Planes[6];
+        uint32_t DrawCount;
+        uint32_t Compact;
+    };
+
+    // Compute pass testing every batched draw's bounding sphere against the camera frustum
+    // and writing the commands the indirect calls read, the cpu never looks at the bounds
+    class VulkanCullPass
+    {
+    public:
+        VulkanCullPass() {}
+        ~VulkanCullPass() {}
+
+        void Init(const VulkanCullPassSpec &Spec);
+        void Destroy();
+
+        // Points the set at a new frame allocator buffer, nothing using the old one may be in flight
+        void SetBuffer(VkBuffer Buffer);
+        // Has to be recorded outside of rendering, the indirect calls need a barrier after it
+        void Record(VkCommandBuffer Cmd, const std::vector<VulkanBatchFrame> &Frames, const glm::mat4 &ViewProj);
+
+    private:
+        VkDevice _Device;
+        bool _Compact = false;
+        uint32_t _MaxDraws;
+        VkDescriptorSetLayout _Layout;
+        VkDescriptorPool _Pool;
+        VkDescriptorSet _Set;
+        VulkanComputePipeline _Pipeline;
+    };
+} // namespace VEngine
@@ -0,0 +1,167 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanResourceFactory.h"
+#include "VulkanStagingRing.h"
+#include "VulkanUploadManager.h"
+#include "VulkanDefragmenter.h"
+
+namespace VEngine
+{
+    void VulkanDefragmenter::Init(const VulkanDefragmenterSpec &Spec)
+    {
+        _Spec = Spec;
+        _Spec.CheckInterval = std::max(_Spec.CheckInterval, 1u);
+        PRINTLN("[VULKAN]: Defragmenter Created");
+    }
+
+    void VulkanDefragmenter::Destroy()
+    {
+        // Device is idle, an open pass can end and an unfinished run is dropped where it is
+        Finish(UINT64_MAX);
+        if (_Context != VK_NULL_HANDLE)
+            _End();
+    }
+
+    bool VulkanDefragmenter::_IsFragmented()
+    {
+        VmaTotalStatistics Stats;
+        vmaCalculateStatistics(_Spec.Allocator, &Stats);
+        const VkPhysicalDeviceMemoryProperties *Props;
+        vmaGetMemoryProperties(_Spec.Allocator, &Props);
+
+        VkDeviceSize BlockBytes = 0, AllocationBytes = 0;
+        for (uint32_t i = 0; i < Props->memoryHeapCount; i++)
+        {
+            if (!(Props->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+                continue;
+            BlockBytes += Stats.memoryHeap[i].statistics.blockBytes;
+            AllocationBytes += Stats.memoryHeap[i].statistics.allocationBytes;
+        }
+
+        VkDeviceSize FreeBytes = BlockBytes - AllocationBytes;
+        return BlockBytes > 0 && FreeBytes >= _Spec.MinFreeBytes && (float)FreeBytes / BlockBytes >= _Spec.MinFragmentation;
+    }
+
+    void VulkanDefragmenter::_Begin()
+    {
+        VmaDefragmentationInfo Info{};
+        Info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+        Info.maxBytesPerPass = _Spec.MaxBytesPerPass;
+        Info.maxAllocationsPerPass = _Spec.MaxMovesPerPass;
+
+        VULKAN_SUCCESS_ASSERT(vmaBeginDefragmentation(_Spec.Allocator, &Info, &_Context), "Defragmentation Begin Failed!");
+        _PassCount = 0;
+    }
+
+    void VulkanDefragmenter::_End()
+    {
+        VmaDefragmentationStats Stats{};
+        vmaEndDefragmentation(_Spec.Allocator, _Context, &Stats);
+        _Context = VK_NULL_HANDLE;
+
+        _Moves += Stats.allocationsMoved;
+        _BytesMoved += Stats.bytesMoved;
+        if (Stats.allocationsMoved > 0)
+            PRINTLN("[VULKAN]: Defragmentation moved " << Stats.allocationsMoved << " buffers, freed " << Stats.bytesFreed / 1024 << " KB");
+    }
+
+    void VulkanDefragmenter::Finish(uint64_t CompletedValue)
+    {
+        if (!_PassOpen || CompletedValue < _PassValue)
+            return;
+
+        for (auto Buffer : _OldBuffers)
+            vkDestroyBuffer(_Spec.device, Buffer, nullptr);
+        _OldBuffers.clear();
+        _PassOpen = false;
+
+        // Incomplete means there is more, the next Step carries on
+        VkResult Result = vmaEndDefragmentationPass(_Spec.Allocator, _Context, &_Pass);
+        if (Result == VK_SUCCESS || _PassCount >= _Spec.MaxPasses)
+            _End();
+    }
+
+    void VulkanDefragmenter::Step(VkCommandBuffer Cmd, uint64_t FrameValue)
+    {
+        if (_PassOpen)
+            return;
+
+        if (_Context == VK_NULL_HANDLE)
+        {
+            bool Check = ++_Frame % _Spec.CheckInterval == 0;
+            if (!_Requested && !Check)
+                return;
+            _Requested = false;
+            if (!_IsFragmented())
+                return;
+            _Begin();
+        }
+
+        // Success here means nothing is left to move
+        if (vmaBeginDefragmentationPass(_Spec.Allocator, _Context, &_Pass) == VK_SUCCESS)
+        {
+            _End();
+            return;
+        }
+        _PassOpen = true;
+        _PassValue = FrameValue;
+        _PassCount++;
+
+        bool Copied = false;
+        for (uint32_t i = 0; i < _Pass.moveCount; i++)
+        {
+            auto &Move = _Pass.pMoves[i];
+            VmaAllocationInfo AllocInfo;
+            vmaGetAllocationInfo(_Spec.Allocator, Move.srcAllocation, &AllocInfo);
+
+            // Anything that isn't a movable buffer stays, so do buffers still waiting on their upload
+            auto Buffer = static_cast<VulkanMovableBuffer *>(AllocInfo.pUserData);
+            if (!Buffer || !_Spec.Uploads->IsComplete(Buffer->GetUploadToken()))
+            {
+                Move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                continue;
+            }
+
+            VkBufferCreateInfo BufferInfo{};
+            BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            BufferInfo.size = Buffer->GetBufferSize();
+            BufferInfo.usage = Buffer->GetUsage();
+            // Same as the buffer it replaces, later uploads into it still come from the transfer queue
+            _Spec.Uploads->SetSharing(BufferInfo);
+
+            VkBuffer NewBuffer;
+            if (vkCreateBuffer(_Spec.device, &BufferInfo, nullptr, &NewBuffer) != VK_SUCCESS)
+            {
+                Move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                continue;
+            }
+            VULKAN_SUCCESS_ASSERT(vmaBindBufferMemory(_Spec.Allocator, Move.dstTmpAllocation, NewBuffer), "Defragmentation Bind Failed!");
+
+            VkBufferCopy Region{};
+            Region.size = BufferInfo.size;
+            vkCmdCopyBuffer(Cmd, Buffer->GetHandle(), NewBuffer, 1, &Region);
+
+            // Frames in flight still read the old one, this frame's draws get the new one
+            _OldBuffers.push_back(Buffer->GetHandle());
+            Buffer->Relocate(NewBuffer);
+            Copied = true;
+        }
+
+        if (!Copied)
+            return;
+
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+        vkCmdPipelineBarrier(Cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+} // namespace VEngine
@@ -0,0 +1,68 @@
+#pragma once
+
+namespace VEngine
+{
+    class VulkanUploadManager;
+
+    struct VulkanDefragmenterSpec
+    {
+        VkDevice device;
+        VmaAllocator Allocator;
+        VulkanUploadManager *Uploads;
+        // Per pass limits, one pass is recorded into one frame
+        VkDeviceSize MaxBytesPerPass = 8 * 1024 * 1024;
+        uint32_t MaxMovesPerPass = 64;
+        // Frames between fragmentation checks
+        uint32_t CheckInterval = 600;
+        // Device local blocks need this share and amount of free space in them to start
+        float MinFragmentation = 0.25f;
+        VkDeviceSize MinFreeBytes = 16 * 1024 * 1024;
+        // Gives up on a run after this many passes, it starts over at the next check
+        uint32_t MaxPasses = 32;
+    };
+
+    // Moves VulkanMovableBuffer allocations together with vma's incremental defragmentation,
+    // a few megabytes per frame. Copies are recorded at the start of a frame and the moved
+    // buffers get their new handle right away, the old ones live until the frame is done
+    class VulkanDefragmenter
+    {
+    public:
+        VulkanDefragmenter() {}
+        ~VulkanDefragmenter() {}
+
+        void Init(const VulkanDefragmenterSpec &Spec);
+        // Only once the device is idle
+        void Destroy();
+
+        // Ends the open pass once the gpu reached its frame. Before anything retired is collected,
+        // the pass still holds allocations a retired buffer may own
+        void Finish(uint64_t CompletedValue);
+        // After the frame's command buffer began, starts the next pass when there is work
+        void Step(VkCommandBuffer Cmd, uint64_t FrameValue);
+        // Starts a run at the next Step without waiting for the check
+        void Request() { _Requested = true; }
+
+        uint32_t GetMoves() const { return _Moves; }
+        VkDeviceSize GetBytesMoved() const { return _BytesMoved; }
+
+    private:
+        bool _IsFragmented();
+        void _Begin();
+        void _End();
+
+    private:
+        VulkanDefragmenterSpec _Spec;
+        VmaDefragmentationContext _Context = VK_NULL_HANDLE;
+        VmaDefragmentationPassMoveInfo _Pass{};
+        bool _PassOpen = false;
+        uint64_t _PassValue = 0;
+        uint32_t _PassCount = 0;
+        // Source buffers of the open pass, destroyed when it ends
+        std::vector<VkBuffer> _OldBuffers;
+
+        uint32_t _Frame = 0;
+        bool _Requested = false;
+        uint32_t _Moves = 0;
+        VkDeviceSize _BytesMoved = 0;
+    };
+} // namespace VEngine
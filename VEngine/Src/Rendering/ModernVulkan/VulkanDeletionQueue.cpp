@@ -0,0 +1,128 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanDeletionQueue.h"
+
+namespace VEngine
+{
+    void VulkanDeletionQueue::Init(const VulkanDeletionQueueSpec &Spec)
+    {
+        _Spec = Spec;
+        PRINTLN("[VULKAN]: Deletion Queue Created");
+    }
+
+    void VulkanDeletionQueue::Destroy()
+    {
+        Collect(UINT64_MAX);
+    }
+
+    void VulkanDeletionQueue::RetireBuffer(VkBuffer Buffer, VmaAllocation Allocation, uint64_t Value)
+    {
+        _Push(EntryType::BUFFER, (uint64_t)Buffer, Allocation, Value);
+    }
+
+    void VulkanDeletionQueue::RetireImage(VkImage Image, VmaAllocation Allocation, uint64_t Value)
+    {
+        _Push(EntryType::IMAGE, (uint64_t)Image, Allocation, Value);
+    }
+
+    void VulkanDeletionQueue::RetireImageView(VkImageView View, uint64_t Value)
+    {
+        _Push(EntryType::IMAGE_VIEW, (uint64_t)View, nullptr, Value);
+    }
+
+    void VulkanDeletionQueue::RetireSampler(VkSampler Sampler, uint64_t Value)
+    {
+        _Push(EntryType::SAMPLER, (uint64_t)Sampler, nullptr, Value);
+    }
+
+    void VulkanDeletionQueue::RetirePipeline(VkPipeline Pipeline, uint64_t Value)
+    {
+        _Push(EntryType::PIPELINE, (uint64_t)Pipeline, nullptr, Value);
+    }
+
+    void VulkanDeletionQueue::RetirePipelineLayout(VkPipelineLayout Layout, uint64_t Value)
+    {
+        _Push(EntryType::PIPELINE_LAYOUT, (uint64_t)Layout, nullptr, Value);
+    }
+
+    void VulkanDeletionQueue::RetireSwapChain(VkSwapchainKHR SwapChain, uint64_t Value)
+    {
+        _Push(EntryType::SWAPCHAIN, (uint64_t)SwapChain, nullptr, Value);
+    }
+
+    void VulkanDeletionQueue::Retire(std::function<void()> Fn, uint64_t Value)
+    {
+        std::lock_guard<std::mutex> Lock(_Mutex);
+        _Entries.push_back({EntryType::FUNCTION, Value, 0, nullptr, std::move(Fn)});
+    }
+
+    void VulkanDeletionQueue::_Push(EntryType Type, uint64_t Handle, VmaAllocation Allocation, uint64_t Value)
+    {
+        if (Handle == 0)
+            return;
+
+        std::lock_guard<std::mutex> Lock(_Mutex);
+        _Entries.push_back({Type, Value, Handle, Allocation, nullptr});
+    }
+
+    void VulkanDeletionQueue::Collect(uint64_t Completed)
+    {
+        // Freed outside the lock, retiring from a callback is fine
+        std::vector<Entry> Ready;
+        {
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            while (!_Entries.empty() && _Entries.front().Value <= Completed)
+            {
+                Ready.push_back(std::move(_Entries.front()));
+                _Entries.pop_front();
+            }
+        }
+
+        for (auto &entry : Ready)
+            _Free(entry);
+    }
+
+    size_t VulkanDeletionQueue::GetPendingCount()
+    {
+        std::lock_guard<std::mutex> Lock(_Mutex);
+        return _Entries.size();
+    }
+
+    void VulkanDeletionQueue::_Free(Entry &entry)
+    {
+        switch (entry.Type)
+        {
+        case EntryType::BUFFER:
+            vmaDestroyBuffer(_Spec.Allocator, (VkBuffer)entry.Handle, entry.Allocation);
+            break;
+        case EntryType::IMAGE:
+            vmaDestroyImage(_Spec.Allocator, (VkImage)entry.Handle, entry.Allocation);
+            break;
+        case EntryType::IMAGE_VIEW:
+            vkDestroyImageView(_Spec.device, (VkImageView)entry.Handle, nullptr);
+            break;
+        case EntryType::SAMPLER:
+            vkDestroySampler(_Spec.device, (VkSampler)entry.Handle, nullptr);
+            break;
+        case EntryType::PIPELINE:
+            vkDestroyPipeline(_Spec.device, (VkPipeline)entry.Handle, nullptr);
+            break;
+        case EntryType::PIPELINE_LAYOUT:
+            vkDestroyPipelineLayout(_Spec.device, (VkPipelineLayout)entry.Handle, nullptr);
+            break;
+        case EntryType::SWAPCHAIN:
+            vkDestroySwapchainKHR(_Spec.device, (VkSwapchainKHR)entry.Handle, nullptr);
+            break;
+        case EntryType::FUNCTION:
+            entry.Fn();
+            break;
+        }
+    }
+} // namespace VEngine
@@ -0,0 +1,71 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanDeletionQueueSpec
+    {
+        VkDevice device;
+        VmaAllocator Allocator;
+    };
+
+    // Objects handed over here stay alive until the frame timeline reaches the value they were
+    // retired with, so nothing the gpu may still be reading is destroyed and nobody has to idle
+    // the device. Values have to be retired in increasing order
+    class VulkanDeletionQueue
+    {
+    public:
+        VulkanDeletionQueue() {}
+        ~VulkanDeletionQueue() {}
+
+        void Init(const VulkanDeletionQueueSpec &Spec);
+        // Frees everything left, only once the device is idle
+        void Destroy();
+
+        void RetireBuffer(VkBuffer Buffer, VmaAllocation Allocation, uint64_t Value);
+        void RetireImage(VkImage Image, VmaAllocation Allocation, uint64_t Value);
+        void RetireImageView(VkImageView View, uint64_t Value);
+        void RetireSampler(VkSampler Sampler, uint64_t Value);
+        void RetirePipeline(VkPipeline Pipeline, uint64_t Value);
+        void RetirePipelineLayout(VkPipelineLayout Layout, uint64_t Value);
+        // Only once its presents are done too, the frame timeline doesn't cover the presentation engine
+        void RetireSwapChain(VkSwapchainKHR SwapChain, uint64_t Value);
+        // Anything that isn't a plain vulkan object, like a bindless slot
+        void Retire(std::function<void()> Fn, uint64_t Value);
+
+        // Frees everything retired with a value up to Completed
+        void Collect(uint64_t Completed);
+
+        size_t GetPendingCount();
+
+    private:
+        enum class EntryType
+        {
+            BUFFER,
+            IMAGE,
+            IMAGE_VIEW,
+            SAMPLER,
+            PIPELINE,
+            PIPELINE_LAYOUT,
+            SWAPCHAIN,
+            FUNCTION
+        };
+
+        struct Entry
+        {
+            EntryType Type;
+            uint64_t Value;
+            // Non dispatchable handle of Type
+            uint64_t Handle;
+            VmaAllocation Allocation;
+            std::function<void()> Fn;
+        };
+
+        void _Push(EntryType Type, uint64_t Handle, VmaAllocation Allocation, uint64_t Value);
+        void _Free(Entry &entry);
+
+    private:
+        VulkanDeletionQueueSpec _Spec;
+        std::deque<Entry> _Entries;
+        std::mutex _Mutex;
+    };
+} // namespace VEngine
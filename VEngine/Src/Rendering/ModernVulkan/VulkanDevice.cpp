@@ -1,23 +1,11 @@
 #include "VeVPCH.h"
 
+#ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
+#endif
 #include "vulkan/vulkan.h"
 #include "VulkanDevice.h"
 
-#define PRINTLN(x)      \
-    {                   \
-        std::cout << x; \
-    }
-#define PRINTLN(x)              \
-    {                           \
-        std::cout << x << "\n"; \
-    }
-#define VULKAN_SUCCESS_ASSERT(x, errmsg)      \
-    {                                         \
-        if (x != VK_SUCCESS)                  \
-            throw std::runtime_error(errmsg); \
-    }
-
 namespace VEngine
 {
 #pragma region PhsyiclalDevice
@@ -60,8 +48,10 @@ namespace VEngine
             if (props.queueFlags & VK_QUEUE_GRAPHICS_BIT)
                 info.QueueIndicies.Queues[int(QueueFamilies::GRAPHICS)] = i;
 
-            VkBool32 presentSupport;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, SurfaceKHR, &presentSupport);
+            // Headless, no surface to present to so present just rides along with graphics
+            VkBool32 presentSupport = (props.queueFlags & VK_QUEUE_GRAPHICS_BIT) ? VK_TRUE : VK_FALSE;
+            if (SurfaceKHR != VK_NULL_HANDLE)
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, SurfaceKHR, &presentSupport);
 
             if (presentSupport)
                 info.QueueIndicies.Queues[QueueFamilies::PRESENT] = i;
@@ -98,6 +88,20 @@ namespace VEngine
         }
         return true;
     }
+
+    bool HasVulkanPhysicalDeviceExtension(VkPhysicalDevice device, const char *Name)
+    {
+        uint32_t count = 0;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &count, nullptr);
+
+        std::vector<VkExtensionProperties> ExtProps(count);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &count, ExtProps.data());
+
+        for (auto &props : ExtProps)
+            if (strcmp(props.extensionName, Name) == 0)
+                return true;
+        return false;
+    }
 #pragma endregion
 
     void VulkanDevice::Init(VulkanPhysicalDevice *PDevice, std::vector<const char *> &ReqExts)
@@ -140,13 +144,45 @@ namespace VEngine
         features13.shaderTerminateInvocation = VK_TRUE;
         features13.pNext = nullptr; // next in chain
 
+        // Frame pacing, only asked for when the caller found both features on the device
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+        presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+        presentWaitFeatures.presentWait = VK_TRUE;
+        VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+        presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+        presentIdFeatures.presentId = VK_TRUE;
+        presentIdFeatures.pNext = &presentWaitFeatures;
+        for (auto Ext : ReqExts)
+            if (strcmp(Ext, VK_KHR_PRESENT_WAIT_EXTENSION_NAME) == 0)
+                features13.pNext = &presentIdFeatures;
+
         VkPhysicalDeviceVulkan12Features features12{};
         features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
         features12.samplerFilterMinmax = VK_TRUE;
         features12.bufferDeviceAddressCaptureReplay = VK_TRUE;
+        features12.timelineSemaphore = VK_TRUE;
+        // Bindless texture table
+        features12.descriptorIndexing = VK_TRUE;
+        features12.runtimeDescriptorArray = VK_TRUE;
+        features12.descriptorBindingPartiallyBound = VK_TRUE;
+        features12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        features12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
         features12.pNext = &features13; // chain 1.3 features after 1.2
 
         VkPhysicalDeviceFeatures features{};
+        // Batched draws, without multiDrawIndirect every indirect call carries a single draw
+        features.multiDrawIndirect = PDevice->Info.features.multiDrawIndirect;
+        // Without it the batcher pushes each draw's slot and issues it alone
+        features.drawIndirectFirstInstance = PDevice->Info.features.drawIndirectFirstInstance;
+        features12.drawIndirectCount = PDevice->Info.features12.drawIndirectCount;
+        // Instrumentation, each is switched off at runtime when missing
+        features.pipelineStatisticsQuery = PDevice->Info.features.pipelineStatisticsQuery;
+        features.inheritedQueries = PDevice->Info.features.inheritedQueries;
+        features.fragmentStoresAndAtomics = PDevice->Info.features.fragmentStoresAndAtomics;
+        // Block compressed textures, which files can be used is checked per format
+        features.textureCompressionBC = PDevice->Info.features.textureCompressionBC;
+        features.textureCompressionASTC_LDR = PDevice->Info.features.textureCompressionASTC_LDR;
         createInfo.pEnabledFeatures = &features;
 
         createInfo.enabledLayerCount = 0;
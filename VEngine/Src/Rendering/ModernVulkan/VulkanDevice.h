@@ -47,6 +47,7 @@ namespace VEngine
 
     void _FillVulkanPhysicalDevice(VulkanPhysicalDevice &Physicaldevice, VkSurfaceKHR SurfaceKHR);
     bool CheckVulkanPhysicalDeviceExtensions(VulkanPhysicalDevice &Physicaldevice, std::vector<const char *> &ReExts);
+    bool HasVulkanPhysicalDeviceExtension(VkPhysicalDevice device, const char *Name);
 
     class VulkanDevice
     {
@@ -0,0 +1,192 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanLinearAllocator.h"
+#include "VulkanDrawBatcher.h"
+
+namespace VEngine
+{
+    void VulkanDrawBatcher::Init(const VulkanDrawBatcherSpec &Spec)
+    {
+        _Spec = Spec;
+        _Spec.MaxDrawsPerCall = std::max(Spec.MaxDrawsPerCall, 1u);
+        _Spec.MaxDraws = std::max(Spec.MaxDraws, 1u);
+        PRINTLN("[VULKAN]: Draw Batcher Created, " << (_Spec.UseDrawCount ? "indirect count" : "indirect") << " up to " << _Spec.MaxDrawsPerCall << " draws per call"
+                                                   << (_Spec.FirstInstance ? "" : ", one call per draw without firstInstance") << (_Spec.GpuCulling ? ", gpu culled" : ""));
+    }
+
+    void VulkanDrawBatcher::Add(const VulkanBatchedDraw &Draw)
+    {
+        _Draws.push_back(Draw);
+    }
+
+    const std::vector<VulkanBatchFrame> &VulkanDrawBatcher::Prepare(VulkanLinearAllocator &Allocator)
+    {
+        _Batches.clear();
+        _Frames.clear();
+        _LastDrawCount = (uint32_t)_Draws.size();
+        _LastBatchCount = 0;
+        _LastSpilledCount = 0;
+        if (_Draws.empty())
+            return _Frames;
+
+        // Group draws sharing geometry, stable so submission order holds inside a group
+        _Order.resize(_Draws.size());
+        for (uint32_t i = 0; i < _Order.size(); i++)
+            _Order[i] = i;
+        std::stable_sort(_Order.begin(), _Order.end(), [this](uint32_t a, uint32_t b)
+                         {
+                             auto &A = _Draws[a];
+                             auto &B = _Draws[b];
+                             if (A.Format != B.Format)
+                                 return A.Format < B.Format;
+                             if (A.VertexBuffer != B.VertexBuffer)
+                                 return A.VertexBuffer < B.VertexBuffer;
+                             return A.IndexBuffer < B.IndexBuffer; });
+
+        // The shaders see MaxDraws slots through one binding, sorted draws are cut in chunks of that many
+        // with data of their own. Everything is allocated before anything is written so a frame that
+        // doesn't fit is left untouched. Batch infos are sized for the worst case of one batch per draw
+        uint32_t ChunkCount = (uint32_t)((_Draws.size() + _Spec.MaxDraws - 1) / _Spec.MaxDraws);
+        _Chunks.resize(ChunkCount);
+        for (uint32_t c = 0; c < ChunkCount; c++)
+        {
+            uint32_t Count = std::min(_Spec.MaxDraws, (uint32_t)_Draws.size() - c * _Spec.MaxDraws);
+            VkDeviceSize CommandsSize = sizeof(VkDrawIndexedIndirectCommand) * Count;
+            auto &Chunk = _Chunks[c];
+            Chunk.Instances = Allocator.Allocate(sizeof(DrawInstanceData) * Count);
+            Chunk.Commands = Allocator.Allocate(CommandsSize);
+            // Cull pass output, only written by the gpu
+            auto Culled = _Spec.GpuCulling ? Allocator.Allocate(CommandsSize) : Chunk.Commands;
+            Chunk.Infos = Allocator.Allocate(sizeof(DrawBatchInfo) * Count);
+            Chunk.BatchCount = 0;
+            if (!Chunk.Instances.Buffer || !Chunk.Commands.Buffer || !Culled.Buffer || !Chunk.Infos.Buffer)
+            {
+                _Frames.clear();
+                _Overflowed = true;
+                _LastSpilledCount = _LastDrawCount;
+                _LastDrawCount = 0;
+                return _Frames;
+            }
+
+            VulkanBatchFrame Frame;
+            Frame.Buffer = Chunk.Commands.Buffer;
+            Frame.DrawCount = Count;
+            Frame.DrawDataOffset = Chunk.Instances.Offset;
+            Frame.CommandOffset = Chunk.Commands.Offset;
+            Frame.DrawCommandOffset = Culled.Offset;
+            Frame.BatchInfoOffset = Chunk.Infos.Offset;
+            _Frames.push_back(Frame);
+        }
+
+        for (uint32_t i = 0; i < _Order.size(); i++)
+        {
+            auto &Draw = _Draws[_Order[i]];
+            // Slot inside the chunk, what the shaders index with
+            uint32_t ChunkIndex = i / _Spec.MaxDraws, Slot = i % _Spec.MaxDraws;
+            auto &Chunk = _Chunks[ChunkIndex];
+            if (Slot == 0)
+                Chunk.FirstBatch = (uint32_t)_Batches.size();
+
+            // Calls never reach over into the next chunk
+            bool SameGeometry = Chunk.BatchCount && _Batches.back().VertexBuffer == Draw.VertexBuffer && _Batches.back().IndexBuffer == Draw.IndexBuffer &&
+                                _Batches.back().Format == Draw.Format;
+            if (SameGeometry && _Batches.back().CommandCount < _Spec.MaxDrawsPerCall)
+                _Batches.back().CommandCount++;
+            else
+            {
+                _Batches.push_back({Draw.VertexBuffer, Draw.IndexBuffer, Draw.IndexType, Draw.Format, ChunkIndex, Slot, 1});
+                Chunk.BatchCount++;
+            }
+
+            auto *InstanceData = (DrawInstanceData *)Chunk.Instances.Mapped;
+            InstanceData[Slot] = Draw.Instance;
+            InstanceData[Slot].BatchIndex = Chunk.BatchCount - 1;
+
+            VkDrawIndexedIndirectCommand &Command = ((VkDrawIndexedIndirectCommand *)Chunk.Commands.Mapped)[Slot];
+            Command.indexCount = Draw.IndexCount;
+            Command.instanceCount = 1;
+            Command.firstIndex = Draw.FirstIndex;
+            Command.vertexOffset = Draw.VertexOffset;
+            // Shader reads DrawData[gl_InstanceIndex + FirstDraw], FirstDraw is pushed per call without firstInstance
+            Command.firstInstance = _Spec.FirstInstance ? Slot : 0;
+        }
+
+        // Compacting culling counts up from 0 on the gpu, otherwise every command is drawn
+        bool GpuCounts = _Spec.GpuCulling && _Spec.UseDrawCount;
+        for (uint32_t i = 0; i < _Batches.size(); i++)
+        {
+            auto &Chunk = _Chunks[_Batches[i].Chunk];
+            ((DrawBatchInfo *)Chunk.Infos.Mapped)[i - Chunk.FirstBatch] = {GpuCounts ? 0 : _Batches[i].CommandCount, _Batches[i].FirstCommand};
+        }
+
+        for (uint32_t c = 0; c < ChunkCount; c++)
+        {
+            auto &Chunk = _Chunks[c];
+            Allocator.Flush(Chunk.Instances, sizeof(DrawInstanceData) * _Frames[c].DrawCount);
+            Allocator.Flush(Chunk.Commands, sizeof(VkDrawIndexedIndirectCommand) * _Frames[c].DrawCount);
+            Allocator.Flush(Chunk.Infos, sizeof(DrawBatchInfo) * Chunk.BatchCount);
+        }
+
+        _LastBatchCount = (uint32_t)_Batches.size();
+        return _Frames;
+    }
+
+    void VulkanDrawBatcher::Record(VkCommandBuffer Cmd, VkPipelineLayout Layout, const std::function<void(VkCommandBuffer, VertexFormat, uint32_t)> &BindPipeline)
+    {
+        VkBuffer BoundVertex = VK_NULL_HANDLE, BoundIndex = VK_NULL_HANDLE;
+        for (uint32_t i = 0; i < _Batches.size(); i++)
+        {
+            auto &batch = _Batches[i];
+            auto &Frame = _Frames[batch.Chunk];
+            // Sorted by format inside a chunk, so every format is bound once per chunk
+            if (i == 0 || batch.Format != _Batches[i - 1].Format || batch.Chunk != _Batches[i - 1].Chunk)
+            {
+                BindPipeline(Cmd, batch.Format, Frame.DrawDataOffset);
+                uint32_t FirstDraw = 0;
+                vkCmdPushConstants(Cmd, Layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(FirstDraw), &FirstDraw);
+            }
+            if (batch.VertexBuffer != BoundVertex)
+            {
+                VkDeviceSize Offset = 0;
+                vkCmdBindVertexBuffers(Cmd, 0, 1, &batch.VertexBuffer, &Offset);
+                BoundVertex = batch.VertexBuffer;
+            }
+            if (batch.IndexBuffer != BoundIndex)
+            {
+                vkCmdBindIndexBuffer(Cmd, batch.IndexBuffer, 0, batch.IndexType);
+                BoundIndex = batch.IndexBuffer;
+            }
+
+            VkDeviceSize Offset = Frame.DrawCommandOffset + sizeof(VkDrawIndexedIndirectCommand) * batch.FirstCommand;
+            VkDeviceSize CountOffset = Frame.BatchInfoOffset + sizeof(DrawBatchInfo) * (i - _Chunks[batch.Chunk].FirstBatch) + offsetof(DrawBatchInfo, Count);
+            if (!_Spec.FirstInstance)
+            {
+                // firstInstance has to stay 0, each draw goes out alone with its slot pushed
+                for (uint32_t j = 0; j < batch.CommandCount; j++)
+                {
+                    uint32_t FirstDraw = batch.FirstCommand + j;
+                    vkCmdPushConstants(Cmd, Layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(FirstDraw), &FirstDraw);
+                    vkCmdDrawIndexedIndirect(Cmd, Frame.Buffer, Offset + sizeof(VkDrawIndexedIndirectCommand) * j, 1, sizeof(VkDrawIndexedIndirectCommand));
+                }
+            }
+            else if (_Spec.UseDrawCount)
+                vkCmdDrawIndexedIndirectCount(Cmd, Frame.Buffer, Offset, Frame.Buffer, CountOffset, batch.CommandCount, sizeof(VkDrawIndexedIndirectCommand));
+            else
+                vkCmdDrawIndexedIndirect(Cmd, Frame.Buffer, Offset, batch.CommandCount, sizeof(VkDrawIndexedIndirectCommand));
+        }
+    }
+
+    void VulkanDrawBatcher::Clear()
+    {
+        _Draws.clear();
+        _Batches.clear();
+        _Overflowed = false;
+    }
+} // namespace VEngine
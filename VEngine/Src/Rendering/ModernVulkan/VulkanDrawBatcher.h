@@ -0,0 +1,130 @@
+#pragma once
+
+namespace VEngine
+{
+    // std430 layout, must match DrawData in the shaders
+    struct DrawInstanceData
+    {
+        glm::mat4 Model;
+        glm::vec4 Tint;
+        // Object space bounding sphere, negative radius is never culled
+        glm::vec4 Bounds;
+        uint32_t TextureIndex;
+        // Which indirect call the draw belongs to, used by the cull pass
+        uint32_t BatchIndex;
+        uint32_t Padding[2];
+    };
+
+    // Must match BatchInfo in FrustumCull.comp, Count doubles as the draw count of the call
+    struct DrawBatchInfo
+    {
+        uint32_t Count;
+        uint32_t FirstCommand;
+    };
+
+    struct VulkanDrawBatcherSpec
+    {
+        // vkCmdDrawIndexedIndirectCount is used when the device has drawIndirectCount
+        bool UseDrawCount = false;
+        // 1 when the device has no multiDrawIndirect
+        uint32_t MaxDrawsPerCall = 1;
+        // Per chunk, bounds the storage range the shaders see. A frame with more is cut in several chunks
+        uint32_t MaxDraws = 16 * 1024;
+        // Device has drawIndirectFirstInstance. Without it every draw is its own call and gets its slot
+        // through a push constant instead
+        bool FirstInstance = true;
+        // Indirect calls read the commands a cull pass writes instead of the submitted ones
+        bool GpuCulling = false;
+    };
+
+    struct VulkanBatchedDraw
+    {
+        VkBuffer VertexBuffer;
+        VkBuffer IndexBuffer;
+        VkIndexType IndexType;
+        uint32_t IndexCount;
+        // Where the mesh starts in pooled buffers, pooled meshes share buffers and so calls
+        uint32_t FirstIndex;
+        int32_t VertexOffset;
+        // Draws of another format need other pipelines, they never share a call
+        VertexFormat Format;
+        DrawInstanceData Instance;
+    };
+
+    // Where a prepared chunk's batch data sits in the frame allocator, all offsets are
+    // usable as dynamic offsets
+    struct VulkanBatchFrame
+    {
+        VkBuffer Buffer = VK_NULL_HANDLE;
+        uint32_t DrawCount = 0;
+        uint32_t DrawDataOffset = 0;
+        // Commands as submitted, one per draw in draw data order
+        uint32_t CommandOffset = 0;
+        // Commands the indirect calls read, same as CommandOffset without culling
+        uint32_t DrawCommandOffset = 0;
+        uint32_t BatchInfoOffset = 0;
+    };
+
+    // Collects draws for a frame and emits them as a few indirect calls. Draws that share
+    // vertex and index buffers go out in one call, shaders find their per draw data through
+    // gl_InstanceIndex which is set to the draw's slot in its chunk with firstInstance
+    class VulkanDrawBatcher
+    {
+    public:
+        VulkanDrawBatcher() {}
+        ~VulkanDrawBatcher() {}
+
+        void Init(const VulkanDrawBatcherSpec &Spec);
+
+        void Add(const VulkanBatchedDraw &Draw);
+
+        // Writes the per draw data and indirect commands for this frame, one entry per chunk. When they don't
+        // fit the allocator nothing is batched, no chunks come back and Overflowed is set until Clear
+        const std::vector<VulkanBatchFrame> &Prepare(VulkanLinearAllocator &Allocator);
+        // Binds geometry and issues the indirect calls. BindPipeline is called whenever the vertex format or
+        // the chunk changes and has to bind the format's pipeline and sets with the chunk's draw data offset.
+        // Layout is the pipelines' shared layout, the draw slot base is pushed at offset 0
+        void Record(VkCommandBuffer Cmd, VkPipelineLayout Layout, const std::function<void(VkCommandBuffer, VertexFormat, uint32_t)> &BindPipeline);
+        void Clear();
+
+        bool Empty() const { return _Draws.empty() || _Overflowed; }
+        bool Overflowed() const { return _Overflowed; }
+        // Draws added this frame, in submission order
+        const std::vector<VulkanBatchedDraw> &GetDraws() const { return _Draws; }
+        uint32_t GetDrawCount() const { return _LastDrawCount; }
+        uint32_t GetBatchCount() const { return _LastBatchCount; }
+        // Draws the last Prepare couldn't fit
+        uint32_t GetSpilledCount() const { return _LastSpilledCount; }
+        const std::vector<VulkanBatchFrame> &GetFrames() const { return _Frames; }
+
+    private:
+        struct Batch
+        {
+            VkBuffer VertexBuffer;
+            VkBuffer IndexBuffer;
+            VkIndexType IndexType;
+            VertexFormat Format;
+            uint32_t Chunk;
+            // Inside the chunk
+            uint32_t FirstCommand;
+            uint32_t CommandCount;
+        };
+
+        // Where the cpu writes a chunk, and its batches
+        struct Chunk
+        {
+            VulkanLinearAllocation Instances, Commands, Infos;
+            uint32_t FirstBatch, BatchCount;
+        };
+
+        VulkanDrawBatcherSpec _Spec;
+        std::vector<VulkanBatchedDraw> _Draws;
+        std::vector<uint32_t> _Order;
+        std::vector<Batch> _Batches;
+        std::vector<Chunk> _Chunks;
+
+        std::vector<VulkanBatchFrame> _Frames;
+        uint32_t _LastDrawCount = 0, _LastBatchCount = 0, _LastSpilledCount = 0;
+        bool _Overflowed = false;
+    };
+} // namespace VEngine
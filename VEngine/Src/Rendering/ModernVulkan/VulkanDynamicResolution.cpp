@@ -0,0 +1,60 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanDynamicResolution.h"
+
+namespace VEngine
+{
+    void VulkanDynamicResolution::Init(const VulkanDynamicResolutionSpec &Spec)
+    {
+        _Spec = Spec;
+        _Spec.Step = std::max(_Spec.Step, 0.01f);
+        _Spec.Interval = std::max(_Spec.Interval, 1u);
+        _Spec.MinScale = std::clamp(_Spec.MinScale, _Spec.Step, 1.0f);
+        _Spec.MaxScale = std::clamp(_Spec.MaxScale, _Spec.MinScale, 1.0f);
+        _Scale = _Spec.MaxScale;
+        PRINTLN("[VULKAN]: Dynamic resolution at " << _Spec.TargetFrameMs << " ms, scale " << _Spec.MinScale << " to " << _Spec.MaxScale);
+    }
+
+    float VulkanDynamicResolution::Update(float GpuFrameMs)
+    {
+        // Nothing read back yet
+        if (GpuFrameMs <= 0.0f)
+            return _Scale;
+
+        _SmoothedMs = _SmoothedMs == 0.0f ? GpuFrameMs : glm::mix(_SmoothedMs, GpuFrameMs, 0.2f);
+        if (++_Frames < _Spec.Interval)
+            return _Scale;
+        _Frames = 0;
+
+        float Ratio = _Spec.TargetFrameMs / _SmoothedMs;
+        if (std::abs(Ratio - 1.0f) <= _Spec.Headroom)
+            return _Scale;
+
+        // Over budget rounds down so it always drops at least a step
+        float Wanted = _Scale * std::sqrt(Ratio);
+        if (Ratio < 1.0f)
+            Wanted = std::floor(Wanted / _Spec.Step + 0.001f) * _Spec.Step;
+        else
+            Wanted = std::round(std::min(Wanted, _Scale + _Spec.Step) / _Spec.Step) * _Spec.Step;
+        Wanted = std::clamp(Wanted, _Spec.MinScale, _Spec.MaxScale);
+        if (Wanted == _Scale)
+            return _Scale;
+
+        // Times measured at the old scale say nothing about the new one
+        _Scale = Wanted;
+        _SmoothedMs = 0.0f;
+        return _Scale;
+    }
+
+    VkExtent2D VulkanDynamicResolution::Scale(VkExtent2D Extent, float Scale)
+    {
+        return {std::max(1u, (uint32_t)std::lround(Extent.width * Scale)), std::max(1u, (uint32_t)std::lround(Extent.height * Scale))};
+    }
+} // namespace VEngine
@@ -0,0 +1,42 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanDynamicResolutionSpec
+    {
+        // Gpu time a frame should take
+        float TargetFrameMs = 16.0f;
+        float MinScale = 0.5f;
+        float MaxScale = 1.0f;
+        // Scale moves in steps this big, every step is another set of target extents in the pool
+        float Step = 0.05f;
+        // Frames between adjustments, a change only shows up in the gpu time a few frames later
+        uint32_t Interval = 8;
+        // Share of the budget the smoothed time may be off by without a change
+        float Headroom = 0.05f;
+    };
+
+    // Picks the share of the presented extent the scene is drawn at from the measured gpu frame
+    // time. Drawn pixels go with the square of the scale, so that is what the time is corrected with.
+    // It goes down as far as it has to at once and back up one step at a time
+    class VulkanDynamicResolution
+    {
+    public:
+        VulkanDynamicResolution() {}
+        ~VulkanDynamicResolution() {}
+
+        void Init(const VulkanDynamicResolutionSpec &Spec);
+
+        // Once per frame with the profiler's last frame time, returns the scale to draw at
+        float Update(float GpuFrameMs);
+
+        float GetScale() const { return _Scale; }
+        static VkExtent2D Scale(VkExtent2D Extent, float Scale);
+
+    private:
+        VulkanDynamicResolutionSpec _Spec;
+        float _Scale = 1.0f;
+        float _SmoothedMs = 0.0f;
+        uint32_t _Frames = 0;
+    };
+} // namespace VEngine
@@ -0,0 +1,131 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanFramePacer.h"
+
+// Older sdks lack it, the timer then falls back to a plain sleep where windows doesn't know it either
+#if defined(_WIN32) && !defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace VEngine
+{
+    // Longest a present wait may block, presents of a hidden window may never reach the display
+    static constexpr uint64_t PRESENT_WAIT_TIMEOUT = 100 * 1000 * 1000;
+
+    void VulkanFramePacer::Init(const VulkanFramePacerSpec &Spec)
+    {
+        _Spec = Spec;
+        if (_Spec.PresentWait)
+            _WaitForPresent = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(_Spec.device, "vkWaitForPresentKHR");
+#ifdef _WIN32
+        _Timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+        SetMaxFrameRate(_Spec.MaxFrameRate);
+        PRINTLN("[VULKAN]: Frame pacer, present wait " << (_WaitForPresent ? "on" : "off") << ", " << _Spec.MaxQueuedPresents << " queued presents");
+    }
+
+    void VulkanFramePacer::Destroy()
+    {
+#ifdef _WIN32
+        if (_Timer)
+            CloseHandle(_Timer);
+#endif
+        _Timer = nullptr;
+    }
+
+    void VulkanFramePacer::SetSwapChain(VkSwapchainKHR SwapChain, VkPresentModeKHR Mode)
+    {
+        _SwapChain = SwapChain;
+        _Queued = Mode == VK_PRESENT_MODE_FIFO_KHR || Mode == VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+        _PresentId = 0;
+    }
+
+    void VulkanFramePacer::Wait()
+    {
+        if (_Waited)
+            return;
+        _Waited = true;
+        auto Start = std::chrono::steady_clock::now();
+
+        // Mailbox and immediate replace or tear instead of queueing, waiting there would only cap the rate
+        if (_WaitForPresent && _Queued && _PresentId > _Spec.MaxQueuedPresents)
+        {
+            // Timeouts and an out of date chain just go on, the acquire after this sorts the chain out
+            _WaitForPresent(_Spec.device, _SwapChain, _PresentId - _Spec.MaxQueuedPresents, PRESENT_WAIT_TIMEOUT);
+        }
+        _Limit();
+
+        _WaitMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - Start).count();
+    }
+
+    void VulkanFramePacer::EndFrame()
+    {
+        _Waited = false;
+    }
+
+    uint64_t VulkanFramePacer::NextPresentId()
+    {
+        return _WaitForPresent && _SwapChain ? ++_PresentId : 0;
+    }
+
+    bool VulkanFramePacer::WaitForPresent(VkSwapchainKHR SwapChain, uint64_t Id, uint64_t Timeout)
+    {
+        if (!_WaitForPresent || !Id)
+            return true;
+        return _WaitForPresent(_Spec.device, SwapChain, Id, Timeout) != VK_TIMEOUT;
+    }
+
+    void VulkanFramePacer::SetMaxFrameRate(float Rate)
+    {
+        _Spec.MaxFrameRate = std::max(Rate, 0.0f);
+        _Period = {};
+        if (_Spec.MaxFrameRate > 0.0f)
+            _Period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / _Spec.MaxFrameRate));
+        _Deadline = std::chrono::steady_clock::now();
+    }
+
+    void VulkanFramePacer::_Limit()
+    {
+        if (_Period.count() == 0)
+            return;
+
+        auto Now = std::chrono::steady_clock::now();
+        if (Now < _Deadline)
+        {
+            auto Spin = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float, std::milli>(_Spec.SpinMs));
+            if (_Deadline - Now > Spin)
+                _Sleep(_Deadline - Now - Spin);
+            while (std::chrono::steady_clock::now() < _Deadline)
+                std::this_thread::yield();
+            Now = _Deadline;
+        }
+
+        // A little late is made up by the next frames, a whole period late starts over so there's no burst to catch up
+        _Deadline = Now - _Deadline > _Period ? Now + _Period : _Deadline + _Period;
+    }
+
+    void VulkanFramePacer::_Sleep(std::chrono::steady_clock::duration Time)
+    {
+#ifdef _WIN32
+        if (_Timer)
+        {
+            // Relative due time in 100ns units
+            LARGE_INTEGER Due;
+            Due.QuadPart = -(LONGLONG)(std::chrono::duration_cast<std::chrono::nanoseconds>(Time).count() / 100);
+            if (SetWaitableTimerEx(_Timer, &Due, 0, nullptr, nullptr, nullptr, 0))
+            {
+                WaitForSingleObject(_Timer, INFINITE);
+                return;
+            }
+        }
+#endif
+        std::this_thread::sleep_for(Time);
+    }
+} // namespace VEngine
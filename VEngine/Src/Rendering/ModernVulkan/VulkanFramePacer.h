@@ -0,0 +1,70 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanFramePacerSpec
+    {
+        VkDevice device;
+        // Device has VK_KHR_present_id and VK_KHR_present_wait enabled
+        bool PresentWait = false;
+        // Presents that may still be waiting for the display when the next frame starts
+        uint32_t MaxQueuedPresents = 1;
+        // 0 is unlimited
+        float MaxFrameRate = 0.0f;
+        // Sleeps overshoot by up to a scheduler tick, the last bit before a deadline is spun instead
+        float SpinMs = 1.5f;
+    };
+
+    // Holds the cpu back before a frame starts so input is sampled as late as possible. Under fifo with
+    // present wait it waits until all but MaxQueuedPresents of the earlier presents reached the display,
+    // instead of running ahead until acquire blocks on a full queue. The frame rate limit then sleeps most
+    // of the way to the next deadline and spins the rest, deadlines advance by the period so it doesn't drift
+    class VulkanFramePacer
+    {
+    public:
+        VulkanFramePacer() {}
+        ~VulkanFramePacer() {}
+
+        void Init(const VulkanFramePacerSpec &Spec);
+        void Destroy();
+
+        // Every new swapchain, present ids start over with it. Only the fifo modes queue presents up
+        // so only they get waited on, headless never sets one
+        void SetSwapChain(VkSwapchainKHR SwapChain, VkPresentModeKHR Mode);
+        // Once per frame before input is read, further calls till EndFrame do nothing
+        void Wait();
+        // Present was queued or the frame skipped, the next Wait holds the cpu back again
+        void EndFrame();
+        // Id to chain into the present, 0 when present wait is off
+        uint64_t NextPresentId();
+        // Last id handed out for the current swapchain
+        uint64_t GetPresentId() const { return _PresentId; }
+        // False only while present Id of SwapChain is still queued. Without present wait, for id 0 and for
+        // out of date or lost chains there is nothing to wait for, so those are true right away
+        bool WaitForPresent(VkSwapchainKHR SwapChain, uint64_t Id, uint64_t Timeout);
+
+        void SetMaxFrameRate(float Rate);
+        bool HasPresentWait() const { return _WaitForPresent != nullptr; }
+        // Time the last Wait held the cpu back
+        float GetWaitMs() const { return _WaitMs; }
+
+    private:
+        void _Limit();
+        void _Sleep(std::chrono::steady_clock::duration Time);
+
+    private:
+        VulkanFramePacerSpec _Spec;
+        PFN_vkWaitForPresentKHR _WaitForPresent = nullptr;
+
+        VkSwapchainKHR _SwapChain = VK_NULL_HANDLE;
+        bool _Queued = false;
+        uint64_t _PresentId = 0;
+        bool _Waited = false;
+        // High resolution waitable timer on windows, where plain sleeps round up to the system tick
+        void *_Timer = nullptr;
+
+        std::chrono::steady_clock::duration _Period{};
+        std::chrono::steady_clock::time_point _Deadline{};
+        float _WaitMs = 0.0f;
+    };
+} // namespace VEngine
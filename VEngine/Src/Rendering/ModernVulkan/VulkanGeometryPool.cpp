@@ -0,0 +1,143 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanResourceFactory.h"
+#include "VulkanStagingRing.h"
+#include "VulkanUploadManager.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanGeometryPool.h"
+
+namespace VEngine
+{
+    void VulkanGeometryPool::Init(const VulkanGeometryPoolSpec &Spec)
+    {
+        _Spec = Spec;
+        // Anything allowed in has to fit an empty block
+        _Spec.MaxMeshSize = std::min(_Spec.MaxMeshSize, _Spec.BlockSize);
+        PRINTLN("[VULKAN]: Geometry Pool Created, " << _Spec.BlockSize / (1024 * 1024) << " MB buffers");
+    }
+
+    void VulkanGeometryPool::Destroy()
+    {
+        for (auto &pool : _Pools)
+        {
+            for (auto &block : pool.Blocks)
+            {
+                // Meshes that were never deleted go with it
+                vmaClearVirtualBlock(block.Virtual);
+                vmaDestroyVirtualBlock(block.Virtual);
+                vmaDestroyBuffer(_Spec.Allocator, block.Buffer, block.Allocation);
+            }
+        }
+        _Pools.clear();
+        _UsedBytes = _Capacity = 0;
+    }
+
+    uint32_t VulkanGeometryPool::_GetPool(VkBufferUsageFlags Usage, uint32_t Stride)
+    {
+        for (uint32_t i = 0; i < _Pools.size(); i++)
+            if (_Pools[i].Usage == Usage && _Pools[i].Stride == Stride)
+                return i;
+
+        _Pools.push_back({Usage, Stride, {}});
+        return (uint32_t)_Pools.size() - 1;
+    }
+
+    void VulkanGeometryPool::_AddBlock(Pool &pool)
+    {
+        // Whole elements only, ranges never straddle the end
+        VkDeviceSize Elements = _Spec.BlockSize / pool.Stride;
+
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = Elements * pool.Stride;
+        bufferInfo.usage = pool.Usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        _Spec.Uploads->SetSharing(bufferInfo);
+
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+        Block block{};
+        VULKAN_SUCCESS_ASSERT(vmaCreateBuffer(_Spec.Allocator, &bufferInfo, &allocInfo, &block.Buffer, &block.Allocation, nullptr), "Geometry Pool Buffer Creation Failed!");
+
+        // Sizes in elements, offsets vma hands out are element indices
+        VmaVirtualBlockCreateInfo blockInfo{};
+        blockInfo.size = Elements;
+        VULKAN_SUCCESS_ASSERT(vmaCreateVirtualBlock(&blockInfo, &block.Virtual), "Geometry Pool Block Creation Failed!");
+
+        pool.Blocks.push_back(block);
+        _Capacity += bufferInfo.size;
+    }
+
+    bool VulkanGeometryPool::Allocate(VkBufferUsageFlags Usage, uint32_t Stride, uint32_t Count, VulkanGeometryRange &Range)
+    {
+        if (Stride == 0 || Count == 0 || (VkDeviceSize)Stride * Count > _Spec.MaxMeshSize)
+            return false;
+
+        uint32_t PoolIndex = _GetPool(Usage, Stride);
+        auto &pool = _Pools[PoolIndex];
+
+        VmaVirtualAllocationCreateInfo allocInfo{};
+        allocInfo.size = Count;
+
+        // First block with room, a new one when none has
+        for (uint32_t i = 0; i <= pool.Blocks.size(); i++)
+        {
+            if (i == pool.Blocks.size())
+                _AddBlock(pool);
+
+            VkDeviceSize Offset;
+            if (vmaVirtualAllocate(pool.Blocks[i].Virtual, &allocInfo, &Range.Allocation, &Offset) != VK_SUCCESS)
+                continue;
+
+            Range.Buffer = pool.Blocks[i].Buffer;
+            Range.First = (uint32_t)Offset;
+            Range.Count = Count;
+            Range.Stride = Stride;
+            Range.Pool = PoolIndex;
+            Range.Block = i;
+            _UsedBytes += (VkDeviceSize)Count * Stride;
+            return true;
+        }
+        return false;
+    }
+
+    void VulkanGeometryPool::Free(VulkanGeometryRange &Range, uint64_t Value)
+    {
+        if (Range.Allocation == VK_NULL_HANDLE)
+            return;
+
+        // Frames already recorded may still draw from it
+        VmaVirtualBlock Virtual = _Pools[Range.Pool].Blocks[Range.Block].Virtual;
+        VmaVirtualAllocation Allocation = Range.Allocation;
+        VkDeviceSize Bytes = (VkDeviceSize)Range.Count * Range.Stride;
+        _Spec.DeletionQueue->Retire([this, Virtual, Allocation, Bytes]()
+                                    {
+                                        vmaVirtualFree(Virtual, Allocation);
+                                        _UsedBytes -= Bytes; }, Value);
+        Range = VulkanGeometryRange();
+    }
+
+    UploadToken VulkanGeometryPool::Upload(const VulkanGeometryRange &Range, const void *Data, VkDeviceSize Size)
+    {
+        return _Spec.Uploads->UploadBuffer(Range.Buffer, Data, Size, (VkDeviceSize)Range.First * Range.Stride);
+    }
+
+    UploadToken VulkanGeometryPool::Update(VulkanGeometryRange &Range, const void *Data, VkDeviceSize Size)
+    {
+        // Same size as a range that already got in, only fails if the device is out of memory
+        VulkanGeometryRange Fresh;
+        if (!Allocate(_Pools[Range.Pool].Usage, Range.Stride, Range.Count, Fresh))
+            throw std::runtime_error("Geometry Pool Update Failed!");
+
+        Free(Range, _FrameValue);
+        Range = Fresh;
+        return Upload(Range, Data, Size);
+    }
+} // namespace VEngine
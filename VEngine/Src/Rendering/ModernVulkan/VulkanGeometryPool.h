@@ -0,0 +1,72 @@
+#pragma once
+
+namespace VEngine
+{
+    class VulkanUploadManager;
+    class VulkanDeletionQueue;
+
+    struct VulkanGeometryPoolSpec
+    {
+        VmaAllocator Allocator;
+        VulkanUploadManager *Uploads;
+        VulkanDeletionQueue *DeletionQueue;
+        // Bytes of every pool buffer, a pool grows by another buffer once it is full
+        VkDeviceSize BlockSize = 64 * 1024 * 1024;
+        // Bigger meshes get their own buffer instead
+        VkDeviceSize MaxMeshSize = 16 * 1024 * 1024;
+    };
+
+    // Few big device local vertex and index buffers with static meshes sub-allocated out of them.
+    // Every vertex stride and index size has its own buffers, with ranges counted in elements
+    // a mesh is just an offset and draws of different meshes can share one bind and one indirect
+    // call. Ranges come from vma's virtual blocks, their TLSF allocator handles the free space
+    class VulkanGeometryPool
+    {
+    public:
+        VulkanGeometryPool() {}
+        ~VulkanGeometryPool() {}
+
+        void Init(const VulkanGeometryPoolSpec &Spec);
+        // Only once the device is idle and every range was freed or leaked on purpose
+        void Destroy();
+
+        // False when the mesh doesn't belong in the pool, it gets a buffer of its own then
+        bool Allocate(VkBufferUsageFlags Usage, uint32_t Stride, uint32_t Count, VulkanGeometryRange &Range);
+        // Free for reuse once the gpu reaches Value on the frame timeline
+        void Free(VulkanGeometryRange &Range, uint64_t Value);
+        UploadToken Upload(const VulkanGeometryRange &Range, const void *Data, VkDeviceSize Size);
+        // New contents for a range frames in flight may still draw from. The data goes to a fresh range of
+        // the same size and the old one is freed with the frame being recorded, Range is replaced
+        UploadToken Update(VulkanGeometryRange &Range, const void *Data, VkDeviceSize Size);
+        // Frame being recorded, what ranges replaced by Update are freed with
+        void SetFrameValue(uint64_t Value) { _FrameValue = Value; }
+
+        VkDeviceSize GetUsedBytes() const { return _UsedBytes; }
+        VkDeviceSize GetCapacity() const { return _Capacity; }
+
+    private:
+        struct Block
+        {
+            VkBuffer Buffer;
+            VmaAllocation Allocation;
+            VmaVirtualBlock Virtual;
+        };
+
+        struct Pool
+        {
+            VkBufferUsageFlags Usage;
+            uint32_t Stride;
+            std::vector<Block> Blocks;
+        };
+
+        uint32_t _GetPool(VkBufferUsageFlags Usage, uint32_t Stride);
+        void _AddBlock(Pool &pool);
+
+    private:
+        VulkanGeometryPoolSpec _Spec;
+        std::vector<Pool> _Pools;
+        VkDeviceSize _UsedBytes = 0;
+        VkDeviceSize _Capacity = 0;
+        uint64_t _FrameValue = 0;
+    };
+} // namespace VEngine
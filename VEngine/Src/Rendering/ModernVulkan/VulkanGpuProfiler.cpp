@@ -0,0 +1,300 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanGpuProfiler.h"
+#include "Profiling/Trace.h"
+
+namespace VEngine
+{
+    // Raw reading of the host time domain the gpu clock is calibrated against
+    static uint64_t HostClockNow()
+    {
+#ifdef _WIN32
+        LARGE_INTEGER Counter;
+        QueryPerformanceCounter(&Counter);
+        return Counter.QuadPart;
+#else
+        timespec Time;
+        clock_gettime(CLOCK_MONOTONIC, &Time);
+        return uint64_t(Time.tv_sec) * 1000000000ull + Time.tv_nsec;
+#endif
+    }
+
+    static double HostTicksToUs(int64_t Ticks)
+    {
+#ifdef _WIN32
+        LARGE_INTEGER Frequency;
+        QueryPerformanceFrequency(&Frequency);
+        return double(Ticks) * 1000000.0 / double(Frequency.QuadPart);
+#else
+        return double(Ticks) / 1000.0;
+#endif
+    }
+
+    void VulkanGpuProfiler::Init(const VulkanGpuProfilerSpec &Spec)
+    {
+        _Spec = Spec;
+
+        uint32_t count = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(Spec.PhysicalDevice, &count, nullptr);
+        std::vector<VkQueueFamilyProperties> families(count);
+        vkGetPhysicalDeviceQueueFamilyProperties(Spec.PhysicalDevice, &count, families.data());
+
+        uint32_t ValidBits = Spec.QueueFamily < count ? families[Spec.QueueFamily].timestampValidBits : 0;
+        if (ValidBits == 0 || Spec.MaxScopes == 0)
+        {
+            PRINTLN("[VULKAN]: Queue has no timestamps, Gpu Profiler disabled");
+            return;
+        }
+        _TickMask = ValidBits >= 64 ? ~0ull : (1ull << ValidBits) - 1;
+
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(Spec.PhysicalDevice, &props);
+        _Period = props.limits.timestampPeriod;
+
+        VkQueryPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = Spec.MaxScopes * 2;
+
+        _Slots.resize(Spec.FrameCount);
+        for (auto &Slot : _Slots)
+            VULKAN_SUCCESS_ASSERT(vkCreateQueryPool(Spec.device, &poolInfo, nullptr, &Slot.Pool), "Timestamp Query Pool Failed!");
+        // Value and availability per query
+        _Results.resize(Spec.MaxScopes * 4);
+
+        if (Spec.PipelineStatistics)
+        {
+            VkQueryPoolCreateInfo statisticsInfo{};
+            statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            statisticsInfo.queryCount = Spec.MaxScopes;
+            statisticsInfo.pipelineStatistics = STATISTIC_FLAGS;
+
+            for (auto &Slot : _Slots)
+                VULKAN_SUCCESS_ASSERT(vkCreateQueryPool(Spec.device, &statisticsInfo, nullptr, &Slot.StatisticsPool), "Statistics Query Pool Failed!");
+            _StatisticsResults.resize(Spec.MaxScopes * (STATISTIC_COUNT + 1));
+        }
+
+        if (Spec.CalibratedTimestamps)
+        {
+            auto GetTimeDomains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)vkGetInstanceProcAddr(Spec.Instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+            auto GetTimestamps = (PFN_vkGetCalibratedTimestampsEXT)vkGetDeviceProcAddr(Spec.device, "vkGetCalibratedTimestampsEXT");
+#ifdef _WIN32
+            _HostDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+            _HostDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+            if (GetTimeDomains && GetTimestamps)
+            {
+                uint32_t domainCount = 0;
+                GetTimeDomains(Spec.PhysicalDevice, &domainCount, nullptr);
+                std::vector<VkTimeDomainEXT> domains(domainCount);
+                GetTimeDomains(Spec.PhysicalDevice, &domainCount, domains.data());
+
+                bool HasDevice = std::find(domains.begin(), domains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != domains.end();
+                bool HasHost = std::find(domains.begin(), domains.end(), _HostDomain) != domains.end();
+                if (HasDevice && HasHost)
+                    _GetCalibratedTimestamps = GetTimestamps;
+            }
+        }
+
+        _Enabled = true;
+        PRINTLN("[VULKAN]: Gpu Profiler Created, " << Spec.MaxScopes << " scopes per frame"
+                                                   << (_GetCalibratedTimestamps ? ", calibrated" : ""));
+    }
+
+    void VulkanGpuProfiler::Destroy()
+    {
+        for (auto &Slot : _Slots)
+        {
+            vkDestroyQueryPool(_Spec.device, Slot.Pool, nullptr);
+            vkDestroyQueryPool(_Spec.device, Slot.StatisticsPool, nullptr);
+        }
+        _Slots.clear();
+        _Enabled = false;
+    }
+
+    void VulkanGpuProfiler::BeginFrame(VkCommandBuffer Cmd, uint32_t Frame)
+    {
+        if (!_Enabled)
+            return;
+
+        _Current = Frame;
+        auto &Slot = _Slots[Frame];
+        if (Slot.Submitted)
+            _Resolve(Slot);
+
+        Slot.Scopes.clear();
+        Slot.QueryCount = 0;
+        Slot.StatisticsCount = 0;
+        Slot.Submitted = false;
+        _Open.clear();
+        _StatisticsOpen = false;
+        _StatisticsActive = _StatisticsRequested && Slot.StatisticsPool != VK_NULL_HANDLE;
+        vkCmdResetQueryPool(Cmd, Slot.Pool, 0, _Spec.MaxScopes * 2);
+        if (_StatisticsActive)
+            vkCmdResetQueryPool(Cmd, Slot.StatisticsPool, 0, _Spec.MaxScopes);
+    }
+
+    void VulkanGpuProfiler::BeginScope(VkCommandBuffer Cmd, const char *Name, bool Statistics)
+    {
+        if (!_Enabled)
+            return;
+
+        auto &Slot = _Slots[_Current];
+        // Out of queries, the scope just isn't timed
+        if (Slot.QueryCount + 2 > _Spec.MaxScopes * 2)
+        {
+            _Open.push_back(UINT32_MAX);
+            return;
+        }
+
+        // End query is reserved now so an open scope can always be closed
+        Scope scope{Name, (uint32_t)_Open.size(), Slot.QueryCount, Slot.QueryCount + 1, UINT32_MAX};
+        Slot.QueryCount += 2;
+
+        vkCmdWriteTimestamp2(Cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, Slot.Pool, scope.BeginQuery);
+        if (Statistics && _StatisticsActive && !_StatisticsOpen)
+        {
+            scope.StatisticsQuery = Slot.StatisticsCount++;
+            vkCmdBeginQuery(Cmd, Slot.StatisticsPool, scope.StatisticsQuery, 0);
+            _StatisticsOpen = true;
+        }
+        _Open.push_back((uint32_t)Slot.Scopes.size());
+        Slot.Scopes.push_back(scope);
+    }
+
+    void VulkanGpuProfiler::EndScope(VkCommandBuffer Cmd)
+    {
+        if (!_Enabled || _Open.empty())
+            return;
+
+        uint32_t Index = _Open.back();
+        _Open.pop_back();
+        if (Index == UINT32_MAX)
+            return;
+
+        auto &Slot = _Slots[_Current];
+        auto &scope = Slot.Scopes[Index];
+        if (scope.StatisticsQuery != UINT32_MAX)
+        {
+            vkCmdEndQuery(Cmd, Slot.StatisticsPool, scope.StatisticsQuery);
+            _StatisticsOpen = false;
+        }
+        vkCmdWriteTimestamp2(Cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, Slot.Pool, scope.EndQuery);
+    }
+
+    void VulkanGpuProfiler::MarkSubmit(uint32_t Frame)
+    {
+        if (!_Enabled)
+            return;
+
+        _Slots[Frame].SubmitUs = Trace::NowUs();
+        _Slots[Frame].Submitted = true;
+    }
+
+    void VulkanGpuProfiler::_Calibrate()
+    {
+        VkCalibratedTimestampInfoEXT infos[2]{};
+        infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+        infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+        infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+        infos[1].timeDomain = _HostDomain;
+
+        uint64_t Stamps[2];
+        uint64_t MaxDeviation;
+        if (_GetCalibratedTimestamps(_Spec.device, 2, infos, Stamps, &MaxDeviation) != VK_SUCCESS)
+            return;
+
+        // Host domain has its own units and epoch, measure how long ago the sample was and
+        // move back by that much on the trace clock
+        double NowUs = Trace::NowUs();
+        _AnchorUs = NowUs - HostTicksToUs(int64_t(HostClockNow() - Stamps[1]));
+        _AnchorTicks = Stamps[0];
+        _Calibrated = true;
+    }
+
+    void VulkanGpuProfiler::_Resolve(FrameSlot &Slot)
+    {
+        if (Slot.QueryCount == 0)
+            return;
+
+        // Slot was waited on before reuse, so no wait here. Queries of scopes that never closed
+        // stay unavailable and are skipped
+        VkResult result = vkGetQueryPoolResults(_Spec.device, Slot.Pool, 0, Slot.QueryCount,
+                                                Slot.QueryCount * 2 * sizeof(uint64_t), _Results.data(), 2 * sizeof(uint64_t),
+                                                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if (result != VK_SUCCESS && result != VK_NOT_READY)
+            return;
+
+        bool HasStatistics = false;
+        if (Slot.StatisticsCount > 0)
+        {
+            const uint32_t Stride = STATISTIC_COUNT + 1;
+            result = vkGetQueryPoolResults(_Spec.device, Slot.StatisticsPool, 0, Slot.StatisticsCount,
+                                           Slot.StatisticsCount * Stride * sizeof(uint64_t), _StatisticsResults.data(), Stride * sizeof(uint64_t),
+                                           VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+            HasStatistics = result == VK_SUCCESS || result == VK_NOT_READY;
+        }
+
+        // Once per read back keeps drift between the clocks small
+        if (_GetCalibratedTimestamps)
+            _Calibrate();
+
+        _Timings.clear();
+        _FrameMs = 0.0f;
+        bool HasFirst = false;
+        uint64_t FirstTicks = 0;
+        for (auto &scope : Slot.Scopes)
+        {
+            if (!_Results[scope.BeginQuery * 2 + 1] || !_Results[scope.EndQuery * 2 + 1])
+                continue;
+
+            uint64_t Begin = _Results[scope.BeginQuery * 2];
+            uint64_t End = _Results[scope.EndQuery * 2];
+            if (!HasFirst)
+            {
+                FirstTicks = Begin;
+                HasFirst = true;
+            }
+
+            double StartMs = double((Begin - FirstTicks) & _TickMask) * _Period / 1000000.0;
+            double DurationMs = double((End - Begin) & _TickMask) * _Period / 1000000.0;
+            GpuScopeTiming Timing{scope.Name, scope.Depth, (float)StartMs, (float)DurationMs};
+            const uint64_t *Statistics = HasStatistics && scope.StatisticsQuery != UINT32_MAX
+                                             ? &_StatisticsResults[scope.StatisticsQuery * (STATISTIC_COUNT + 1)]
+                                             : nullptr;
+            if (Statistics && Statistics[STATISTIC_COUNT])
+            {
+                Timing.HasStatistics = true;
+                Timing.Statistics.VertexInvocations = Statistics[0];
+                Timing.Statistics.ClippingInvocations = Statistics[1];
+                Timing.Statistics.ClippingPrimitives = Statistics[2];
+                Timing.Statistics.FragmentInvocations = Statistics[3];
+                Timing.Statistics.ComputeInvocations = Statistics[4];
+            }
+            _Timings.push_back(Timing);
+            if (scope.Depth == 0)
+                _FrameMs += (float)DurationMs;
+
+            if (Trace::IsEnabled())
+            {
+                TraceEvent Event;
+                Event.Name = scope.Name;
+                Event.Process = TraceProcess::GPU;
+                // Without calibration the gpu is assumed to start the frame as it was submitted
+                Event.StartUs = _Calibrated ? _AnchorUs + double(int64_t(Begin - _AnchorTicks)) * _Period / 1000.0
+                                            : Slot.SubmitUs + StartMs * 1000.0;
+                Event.DurationUs = DurationMs * 1000.0;
+                Trace::AddEvent(Event);
+            }
+        }
+    }
+} // namespace VEngine
@@ -0,0 +1,107 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanGpuProfilerSpec
+    {
+        VkInstance Instance;
+        VkDevice device;
+        VkPhysicalDevice PhysicalDevice;
+        // Queue the scopes are recorded for, its timestampValidBits decides if profiling works at all
+        uint32_t QueueFamily;
+        uint32_t FrameCount = 2;
+        uint32_t MaxScopes = 64;
+        // VK_EXT_calibrated_timestamps is enabled on the device
+        bool CalibratedTimestamps = false;
+        // pipelineStatisticsQuery is enabled on the device
+        bool PipelineStatistics = false;
+    };
+
+    // Named, nestable timestamp scopes in a frame's primary command buffer. Every frame slot has
+    // its own query pool and its results are read when the slot comes around again, by then the
+    // frame has been waited on so reading never stalls
+    class VulkanGpuProfiler
+    {
+    public:
+        VulkanGpuProfiler() {}
+        ~VulkanGpuProfiler() {}
+
+        void Init(const VulkanGpuProfilerSpec &Spec);
+        void Destroy();
+
+        // Collects what the slot recorded last time and resets its queries, call outside rendering
+        void BeginFrame(VkCommandBuffer Cmd, uint32_t Frame);
+        // Not allowed inside rendering that executes secondaries, scopes go around it instead.
+        // Statistics also counts shader invocations while statistics are on, only one such
+        // scope can be open at a time so nested ones just get timed
+        void BeginScope(VkCommandBuffer Cmd, const char *Name, bool Statistics = false);
+        void EndScope(VkCommandBuffer Cmd);
+        // Cpu time the slot was submitted, places the gpu scopes when clocks can't be calibrated
+        void MarkSubmit(uint32_t Frame);
+
+        bool IsEnabled() const { return _Enabled; }
+        // Takes effect from the next BeginFrame
+        void SetStatistics(bool Enabled) { _StatisticsRequested = Enabled; }
+        // Flags of the statistics query open right now, secondaries executed inside it have to inherit them
+        VkQueryPipelineStatisticFlags GetOpenStatistics() const { return _StatisticsOpen ? STATISTIC_FLAGS : 0; }
+        // Last frame that was read back, start times relative to its first scope
+        const std::vector<GpuScopeTiming> &GetTimings() const { return _Timings; }
+        float GetFrameMs() const { return _FrameMs; }
+
+    private:
+        // Results come back in bit order, which is PipelineStatistics' field order
+        static constexpr VkQueryPipelineStatisticFlags STATISTIC_FLAGS = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                                                         VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+                                                                         VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                                                                         VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+                                                                         VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+        static constexpr uint32_t STATISTIC_COUNT = 5;
+
+        struct Scope
+        {
+            std::string Name;
+            uint32_t Depth;
+            uint32_t BeginQuery, EndQuery;
+            // Index into the slot's statistics pool, UINT32_MAX without
+            uint32_t StatisticsQuery;
+        };
+
+        struct FrameSlot
+        {
+            VkQueryPool Pool = VK_NULL_HANDLE;
+            VkQueryPool StatisticsPool = VK_NULL_HANDLE;
+            uint32_t StatisticsCount = 0;
+            std::vector<Scope> Scopes;
+            uint32_t QueryCount = 0;
+            double SubmitUs = 0.0;
+            bool Submitted = false;
+        };
+
+        void _Resolve(FrameSlot &Slot);
+        void _Calibrate();
+
+        VulkanGpuProfilerSpec _Spec;
+        bool _Enabled = false;
+        // Nanoseconds per tick
+        double _Period = 1.0;
+        uint64_t _TickMask = ~0ull;
+
+        std::vector<FrameSlot> _Slots;
+        uint32_t _Current = 0;
+        // Indices into the current slot's scopes that are still open
+        std::vector<uint32_t> _Open;
+        std::vector<uint64_t> _Results;
+        std::vector<uint64_t> _StatisticsResults;
+        bool _StatisticsRequested = false, _StatisticsActive = false, _StatisticsOpen = false;
+
+        std::vector<GpuScopeTiming> _Timings;
+        float _FrameMs = 0.0f;
+
+        // Gpu tick and trace clock time measured at the same moment
+        bool _Calibrated = false;
+        uint64_t _AnchorTicks = 0;
+        double _AnchorUs = 0.0;
+        PFN_vkGetCalibratedTimestampsEXT _GetCalibratedTimestamps = nullptr;
+        VkTimeDomainEXT _HostDomain;
+    };
+} // namespace VEngine
@@ -0,0 +1,101 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanLinearAllocator.h"
+
+namespace VEngine
+{
+    static VkDeviceSize AlignUp(VkDeviceSize Value, VkDeviceSize Alignment)
+    {
+        return (Value + Alignment - 1) / Alignment * Alignment;
+    }
+
+    void VulkanLinearAllocator::Init(const VulkanLinearAllocatorSpec &Spec)
+    {
+        _Spec = Spec;
+        // Every frame region has to start on an aligned offset too
+        _Spec.SizePerFrame = AlignUp(Spec.SizePerFrame, Spec.Alignment);
+        _CreateBuffer();
+        Reset(0);
+    }
+
+    void VulkanLinearAllocator::_CreateBuffer()
+    {
+        VkBufferCreateInfo bufferInfo = {};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = _Spec.SizePerFrame * _Spec.FrameCount + _Spec.MaxBindingRange;
+        bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        // Written once by the cpu and read once by the gpu, lands in device local memory when the bar allows it
+        VmaAllocationCreateInfo allocInfo = {};
+        allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+        allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VULKAN_SUCCESS_ASSERT(vmaCreateBuffer(_Spec.Allocator, &bufferInfo, &allocInfo, &_Buffer, &_Allocation, &_AllocatoinInfo), "Linear Allocator Failed!");
+        PRINTLN("[VULKAN]: Linear Allocator Created: " << _Spec.SizePerFrame / 1024 << " KB per frame");
+    }
+
+    void VulkanLinearAllocator::Destroy()
+    {
+        vmaDestroyBuffer(_Spec.Allocator, _Buffer, _Allocation);
+        _Buffer = VK_NULL_HANDLE;
+    }
+
+    void VulkanLinearAllocator::Reset(int Frame)
+    {
+        _Begin = _Head = _Spec.SizePerFrame * Frame;
+        _End = _Begin + _Spec.SizePerFrame;
+        _Missing = 0;
+    }
+
+    void VulkanLinearAllocator::Grow(VkDeviceSize SizePerFrame)
+    {
+        int Frame = (int)(_Begin / _Spec.SizePerFrame);
+        Destroy();
+        _Spec.SizePerFrame = AlignUp(std::max(SizePerFrame, _Spec.SizePerFrame), _Spec.Alignment);
+        _Wanted = 0;
+        _CreateBuffer();
+        Reset(Frame);
+    }
+
+    VulkanLinearAllocation VulkanLinearAllocator::Allocate(VkDeviceSize Size)
+    {
+        VkDeviceSize Offset = AlignUp(_Head, _Spec.Alignment);
+        if (Offset + Size > _End)
+        {
+            _Missing += AlignUp(Size, _Spec.Alignment);
+            _Wanted = std::max(_Wanted, GetUsed() + _Missing);
+            return VulkanLinearAllocation();
+        }
+
+        _Head = Offset + Size;
+
+        VulkanLinearAllocation Allocation;
+        Allocation.Buffer = _Buffer;
+        Allocation.Offset = (uint32_t)Offset;
+        Allocation.Mapped = (char *)_AllocatoinInfo.pMappedData + Offset;
+        return Allocation;
+    }
+
+    VulkanLinearAllocation VulkanLinearAllocator::Push(const void *Data, VkDeviceSize Size)
+    {
+        auto Allocation = Allocate(Size);
+        if (!Allocation.Buffer)
+            return Allocation;
+        memcpy(Allocation.Mapped, Data, Size);
+        Flush(Allocation, Size);
+        return Allocation;
+    }
+
+    void VulkanLinearAllocator::Flush(const VulkanLinearAllocation &Allocation, VkDeviceSize Size)
+    {
+        vmaFlushAllocation(_Spec.Allocator, _Allocation, Allocation.Offset, Size);
+    }
+} // namespace VEngine
@@ -0,0 +1,71 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanLinearAllocatorSpec
+    {
+        VmaAllocator Allocator;
+        VkDeviceSize SizePerFrame = 4 * 1024 * 1024;
+        int FrameCount = 2;
+        // Largest of the uniform and storage offset alignments of the device
+        VkDeviceSize Alignment = 256;
+        // Largest descriptor range bound with a dynamic offset, the buffer is padded by this
+        // much so offset + range stays inside it even for the last frame's region
+        VkDeviceSize MaxBindingRange = 0;
+    };
+
+    // Buffer is VK_NULL_HANDLE when the frame's region ran out
+    struct VulkanLinearAllocation
+    {
+        VkBuffer Buffer = VK_NULL_HANDLE;
+        // Offset into Buffer, used as the dynamic offset when binding
+        uint32_t Offset = 0;
+        void *Mapped = nullptr;
+    };
+
+    // One persistently mapped uniform/storage/indirect buffer split in a region per frame in flight.
+    // Per draw data is bumped out of the current frame's region and the whole region is
+    // thrown away at once when that frame comes around again. A frame that doesn't fit gets empty
+    // allocations and remembers how much it wanted, the owner grows the buffer once nothing is in flight
+    class VulkanLinearAllocator
+    {
+    public:
+        VulkanLinearAllocator() {}
+        ~VulkanLinearAllocator() {}
+
+        void Init(const VulkanLinearAllocatorSpec &Spec);
+        void Destroy();
+
+        // Only call once the gpu is done with everything allocated for Frame
+        void Reset(int Frame);
+
+        // Empty allocation when the region is full, nothing is written then
+        VulkanLinearAllocation Allocate(VkDeviceSize Size);
+        // Allocate and copy Data in
+        VulkanLinearAllocation Push(const void *Data, VkDeviceSize Size);
+        // Recreates the buffer with regions of at least SizePerFrame, the old handle is gone after it so
+        // only call with nothing in flight and rewrite whatever binds it
+        void Grow(VkDeviceSize SizePerFrame);
+        // Needed after writing through Mapped of an Allocate, no-op on coherent memory
+        void Flush(const VulkanLinearAllocation &Allocation, VkDeviceSize Size);
+
+        VkBuffer GetHandle() const { return _Buffer; }
+        VkDeviceSize GetUsed() const { return _Head - _Begin; }
+        VkDeviceSize GetSizePerFrame() const { return _Spec.SizePerFrame; }
+        // Most a frame asked for since the last Grow, 0 if every frame fit
+        VkDeviceSize GetOverflow() const { return _Wanted; }
+
+    private:
+        void _CreateBuffer();
+
+    private:
+        VulkanLinearAllocatorSpec _Spec;
+        VkBuffer _Buffer = VK_NULL_HANDLE;
+        VmaAllocation _Allocation;
+        VmaAllocationInfo _AllocatoinInfo;
+
+        VkDeviceSize _Begin = 0, _Head = 0, _End = 0;
+        // Bytes of this frame's failed allocations and the largest total a frame wanted
+        VkDeviceSize _Missing = 0, _Wanted = 0;
+    };
+} // namespace VEngine
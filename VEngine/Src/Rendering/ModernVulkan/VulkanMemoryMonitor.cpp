@@ -0,0 +1,59 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanMemoryMonitor.h"
+
+namespace VEngine
+{
+    void VulkanMemoryMonitor::Init(const VulkanMemoryMonitorSpec &Spec)
+    {
+        _Spec = Spec;
+        _Spec.PollInterval = std::max(_Spec.PollInterval, 1u);
+        _Poll();
+        PRINTLN("[VULKAN]: Device local memory: " << _Info.Usage / (1024 * 1024) << " MB used of " << _Info.Budget / (1024 * 1024) << " MB budget");
+    }
+
+    void VulkanMemoryMonitor::Update(uint32_t FrameIndex)
+    {
+        vmaSetCurrentFrameIndex(_Spec.Allocator, FrameIndex);
+        if (FrameIndex % _Spec.PollInterval == 0)
+            _Poll();
+    }
+
+    void VulkanMemoryMonitor::_Poll()
+    {
+        VmaBudget Budgets[VK_MAX_MEMORY_HEAPS];
+        vmaGetHeapBudgets(_Spec.Allocator, Budgets);
+        const VkPhysicalDeviceMemoryProperties *Props;
+        vmaGetMemoryProperties(_Spec.Allocator, &Props);
+
+        MemoryBudgetInfo Info;
+        for (uint32_t i = 0; i < Props->memoryHeapCount; i++)
+        {
+            if (!(Props->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+                continue;
+            Info.Usage += Budgets[i].usage;
+            Info.Budget += Budgets[i].budget;
+        }
+
+        if (Info.Usage >= Info.Budget * _Spec.HardBudget)
+            Info.Pressure = MemoryPressure::HARD;
+        else if (Info.Usage >= Info.Budget * _Spec.SoftBudget)
+            Info.Pressure = MemoryPressure::SOFT;
+
+        bool Changed = Info.Pressure != _Info.Pressure;
+        _Info = Info;
+        if (Changed)
+        {
+            PRINTLN("[VULKAN]: Memory pressure changed, " << _Info.Usage / (1024 * 1024) << " MB of " << _Info.Budget / (1024 * 1024) << " MB");
+            if (_Callback)
+                _Callback(_Info);
+        }
+    }
+} // namespace VEngine
@@ -0,0 +1,39 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanMemoryMonitorSpec
+    {
+        VmaAllocator Allocator;
+        // Frames between budget reads
+        uint32_t PollInterval = 30;
+        // Share of the device local budget where the soft and hard callbacks go off
+        float SoftBudget = 0.8f;
+        float HardBudget = 0.95f;
+    };
+
+    // Polls vma's heap budgets, which come from VK_EXT_memory_budget when the device has it and
+    // are an estimate otherwise. The callback only fires when the pressure level changes
+    class VulkanMemoryMonitor
+    {
+    public:
+        VulkanMemoryMonitor() {}
+        ~VulkanMemoryMonitor() {}
+
+        void Init(const VulkanMemoryMonitorSpec &Spec);
+
+        // Once per frame, also tells vma the frame index it refreshes its budget with
+        void Update(uint32_t FrameIndex);
+
+        void SetCallback(const MemoryBudgetCallback &Callback) { _Callback = Callback; }
+        const MemoryBudgetInfo &GetInfo() const { return _Info; }
+
+    private:
+        void _Poll();
+
+    private:
+        VulkanMemoryMonitorSpec _Spec;
+        MemoryBudgetCallback _Callback;
+        MemoryBudgetInfo _Info;
+    };
+} // namespace VEngine
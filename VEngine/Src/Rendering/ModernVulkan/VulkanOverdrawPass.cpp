@@ -0,0 +1,227 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanResourceFactory.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanShader.h"
+#include "VulkanOverdrawPass.h"
+
+namespace VEngine
+{
+    static constexpr uint32_t OVERDRAW_GROUP_SIZE = 8;
+
+    enum OverdrawBindings
+    {
+        OVERDRAW_COUNTS,
+        OVERDRAW_HISTOGRAM,
+        OVERDRAW_BINDING_COUNT
+    };
+
+    void VulkanOverdrawPass::Init(const VulkanOverdrawPassSpec &Spec)
+    {
+        _Spec = Spec;
+        _Spec.BinCount = std::max(Spec.BinCount, 2u);
+
+        VkDescriptorSetLayoutBinding bindings[OVERDRAW_BINDING_COUNT]{};
+        bindings[OVERDRAW_COUNTS].binding = OVERDRAW_COUNTS;
+        bindings[OVERDRAW_COUNTS].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[OVERDRAW_COUNTS].descriptorCount = 1;
+        bindings[OVERDRAW_COUNTS].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[OVERDRAW_HISTOGRAM].binding = OVERDRAW_HISTOGRAM;
+        bindings[OVERDRAW_HISTOGRAM].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[OVERDRAW_HISTOGRAM].descriptorCount = 1;
+        bindings[OVERDRAW_HISTOGRAM].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = OVERDRAW_BINDING_COUNT;
+        layoutInfo.pBindings = bindings;
+        VULKAN_SUCCESS_ASSERT(vkCreateDescriptorSetLayout(_Spec.device, &layoutInfo, nullptr, &_Layout), "Overdraw Layout Failed!");
+
+        VkDescriptorPoolSize poolSizes[2]{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        poolSizes[0].descriptorCount = _Spec.FrameCount;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = _Spec.FrameCount;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = 2;
+        poolInfo.pPoolSizes = poolSizes;
+        poolInfo.maxSets = _Spec.FrameCount;
+        VULKAN_SUCCESS_ASSERT(vkCreateDescriptorPool(_Spec.device, &poolInfo, nullptr, &_Pool), "Overdraw Pool Failed!");
+
+        _Slots.resize(_Spec.FrameCount);
+        for (auto &Slot : _Slots)
+        {
+            VkDescriptorSetAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool = _Pool;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &_Layout;
+            VULKAN_SUCCESS_ASSERT(vkAllocateDescriptorSets(_Spec.device, &allocInfo, &Slot.Set), "Overdraw Set Failed!");
+
+            // Read back on the cpu, so cached host memory
+            VkBufferCreateInfo bufferInfo{};
+            bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            bufferInfo.size = sizeof(uint32_t) * _Spec.BinCount;
+            bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            VmaAllocationCreateInfo bufferAllocInfo{};
+            bufferAllocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+            bufferAllocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+            VmaAllocationInfo allocationInfo{};
+            VULKAN_SUCCESS_ASSERT(vmaCreateBuffer(_Spec.Allocator, &bufferInfo, &bufferAllocInfo, &Slot.Histogram, &Slot.HistogramAllocation, &allocationInfo),
+                                  "Overdraw Histogram Failed!");
+            Slot.Mapped = (uint32_t *)allocationInfo.pMappedData;
+
+            VkDescriptorBufferInfo histogramInfo{};
+            histogramInfo.buffer = Slot.Histogram;
+            histogramInfo.offset = 0;
+            histogramInfo.range = VK_WHOLE_SIZE;
+
+            VkWriteDescriptorSet descriptorWrite{};
+            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrite.dstSet = Slot.Set;
+            descriptorWrite.dstBinding = OVERDRAW_HISTOGRAM;
+            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrite.descriptorCount = 1;
+            descriptorWrite.pBufferInfo = &histogramInfo;
+            vkUpdateDescriptorSets(_Spec.device, 1, &descriptorWrite, 0, nullptr);
+        }
+
+        VulkanComputePipelineSpec PipelineSpec{};
+        PipelineSpec.Shader = Spec.Shader;
+        PipelineSpec.device = _Spec.device;
+        PipelineSpec.Name = "overdraw_histogram";
+        PipelineSpec.DescLayouts = {_Layout};
+        PipelineSpec.PushConstantRanges = {{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(OverdrawPushConstants)}};
+        PipelineSpec.Cache = Spec.Cache;
+        _Pipeline.Init(PipelineSpec);
+
+        _Histogram.assign(_Spec.BinCount, 0);
+        PRINTLN("[VULKAN]: Overdraw Pass Created with " << _Spec.BinCount << " bins");
+    }
+
+    void VulkanOverdrawPass::Destroy()
+    {
+        for (auto &Slot : _Slots)
+        {
+            _DestroyImage(Slot);
+            vmaDestroyBuffer(_Spec.Allocator, Slot.Histogram, Slot.HistogramAllocation);
+        }
+        _Slots.clear();
+
+        _Pipeline.Destroy(_Spec.device);
+        vkDestroyDescriptorPool(_Spec.device, _Pool, nullptr);
+        vkDestroyDescriptorSetLayout(_Spec.device, _Layout, nullptr);
+    }
+
+    void VulkanOverdrawPass::_CreateImage(FrameSlot &Slot, VkExtent2D Extent)
+    {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = VK_FORMAT_R32_UINT;
+        imageInfo.extent = {Extent.width, Extent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+        VULKAN_SUCCESS_ASSERT(vmaCreateImage(_Spec.Allocator, &imageInfo, &allocInfo, &Slot.Image, &Slot.ImageAllocation, nullptr), "Overdraw Image Failed!");
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = Slot.Image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = VK_FORMAT_R32_UINT;
+        viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        VULKAN_SUCCESS_ASSERT(vkCreateImageView(_Spec.device, &viewInfo, nullptr, &Slot.View), "Overdraw Image View Failed!");
+        Slot.Extent = Extent;
+
+        VkDescriptorImageInfo countsInfo{};
+        countsInfo.imageView = Slot.View;
+        countsInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet descriptorWrite{};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = Slot.Set;
+        descriptorWrite.dstBinding = OVERDRAW_COUNTS;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pImageInfo = &countsInfo;
+        vkUpdateDescriptorSets(_Spec.device, 1, &descriptorWrite, 0, nullptr);
+    }
+
+    void VulkanOverdrawPass::_DestroyImage(FrameSlot &Slot)
+    {
+        if (Slot.Image == VK_NULL_HANDLE)
+            return;
+
+        vkDestroyImageView(_Spec.device, Slot.View, nullptr);
+        vmaDestroyImage(_Spec.Allocator, Slot.Image, Slot.ImageAllocation);
+        Slot.Image = VK_NULL_HANDLE;
+        Slot.View = VK_NULL_HANDLE;
+        Slot.Extent = {0, 0};
+    }
+
+    void VulkanOverdrawPass::BeginFrame(uint32_t Frame, VkExtent2D Extent)
+    {
+        auto &Slot = _Slots[Frame];
+        if (Slot.Resolved)
+        {
+            vmaInvalidateAllocation(_Spec.Allocator, Slot.HistogramAllocation, 0, VK_WHOLE_SIZE);
+            _Histogram.assign(Slot.Mapped, Slot.Mapped + _Spec.BinCount);
+            Slot.Resolved = false;
+        }
+
+        // Only this slot's submissions ever touched its image and set, and they are done
+        if (Slot.Extent.width != Extent.width || Slot.Extent.height != Extent.height)
+        {
+            _DestroyImage(Slot);
+            _CreateImage(Slot, Extent);
+        }
+    }
+
+    void VulkanOverdrawPass::Clear(VkCommandBuffer Cmd, uint32_t Frame)
+    {
+        auto &Slot = _Slots[Frame];
+        VkImageSubresourceRange Range{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        VkClearColorValue Zero{};
+        vkCmdClearColorImage(Cmd, Slot.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &Zero, 1, &Range);
+        vkCmdFillBuffer(Cmd, Slot.Histogram, 0, VK_WHOLE_SIZE, 0);
+    }
+
+    void VulkanOverdrawPass::Bind(VkCommandBuffer Cmd, VkPipelineLayout Layout, uint32_t Frame)
+    {
+        vkCmdBindDescriptorSets(Cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, Layout, 2, 1, &_Slots[Frame].Set, 0, nullptr);
+    }
+
+    void VulkanOverdrawPass::Resolve(VkCommandBuffer Cmd, uint32_t Frame)
+    {
+        auto &Slot = _Slots[Frame];
+
+        OverdrawPushConstants Constants{Slot.Extent.width, Slot.Extent.height, _Spec.BinCount};
+        vkCmdBindPipeline(Cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _Pipeline.GetHandle());
+        vkCmdBindDescriptorSets(Cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _Pipeline.GetLayout(), 0, 1, &Slot.Set, 0, nullptr);
+        vkCmdPushConstants(Cmd, _Pipeline.GetLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Constants), &Constants);
+        vkCmdDispatch(Cmd, (Slot.Extent.width + OVERDRAW_GROUP_SIZE - 1) / OVERDRAW_GROUP_SIZE,
+                      (Slot.Extent.height + OVERDRAW_GROUP_SIZE - 1) / OVERDRAW_GROUP_SIZE, 1);
+
+        Slot.Resolved = true;
+    }
+} // namespace VEngine
@@ -0,0 +1,76 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanOverdrawPassSpec
+    {
+        VkDevice device;
+        VmaAllocator Allocator;
+        Ref<VulkanShader> Shader;
+        VulkanPipelineCache *Cache = nullptr;
+        uint32_t FrameCount = 2;
+        // Last bin collects every pixel shaded this often or more
+        uint32_t BinCount = 16;
+    };
+
+    // Must match the push_constant block in OverdrawHistogram.comp
+    struct OverdrawPushConstants
+    {
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t BinCount;
+    };
+
+    // Per pixel shading counts for the overdraw mode. The overdraw fragment shader adds to a
+    // counter image, a compute pass bins it into a histogram the cpu reads once the frame is
+    // done. Every frame slot has its own image and histogram so nothing is shared between frames
+    class VulkanOverdrawPass
+    {
+    public:
+        VulkanOverdrawPass() {}
+        ~VulkanOverdrawPass() {}
+
+        void Init(const VulkanOverdrawPassSpec &Spec);
+        void Destroy();
+
+        // Picks up the slot's last histogram and resizes its counter image to Extent.
+        // The slot's previous submission must have completed
+        void BeginFrame(uint32_t Frame, VkExtent2D Extent);
+        // Zeroes the counters in TRANSFER_DST_OPTIMAL and the histogram, barriers are the render graph's
+        void Clear(VkCommandBuffer Cmd, uint32_t Frame);
+        // Counter image as set 2 of the overdraw pipelines
+        void Bind(VkCommandBuffer Cmd, VkPipelineLayout Layout, uint32_t Frame);
+        // Outside rendering, after the frame's draws
+        void Resolve(VkCommandBuffer Cmd, uint32_t Frame);
+
+        VkDescriptorSetLayout GetLayout() const { return _Layout; }
+        VkImage GetImage(uint32_t Frame) const { return _Slots[Frame].Image; }
+        const std::vector<uint32_t> &GetHistogram() const { return _Histogram; }
+
+    private:
+        struct FrameSlot
+        {
+            VkImage Image = VK_NULL_HANDLE;
+            VmaAllocation ImageAllocation = nullptr;
+            VkImageView View = VK_NULL_HANDLE;
+            VkExtent2D Extent{0, 0};
+
+            VkBuffer Histogram = VK_NULL_HANDLE;
+            VmaAllocation HistogramAllocation = nullptr;
+            uint32_t *Mapped = nullptr;
+
+            VkDescriptorSet Set;
+            bool Resolved = false;
+        };
+
+        void _CreateImage(FrameSlot &Slot, VkExtent2D Extent);
+        void _DestroyImage(FrameSlot &Slot);
+
+        VulkanOverdrawPassSpec _Spec;
+        VkDescriptorSetLayout _Layout;
+        VkDescriptorPool _Pool;
+        VulkanComputePipeline _Pipeline;
+        std::vector<FrameSlot> _Slots;
+        std::vector<uint32_t> _Histogram;
+    };
+} // namespace VEngine
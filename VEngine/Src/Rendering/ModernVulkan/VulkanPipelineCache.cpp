@@ -0,0 +1,126 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include <filesystem>
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanPipelineCache.h"
+
+namespace VEngine
+{
+    static const uint32_t PIPELINE_CACHE_MAGIC = 0x43505056; // "VPPC"
+
+    void VulkanPipelineCache::Init(const VulkanPipelineCacheSpec &Spec)
+    {
+        _Spec = Spec;
+
+        std::vector<char> Blob;
+        bool Loaded = _Load(Blob);
+
+        VkPipelineCacheCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        createInfo.initialDataSize = Loaded ? Blob.size() : 0;
+        createInfo.pInitialData = Loaded ? Blob.data() : nullptr;
+
+        VULKAN_SUCCESS_ASSERT(vkCreatePipelineCache(_Spec.device, &createInfo, nullptr, &_Cache), "Pipeline Cache Failed to create!");
+        PRINTLN("[VULKAN]: Pipeline Cache Created, " << (Loaded ? "loaded " : "cold ") << Blob.size() << " bytes from " << _Spec.Path);
+    }
+
+    void VulkanPipelineCache::Destroy()
+    {
+        _Save();
+        PRINTLN("[VULKAN]: Pipeline Cache hits: " << _Hits << " misses: " << _Misses);
+
+        vkDestroyPipelineCache(_Spec.device, _Cache, nullptr);
+        _Cache = VK_NULL_HANDLE;
+    }
+
+    void VulkanPipelineCache::RecordFeedback(const VkPipelineCreationFeedback &Feedback)
+    {
+        if (!(Feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT))
+            return;
+
+        if (Feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT)
+            _Hits++;
+        else
+            _Misses++;
+    }
+
+    bool VulkanPipelineCache::_Load(std::vector<char> &Blob)
+    {
+        std::ifstream file(_Spec.Path, std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        FileHeader Header{};
+        file.read((char *)&Header, sizeof(Header));
+        if (!file || Header.Magic != PIPELINE_CACHE_MAGIC)
+            return false;
+
+        auto &props = _Spec.Properties;
+        if (Header.VendorID != props.vendorID || Header.DeviceID != props.deviceID || Header.DriverVersion != props.driverVersion ||
+            memcmp(Header.UUID, props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+        {
+            PRINTLN("[VULKAN]: Pipeline Cache was written by another device or driver, ignoring it");
+            return false;
+        }
+
+        Blob.resize(Header.DataSize);
+        file.read(Blob.data(), Header.DataSize);
+        if (!file)
+        {
+            Blob.clear();
+            return false;
+        }
+
+        // Driver checks its own header too, reject early so a bad blob never reaches it
+        VkPipelineCacheHeaderVersionOne DriverHeader{};
+        if (Blob.size() < sizeof(DriverHeader))
+            return false;
+        memcpy(&DriverHeader, Blob.data(), sizeof(DriverHeader));
+
+        return DriverHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && DriverHeader.vendorID == props.vendorID &&
+               DriverHeader.deviceID == props.deviceID && memcmp(DriverHeader.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    void VulkanPipelineCache::_Save()
+    {
+        size_t Size = 0;
+        vkGetPipelineCacheData(_Spec.device, _Cache, &Size, nullptr);
+
+        std::vector<char> Blob(Size);
+        if (vkGetPipelineCacheData(_Spec.device, _Cache, &Size, Blob.data()) != VK_SUCCESS)
+            return;
+
+        auto &props = _Spec.Properties;
+        FileHeader Header{};
+        Header.Magic = PIPELINE_CACHE_MAGIC;
+        Header.DataSize = Size;
+        Header.VendorID = props.vendorID;
+        Header.DeviceID = props.deviceID;
+        Header.DriverVersion = props.driverVersion;
+        memcpy(Header.UUID, props.pipelineCacheUUID, VK_UUID_SIZE);
+
+        // Write next to the old file and swap it in so a crash never leaves half a cache behind
+        std::string TempPath = _Spec.Path + ".tmp";
+        {
+            std::ofstream file(TempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+                return;
+            file.write((const char *)&Header, sizeof(Header));
+            file.write(Blob.data(), Size);
+            if (!file)
+                return;
+        }
+
+        std::error_code Error;
+        std::filesystem::rename(TempPath, _Spec.Path, Error);
+        if (Error)
+            PRINTLN("[VULKAN]: Pipeline Cache failed to save: " << Error.message());
+    }
+} // namespace VEngine
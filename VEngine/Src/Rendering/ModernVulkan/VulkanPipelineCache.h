@@ -0,0 +1,50 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanPipelineCacheSpec
+    {
+        VkDevice device;
+        VkPhysicalDeviceProperties Properties;
+        std::string Path;
+    };
+
+    // Driver pipeline cache kept on disk between runs, blob is thrown away when the
+    // gpu or driver it was written by doesn't match the current one
+    class VulkanPipelineCache
+    {
+    public:
+        VulkanPipelineCache() {}
+        ~VulkanPipelineCache() {}
+
+        void Init(const VulkanPipelineCacheSpec &Spec);
+        // Writes the cache back to disk and destroys it
+        void Destroy();
+
+        // Called with the feedback of every pipeline created against this cache
+        void RecordFeedback(const VkPipelineCreationFeedback &Feedback);
+
+        VkPipelineCache GetHandle() const { return _Cache; }
+        uint32_t GetHits() const { return _Hits; }
+        uint32_t GetMisses() const { return _Misses; }
+
+    private:
+        bool _Load(std::vector<char> &Blob);
+        void _Save();
+
+    private:
+        struct FileHeader
+        {
+            uint32_t Magic;
+            uint32_t DataSize;
+            uint32_t VendorID;
+            uint32_t DeviceID;
+            uint32_t DriverVersion;
+            uint8_t UUID[VK_UUID_SIZE];
+        };
+
+        VulkanPipelineCacheSpec _Spec;
+        VkPipelineCache _Cache = VK_NULL_HANDLE;
+        uint32_t _Hits = 0, _Misses = 0;
+    };
+} // namespace VEngine
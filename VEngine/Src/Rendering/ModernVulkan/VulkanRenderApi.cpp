@@ -2,7 +2,9 @@
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
+#endif
 #include "vulkan/vulkan.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -12,6 +14,27 @@
 #include "VulkanRenderApi.h"
 #include "VulkanDevice.h"
 #include "VulkanResourceFactory.h"
+#include "VulkanStagingRing.h"
+#include "VulkanUploadManager.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanShader.h"
+#include "VulkanBindlessTable.h"
+#include "VulkanLinearAllocator.h"
+#include "VulkanDrawBatcher.h"
+#include "VulkanCullPass.h"
+#include "VulkanCommandRecorder.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanOverdrawPass.h"
+#include "VulkanTextureLoader.h"
+#include "VulkanTextureStreamer.h"
+#include "VulkanMemoryMonitor.h"
+#include "VulkanDefragmenter.h"
+#include "VulkanGeometryPool.h"
+#include "VulkanTargetPool.h"
+#include "VulkanRenderGraph.h"
+#include "VulkanDynamicResolution.h"
+#include "VulkanFramePacer.h"
 #include "VulkanRenderData.h"
 #include "VulkanUtils.h"
 
@@ -32,6 +55,54 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
 
 namespace VEngine
 {
+    struct VulkanImageSpec
+    {
+        struct
+        {
+            int x, y;
+        } Dims;
+        VkImageType ImageType;
+        VkFormat Format;
+        VkImageLayout Layout;
+        VkImageUsageFlags Usage;
+        VkSharingMode SharingMode;
+        // Only read with CONCURRENT
+        std::vector<uint32_t> QueueFamilies;
+        VkSampleCountFlagBits Samples;
+        VkImageTiling Tiling;
+        uint32_t MipLevels = 1;
+    };
+
+    void CreateVulkanImage(VmaAllocator Allocator, VkImage &image, VmaAllocation &Allocation, const VulkanImageSpec &Spec)
+    {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.extent.width = Spec.Dims.x;
+        imageInfo.extent.height = Spec.Dims.y;
+        imageInfo.extent.depth = 1;
+        imageInfo.imageType = Spec.ImageType;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = Spec.MipLevels;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = Spec.Format;
+        imageInfo.tiling = Spec.Tiling;
+        imageInfo.initialLayout = Spec.Layout;
+        imageInfo.usage = Spec.Usage;
+        imageInfo.sharingMode = Spec.SharingMode;
+        if (Spec.SharingMode == VK_SHARING_MODE_CONCURRENT)
+        {
+            imageInfo.queueFamilyIndexCount = (uint32_t)Spec.QueueFamilies.size();
+            imageInfo.pQueueFamilyIndices = Spec.QueueFamilies.data();
+        }
+        imageInfo.samples = Spec.Samples;
+
+        VmaAllocationCreateInfo imageAllocInfo{};
+        imageAllocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+        imageAllocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+        vmaCreateImage(Allocator, &imageInfo, &imageAllocInfo, &image, &Allocation, nullptr);
+    }
+
     SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device, VkSurfaceKHR surface)
     {
         SwapChainSupportDetails details;
@@ -80,6 +151,12 @@ namespace VEngine
                                   "VK_KHR_shader_terminate_invocation",
                                   "VK_EXT_sampler_filter_minmax",
                                   "VK_KHR_buffer_device_address"};
+        // Nothing is presented, frames end up in offscreen images
+        if (_Spec.Headless)
+            _Spec.DeviceExtensions.erase(std::remove_if(_Spec.DeviceExtensions.begin(), _Spec.DeviceExtensions.end(),
+                                                        [](const char *Ext)
+                                                        { return strcmp(Ext, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0; }),
+                                         _Spec.DeviceExtensions.end());
         _Data->FrameBufferSize.x = _Spec.FrameBufferSize.x;
         _Data->FrameBufferSize.y = _Spec.FrameBufferSize.y;
 
@@ -94,12 +171,22 @@ namespace VEngine
         allocatorInfo.physicalDevice = _Data->PhysicalDevices[_Data->ActivePhysicalDeviceIndex].PhysicalDevice;
         allocatorInfo.device = _Data->Device.GetHandle();
         allocatorInfo.instance = _Data->Instance;
+        allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_3;
+        // Real budgets from the driver instead of vma's estimate
+        if (_Data->MemoryBudgetExt)
+            allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
 
         VULKAN_SUCCESS_ASSERT(vmaCreateAllocator(&allocatorInfo, &_Data->Allocator), "VMA Allocator failed to initialize!");
         PRINTLN("[VULKAN]: VMA Created!!");
 
+        VulkanDeletionQueueSpec DeletionSpec{};
+        DeletionSpec.device = _Data->Device.GetHandle();
+        DeletionSpec.Allocator = _Data->Allocator;
+        _Data->DeletionQueue.Init(DeletionSpec);
+
+        _CreateFramePacer();
         _CreateSwapChain();
-        _CreateUniformBuffers();
+        _CreateFrameAllocator();
 
         _CreateDescriptorSetLayout();
         _CreateDescriptorPool();
@@ -107,16 +194,27 @@ namespace VEngine
 
         _CreateCommandPool();
         _CreateCommandBuffer();
+        _CreateCommandRecorder();
+        _CreateGpuProfiler();
         _CreateSyncObjects();
+        _CreateUploadManager();
 
         _ResourceFactory = std::make_shared<VulkanResourceFactory>(_Data);
         PRINTLN("[VULKAN]: Vulkan Resource Factory Api Created!!");
 
+        _CreateBindlessTable();
         _CreateTextures();
-        _CreateTextureDescriptorResources();
-        _CreateDepthData();
-
+        _CreateTextureStreamer();
+        _CreateMemoryMonitor();
+        _CreateDefragmenter();
+        _CreateGeometryPool();
+        _CreateTargetPool();
+        _CreateDynamicResolution();
+
+        _CreatePipelineCache();
         _CreateGraphiscPipeline();
+        _CreateDrawBatcher();
+        _CreateCullPass();
 
         PRINTLN("[VULKAN]: New Modern Render Api Created!!");
     }
@@ -124,36 +222,59 @@ namespace VEngine
     void VulkanRenderApi::Terminate()
     {
         vkDeviceWaitIdle(_Data->Device.GetHandle());
+        _CollectRetiredSwapChains(true);
+        // An open defragmentation pass still holds allocations retired buffers own
+        _Data->Defragmenter.Destroy();
+        // First, retired entries may still point into the subsystems below
+        _Data->DeletionQueue.Destroy();
+        _Data->UploadManager.Destroy();
         _ResourceFactory->Terminate();
         PRINTLN("[VULKAN]: Vulkan Resource Factory Api Terminated!!");
+        _Data->TextureStreamer.Destroy();
+        _Data->GeometryPool.Destroy();
 
-        vkDestroyDescriptorPool(_Data->Device.GetHandle(), _Data->TextureDescriptor.pool, nullptr);
-        vkDestroyDescriptorSetLayout(_Data->Device.GetHandle(), _Data->TextureDescriptor.layout, nullptr);
+        _Data->BindlessTable.Destroy();
 
-        vkDestroyImageView(_Data->Device.GetHandle(), _Data->DepthData.imageview, nullptr);
-        vmaDestroyImage(_Data->Allocator, _Data->DepthData.image, _Data->DepthData.allocation);
+        _Data->TargetPool.Destroy();
+        _Data->FramePacer.Destroy();
 
         vkDestroySampler(_Data->Device.GetHandle(), _Data->Texture.sampler, nullptr);
         vkDestroyImageView(_Data->Device.GetHandle(), _Data->Texture.imageView, nullptr);
         vmaDestroyImage(_Data->Allocator, _Data->Texture.image, _Data->Texture.allocation);
-        _Data->GraphicsPipeline.Destroy(_Data->Device.GetHandle());
+        for (size_t i = 0; i < (size_t)VertexFormat::COUNT; i++)
+        {
+            _Data->GraphicsPipeline[i].Destroy(_Data->Device.GetHandle());
+            _Data->IndirectPipeline[i].Destroy(_Data->Device.GetHandle());
+            if (_Data->OverdrawCreated)
+            {
+                _Data->OverdrawPipeline[i].Destroy(_Data->Device.GetHandle());
+                _Data->OverdrawIndirectPipeline[i].Destroy(_Data->Device.GetHandle());
+            }
+        }
+        if (_Data->OverdrawCreated)
+            _Data->OverdrawPass.Destroy();
+        if (_Spec.GpuCulling)
+            _Data->CullPass.Destroy();
+        _Data->PipelineCache.Destroy();
 
-        for (int i = 0; i < _Spec.InFrameFlightCount; i++)
-            _Data->UniformBuffers[i]->Destroy(_Data->Allocator);
+        _Data->FrameAllocator.Destroy();
 
         vkDestroyDescriptorPool(_Data->Device.GetHandle(), _Data->DescriptorPool, nullptr);
         vkDestroyDescriptorSetLayout(_Data->Device.GetHandle(), _Data->DescriptorSetLayout, nullptr);
 
+        // Headless targets are allocator owned, so the swapchain goes before it
+        _DestroySwapChain();
+
         vmaDestroyAllocator(_Data->Allocator);
         for (size_t i = 0; i < _Spec.InFrameFlightCount; i++)
         {
             vkDestroySemaphore(_Data->Device.GetHandle(), _Data->ImageAvailableSemaphores[i], nullptr);
             vkDestroySemaphore(_Data->Device.GetHandle(), _Data->RenderFinishedSemaphores[i], nullptr);
-            vkDestroyFence(_Data->Device.GetHandle(), _Data->InFlightFences[i], nullptr);
         }
+        vkDestroySemaphore(_Data->Device.GetHandle(), _Data->FrameTimeline, nullptr);
         _Data->ImageAvailableSemaphores.clear();
         _Data->RenderFinishedSemaphores.clear();
-        _Data->InFlightFences.clear();
+        _Data->FrameSlotValues.clear();
         // Command buffers are automatically freed when command pool is destroyed
         // But we can explicitly free them if we want to recreate them
         if (!_Data->GraphicsCommandBuffers.empty() && _Data->GraphicsCommandPool != VK_NULL_HANDLE)
@@ -163,13 +284,14 @@ namespace VEngine
             _Data->GraphicsCommandBuffers.clear();
         }
 
+        _Data->Recorder.Destroy();
+        _Data->GpuProfiler.Destroy();
         vkDestroyCommandPool(_Data->Device.GetHandle(), _Data->GraphicsCommandPool, nullptr);
         vkDestroyCommandPool(_Data->Device.GetHandle(), _Data->TransferCommandPool, nullptr);
 
-        _DestroySwapChain();
-
         _Data->Device.Destroy();
-        vkDestroySurfaceKHR(_Data->Instance, _Data->SurfaceKHR, nullptr);
+        if (!_Spec.Headless)
+            vkDestroySurfaceKHR(_Data->Instance, _Data->SurfaceKHR, nullptr);
 
         if (_Spec.EnableValidationLayer)
             DestroyDebugUtilsMessengerEXT(_Data->Instance, _Data->DebugMessenger, nullptr);
@@ -180,50 +302,149 @@ namespace VEngine
 
     void VulkanRenderApi::Render()
     {
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-        VkSemaphore waitSemaphores[] = {_Data->ImageAvailableSemaphores[_Data->CurrentFrame]};
-        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = waitSemaphores;
-        submitInfo.pWaitDstStageMask = waitStages;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &_Data->GraphicsCommandBuffers[_Data->CurrentFrame];
+        // Anything created since the last frame goes out now, the draw waits for it on the gpu
+        UploadToken Uploads = _Data->UploadManager.Flush();
+        if (_Data->FrameSkipped)
+            return;
 
-        VkSemaphore signalSemaphores[] = {_Data->RenderFinishedSemaphores[_Data->CurrentFrame]};
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = signalSemaphores;
+        VkSemaphoreSubmitInfo waitInfos[2]{};
+        waitInfos[0].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        waitInfos[0].semaphore = _Data->ImageAvailableSemaphores[_Data->CurrentFrame];
+        waitInfos[0].stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        // Uploads are on the transfer queue's own timeline
+        waitInfos[1].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        waitInfos[1].semaphore = _Data->UploadManager.GetTimeline();
+        waitInfos[1].value = Uploads;
+        waitInfos[1].stageMask = VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+
+        // Present still needs a binary semaphore, everything else keys off the frame timeline
+        uint64_t FrameValue = ++_Data->FrameTimelineValue;
+        VkSemaphoreSubmitInfo signalInfos[2]{};
+        signalInfos[0].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        signalInfos[0].semaphore = _Data->RenderFinishedSemaphores[_Data->CurrentFrame];
+        signalInfos[0].stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        signalInfos[1].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        signalInfos[1].semaphore = _Data->FrameTimeline;
+        signalInfos[1].value = FrameValue;
+        signalInfos[1].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+        VkCommandBufferSubmitInfo commandInfo{};
+        commandInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+        commandInfo.commandBuffer = _Data->GraphicsCommandBuffers[_Data->CurrentFrame];
+
+        VkSubmitInfo2 submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+        submitInfo.waitSemaphoreInfoCount = 2;
+        submitInfo.pWaitSemaphoreInfos = waitInfos;
+        submitInfo.commandBufferInfoCount = 1;
+        submitInfo.pCommandBufferInfos = &commandInfo;
+        submitInfo.signalSemaphoreInfoCount = 2;
+        submitInfo.pSignalSemaphoreInfos = signalInfos;
+        // Nothing was acquired and nothing gets presented, only the timelines are left
+        if (_Spec.Headless)
+        {
+            submitInfo.waitSemaphoreInfoCount = 1;
+            submitInfo.pWaitSemaphoreInfos = &waitInfos[1];
+            submitInfo.signalSemaphoreInfoCount = 1;
+            submitInfo.pSignalSemaphoreInfos = &signalInfos[1];
+        }
 
-        if (vkQueueSubmit(_Data->Device.GetQueue(QueueFamilies::GRAPHICS), 1, &submitInfo, _Data->InFlightFences[_Data->CurrentFrame]) != VK_SUCCESS)
+        if (vkQueueSubmit2(_Data->Device.GetQueue(QueueFamilies::GRAPHICS), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
             throw std::runtime_error("failed to submit draw command buffer!");
+
+        _Data->FrameSlotValues[_Data->CurrentFrame] = FrameValue;
+        _Data->GpuProfiler.MarkSubmit(_Data->CurrentFrame);
+    }
+
+    uint64_t VulkanRenderApi::_GetCompletedFrameValue()
+    {
+        uint64_t Value = 0;
+        vkGetSemaphoreCounterValue(_Data->Device.GetHandle(), _Data->FrameTimeline, &Value);
+        return Value;
+    }
+
+    void VulkanRenderApi::_WaitFrameValue(uint64_t Value)
+    {
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &_Data->FrameTimeline;
+        waitInfo.pValues = &Value;
+        VULKAN_SUCCESS_ASSERT(vkWaitSemaphores(_Data->Device.GetHandle(), &waitInfo, UINT64_MAX), "Frame Timeline Wait Failed!");
+    }
+
+    uint64_t VulkanRenderApi::GetSubmittedFrame()
+    {
+        return _Data->FrameTimelineValue;
+    }
+
+    uint64_t VulkanRenderApi::GetCompletedFrame()
+    {
+        return _GetCompletedFrameValue();
+    }
+
+    void VulkanRenderApi::WaitForFrame(uint64_t Frame)
+    {
+        _WaitFrameValue(std::min(Frame, _Data->FrameTimelineValue));
+    }
+
+    void VulkanRenderApi::SetMemoryBudgetCallback(const MemoryBudgetCallback &Callback)
+    {
+        _Data->BudgetCallback = Callback;
+    }
+
+    void VulkanRenderApi::SetPresentMode(PresentMode Mode)
+    {
+        if (_Spec.PreferredPresentMode == Mode)
+            return;
+        _Spec.PreferredPresentMode = Mode;
+        // Same path as a resize, the old chain is retired with the frames still using it
+        if (!_Spec.Headless)
+            _Data->FrameBufferChanged = true;
+    }
+
+    void VulkanRenderApi::SetFrameRateLimit(float MaxFrameRate)
+    {
+        _Data->FramePacer.SetMaxFrameRate(MaxFrameRate);
+    }
+
+    void VulkanRenderApi::WaitForNextFrame()
+    {
+        _Data->FramePacer.Wait();
     }
 
     void VulkanRenderApi::FrameBufferResize(int x, int y)
     {
+        // Only remembered, a whole drag of events ends up as one rebuild at the next Begin
         _Data->FrameBufferSize.x = x;
         _Data->FrameBufferSize.y = y;
-        _Data->Extent.width = x;
-        _Data->Extent.height = y;
         _Data->FrameBufferChanged = true;
     }
 
-    void VulkanRenderApi::Submit(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer> &IB)
+    static VkIndexType IndexTypeToVulkan(IndexBufferType Type)
     {
-        _UploadUniformBuffer();
-        auto VulkanVB = std::static_pointer_cast<VulkanVertexBuffer>(VB);
-        auto VulkanIB = std::static_pointer_cast<VulkanIndexBuffer>(IB);
+        // 8 bit indices need an extension and 64 bit ones don't exist in vulkan
+        switch (Type)
+        {
+        case IndexBufferType::UINT_32:
+            return VK_INDEX_TYPE_UINT32;
+        case IndexBufferType::UINT_16:
+        default:
+            return VK_INDEX_TYPE_UINT16;
+        }
+    }
 
-        auto commandBuffer = _Data->GraphicsCommandBuffers[_Data->CurrentFrame];
+    void VulkanRenderApi::_BindPipeline(VkCommandBuffer commandBuffer, const VulkanGraphicsPipeline &Pipeline, uint32_t DrawDataOffset)
+    {
         // Bind pipeline (created without render pass)
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _Data->GraphicsPipeline.GetHandle());
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline.GetHandle());
 
         // Set dynamic viewport (matches pipeline dynamic state)
         VkViewport viewport{};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
-        viewport.width = static_cast<float>(_Data->Extent.width);
-        viewport.height = static_cast<float>(_Data->Extent.height);
+        viewport.width = static_cast<float>(_Data->RenderExtent.width);
+        viewport.height = static_cast<float>(_Data->RenderExtent.height);
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
         vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
@@ -231,23 +452,126 @@ namespace VEngine
         // Set dynamic scissor
         VkRect2D scissor{};
         scissor.offset = {0, 0};
-        scissor.extent = _Data->Extent;
+        scissor.extent = _Data->RenderExtent;
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-        // 🆕 Bind vertex buffer
-        VkBuffer vertexBuffers[] = {VulkanVB->GetHandle()};
-        VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _Data->GraphicsPipeline.GetLayout(), 0, 1, &_Data->TextureDescriptor.sets[_Data->CurrentFrame], 0, nullptr);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _Data->GraphicsPipeline.GetLayout(), 1, 1, &_Data->DescriptorSets[_Data->CurrentFrame], 0, nullptr);
+        // Camera data is the same for the whole frame, draw data only matters to the indirect pipeline
+        VkDescriptorSet Sets[] = {_Data->BindlessTable.GetSet(), _Data->DescriptorSet};
+        uint32_t Offsets[] = {_Data->FrameUniformOffset, DrawDataOffset};
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline.GetLayout(), 0, 2, Sets, 2, Offsets);
+        if (_Data->OverdrawActive)
+            _Data->OverdrawPass.Bind(commandBuffer, Pipeline.GetLayout(), _Data->CurrentFrame);
+    }
 
-        vkCmdBindIndexBuffer(commandBuffer, VulkanIB->GetHandle(), 0, VK_INDEX_TYPE_UINT16);
-        // 🎨 Draw your geometry
-        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(VulkanIB->GetCount()), 1, 0, 0, 0);
+    void VulkanRenderApi::Submit(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer> &IB, const DrawParams &Params)
+    {
+        auto VulkanVB = std::static_pointer_cast<VulkanVertexBuffer>(VB);
+        auto VulkanIB = std::static_pointer_cast<VulkanIndexBuffer>(IB);
+
+        VulkanImmediateDraw Draw{};
+        Draw.VertexBuffer = VulkanVB->GetHandle();
+        Draw.IndexBuffer = VulkanIB->GetHandle();
+        Draw.IndexType = IndexTypeToVulkan(VulkanIB->GetDataType());
+        Draw.IndexCount = static_cast<uint32_t>(VulkanIB->GetCount());
+        Draw.FirstIndex = VulkanIB->GetFirstIndex();
+        Draw.VertexOffset = static_cast<int32_t>(VulkanVB->GetFirstVertex());
+        Draw.Format = VulkanVB->GetFormat();
+        Draw.Constants.Model = Params.Transform;
+        Draw.Constants.Tint = Params.Tint;
+        Draw.Constants.TextureIndex = _TouchTexture(Params);
+        _Data->ImmediateDraws.push_back(Draw);
+    }
+
+    void VulkanRenderApi::_RecordImmediateDraws(VkCommandBuffer commandBuffer, uint32_t Begin, uint32_t End)
+    {
+        if (Begin == End)
+            return;
+
+        auto *Pipelines = _Data->OverdrawActive ? _Data->OverdrawPipeline : _Data->GraphicsPipeline;
+        // Same layout for every format
+        auto layout = Pipelines[0].GetLayout();
+
+        VkBuffer BoundVertex = VK_NULL_HANDLE, BoundIndex = VK_NULL_HANDLE;
+        for (uint32_t i = Begin; i < End; i++)
+        {
+            auto &Draw = _Data->ImmediateDraws[i];
+            if (i == Begin || Draw.Format != _Data->ImmediateDraws[i - 1].Format)
+                _BindPipeline(commandBuffer, Pipelines[(size_t)Draw.Format], _Data->FrameUniformOffset);
+
+            // Everything that changes per draw goes in the command buffer, no buffer writes or binds
+            vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Draw.Constants), &Draw.Constants);
+
+            if (Draw.VertexBuffer != BoundVertex)
+            {
+                VkDeviceSize Offset = 0;
+                vkCmdBindVertexBuffers(commandBuffer, 0, 1, &Draw.VertexBuffer, &Offset);
+                BoundVertex = Draw.VertexBuffer;
+            }
+            if (Draw.IndexBuffer != BoundIndex)
+            {
+                vkCmdBindIndexBuffer(commandBuffer, Draw.IndexBuffer, 0, Draw.IndexType);
+                BoundIndex = Draw.IndexBuffer;
+            }
+            vkCmdDrawIndexed(commandBuffer, Draw.IndexCount, 1, Draw.FirstIndex, Draw.VertexOffset, 0);
+        }
+    }
+
+    uint32_t VulkanRenderApi::_TouchTexture(const DrawParams &Params)
+    {
+        if (!Params.Texture)
+            return _Data->Texture.BindlessIndex;
+        auto &Tex = static_cast<VulkanStreamedTexture &>(*Params.Texture);
+
+        // Bounding sphere to pixels on screen, unbounded draws count as filling it
+        float ScreenSize = (float)_Data->RenderExtent.height, Distance = 0.0f;
+        if (Params.Bounds.w >= 0.0f)
+        {
+            glm::vec4 Center = _Data->View * Params.Transform * glm::vec4(glm::vec3(Params.Bounds), 1.0f);
+            float Scale = std::max({glm::length(glm::vec3(Params.Transform[0])), glm::length(glm::vec3(Params.Transform[1])),
+                                    glm::length(glm::vec3(Params.Transform[2]))});
+            float Radius = Params.Bounds.w * Scale;
+            Distance = glm::length(glm::vec3(Center));
+            // View space looks down -z
+            if (Distance > Radius)
+                ScreenSize = Radius * _Data->ProjScale / std::max(-Center.z, Radius) * _Data->RenderExtent.height;
+        }
+
+        _Data->TextureStreamer.Touch(Tex, ScreenSize, Distance, _Data->RecordingFrameValue());
+        return Tex.GetBindlessIndex();
+    }
+
+    void VulkanRenderApi::SubmitBatched(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer> &IB, const DrawParams &Params)
+    {
+        auto VulkanVB = std::static_pointer_cast<VulkanVertexBuffer>(VB);
+        auto VulkanIB = std::static_pointer_cast<VulkanIndexBuffer>(IB);
+
+        VulkanBatchedDraw Draw{};
+        Draw.VertexBuffer = VulkanVB->GetHandle();
+        Draw.IndexBuffer = VulkanIB->GetHandle();
+        Draw.IndexType = IndexTypeToVulkan(VulkanIB->GetDataType());
+        Draw.IndexCount = static_cast<uint32_t>(VulkanIB->GetCount());
+        Draw.FirstIndex = VulkanIB->GetFirstIndex();
+        Draw.VertexOffset = static_cast<int32_t>(VulkanVB->GetFirstVertex());
+        Draw.Format = VulkanVB->GetFormat();
+        Draw.Instance.Model = Params.Transform;
+        Draw.Instance.Tint = Params.Tint;
+        Draw.Instance.Bounds = Params.Bounds;
+        Draw.Instance.TextureIndex = _TouchTexture(Params);
+        _Data->Batcher.Add(Draw);
     }
 
     void VulkanRenderApi::Present()
     {
+        // Skipped frames are paced too, a minimized window would spin otherwise
+        _Data->FramePacer.EndFrame();
+        if (_Data->FrameSkipped)
+            return;
+        if (_Spec.Headless)
+        {
+            _Data->CurrentFrame = (_Data->CurrentFrame + 1) % _Spec.InFrameFlightCount;
+            return;
+        }
+
         VkSemaphore signalSemaphores[] = {_Data->RenderFinishedSemaphores[_Data->CurrentFrame]};
 
         VkPresentInfoKHR presentInfo{};
@@ -262,13 +586,20 @@ namespace VEngine
         presentInfo.pImageIndices = &_Data->CurrentImageIndex;
         presentInfo.pResults = nullptr; // Optional
 
+        // What the frame pacer waits on
+        VkPresentIdKHR presentId{};
+        presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        presentId.swapchainCount = 1;
+        uint64_t Id = _Data->FramePacer.NextPresentId();
+        presentId.pPresentIds = &Id;
+        if (Id)
+            presentInfo.pNext = &presentId;
+
         auto result = vkQueuePresentKHR(_Data->Device.GetQueue(QueueFamilies::PRESENT), &presentInfo);
 
-        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || _Data->FrameBufferChanged)
-        {
-            _Data->FrameBufferChanged = false;
-            _RecreateSwapChain();
-        }
+        // Rebuilt at the start of the next frame, together with any pending resize
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+            _Data->FrameBufferChanged = true;
         else if (result != VK_SUCCESS)
             throw std::runtime_error("failed to present swap chain image!");
 
@@ -277,76 +608,107 @@ namespace VEngine
 
     void VulkanRenderApi::Begin(const RenderPassSpec &Spec)
     {
-        vkWaitForFences(_Data->Device.GetHandle(), 1, &_Data->InFlightFences[_Data->CurrentFrame], VK_TRUE, UINT64_MAX);
-
-        VkResult result = vkAcquireNextImageKHR(_Data->Device.GetHandle(), _Data->SwapChain, UINT64_MAX,
-                                                _Data->ImageAvailableSemaphores[_Data->CurrentFrame], VK_NULL_HANDLE,
-                                                &_Data->CurrentImageIndex);
+        // Nothing if the app already waited before reading input
+        _Data->FramePacer.Wait();
+        // Slot's last submission has to be done before anything it used is touched
+        _WaitFrameValue(_Data->FrameSlotValues[_Data->CurrentFrame]);
+        // An earlier frame didn't fit and spilled its batched draws
+        if (_Data->FrameAllocator.GetOverflow())
+            _GrowFrameAllocator();
+        // Gpu is done with this frame, everything it allocated can be overwritten
+        _Data->FrameAllocator.Reset(_Data->CurrentFrame);
+        uint64_t Completed = _GetCompletedFrameValue();
+        _Data->Defragmenter.Finish(Completed);
+        _Data->DeletionQueue.Collect(Completed);
+        _CollectRetiredSwapChains(false);
+        _Data->MemoryMonitor.Update((uint32_t)_Data->RecordingFrameValue());
+        _Data->GeometryPool.SetFrameValue(_Data->RecordingFrameValue());
+
+        // Nothing gets recorded or presented until an image is in hand
+        _Data->FrameSkipped = true;
+        if (_Data->FrameBufferChanged && !_RecreateSwapChain())
+            return;
 
+        VkResult result = _Spec.Headless ? VK_SUCCESS : _AcquireImage();
+        // Offscreen images are handed out per frame slot
+        if (_Spec.Headless)
+            _Data->CurrentImageIndex = _Data->CurrentFrame;
         if (result == VK_ERROR_OUT_OF_DATE_KHR)
         {
-            _RecreateSwapChain();
-            return;
+            // Changed between the last present and now, one more rebuild and retry
+            _Data->FrameBufferChanged = true;
+            if (!_RecreateSwapChain())
+                return;
+            result = _AcquireImage();
         }
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
+            return;
         else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
             throw std::runtime_error("failed to acquire swap chain image!");
 
-        if (result != VK_SUCCESS)
-        {
-            std::cout << "ERROR: AcquireNextImage failed: " << result << "\n";
-        }
-        vkResetFences(_Data->Device.GetHandle(), 1, &_Data->InFlightFences[_Data->CurrentFrame]);
+        // Still presentable, gets rebuilt next frame
+        if (result == VK_SUBOPTIMAL_KHR)
+            _Data->FrameBufferChanged = true;
+        _Data->FrameSkipped = false;
+
         vkResetCommandBuffer(_Data->GraphicsCommandBuffers[_Data->CurrentFrame], 0);
+        _Data->ClearColor = {{Spec.ClearColor.x, Spec.ClearColor.y, Spec.ClearColor.z, Spec.ClearColor.w}};
+        _UploadFrameUniforms(Spec);
 
         auto commandBuffer = _Data->GraphicsCommandBuffers[_Data->CurrentFrame];
 
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
         vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        _Data->GpuProfiler.BeginFrame(commandBuffer, _Data->CurrentFrame);
+        _Data->GpuProfiler.BeginScope(commandBuffer, "Frame");
+
+        // Scale follows the gpu time a few frames back, the swapchain may have just changed under it
+        _Data->RenderExtent = _Data->Extent;
+        if (_Data->DynamicResolution)
+            _Data->RenderExtent = VulkanDynamicResolution::Scale(_Data->Extent, _Data->Resolution.Update(_Data->GpuProfiler.GetFrameMs()));
+
+        // Latched for the whole frame so a toggle can't mix pipelines within it
+        _Data->OverdrawActive = _Data->OverdrawRequested && _CreateOverdrawPass();
+        if (_Data->OverdrawActive)
+            _Data->OverdrawPass.BeginFrame(_Data->CurrentFrame, _Data->RenderExtent);
+        if (!_Data->PendingMipTextures.empty())
+            _GenerateMips(commandBuffer);
+        _Data->TextureStreamer.Update(commandBuffer, _Data->RecordingFrameValue());
+        // Before any draw, they have to pick up the moved buffers
+        if (_Spec.Defragmentation)
+            _Data->Defragmenter.Step(commandBuffer, _Data->RecordingFrameValue());
+        // Attachment layouts are the render graph's, it is built and run in End
+    }
 
-        // 🆕 TRANSITION: undefined → color attachment optimal (for rendering)
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = _Data->SwapChainImages[_Data->CurrentImageIndex]; // 🆕 Use the actual image
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-        vkCmdPipelineBarrier(
-            commandBuffer,
-            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,             // Before any operations
-            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, // Before color attachment output
-            0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier);
-
-        // Continue with dynamic rendering...
+    VkResult VulkanRenderApi::_AcquireImage()
+    {
+        return vkAcquireNextImageKHR(_Data->Device.GetHandle(), _Data->SwapChain, UINT64_MAX,
+                                     _Data->ImageAvailableSemaphores[_Data->CurrentFrame], VK_NULL_HANDLE,
+                                     &_Data->CurrentImageIndex);
+    }
+
+    void VulkanRenderApi::_BeginRendering(VkCommandBuffer commandBuffer, VkRenderingFlags Flags, VkImageView ColorView, VkImageView DepthView)
+    {
         VkRenderingInfo renderingInfo{};
         renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
-        renderingInfo.renderArea = {{0, 0}, _Data->Extent};
+        renderingInfo.flags = Flags;
+        renderingInfo.renderArea = {{0, 0}, _Data->RenderExtent};
         renderingInfo.layerCount = 1;
 
         VkRenderingAttachmentInfo colorAttachment{};
         colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-        colorAttachment.imageView = _Data->SwapChainImageViews[_Data->CurrentImageIndex];
+        colorAttachment.imageView = ColorView;
         colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; // ✅ Now correct
         colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
         colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        colorAttachment.clearValue = {{Spec.ClearColor.x, Spec.ClearColor.y, Spec.ClearColor.z, Spec.ClearColor.w}};
+        colorAttachment.clearValue.color = _Data->ClearColor;
 
         // Depth attachment  ✅ ADD THIS
         VkRenderingAttachmentInfo depthAttachment{};
         depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-        depthAttachment.imageView = _Data->DepthData.imageview;
+        depthAttachment.imageView = DepthView;
         depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
         depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
         depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
@@ -361,41 +723,174 @@ namespace VEngine
 
     void VulkanRenderApi::End()
     {
+        if (_Data->FrameSkipped)
+        {
+            _Data->Batcher.Clear();
+            _Data->ImmediateDraws.clear();
+            return;
+        }
+
         auto commandBuffer = _Data->GraphicsCommandBuffers[_Data->CurrentFrame];
 
-        vkCmdEndRendering(commandBuffer);
+        // Color starts out at the stage the acquire waits at, depth is cleared and never stored
+        auto &Graph = _Data->RenderGraph;
+        Graph.Reset();
+        auto ColorUsage = _Spec.Headless ? VulkanResourceUsage::TRANSFER_READ : VulkanResourceUsage::PRESENT;
+        auto Color = Graph.ImportImage("Color", _Data->SwapChainImages[_Data->CurrentImageIndex], VK_IMAGE_ASPECT_COLOR_BIT, ColorUsage, true);
+        // Headless frames are left ready to be copied out
+        Graph.Export(Color, ColorUsage);
+        auto Depth = Graph.CreateImage("Depth", {_Data->DepthFormat, _Data->RenderExtent, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT});
+        // Scaled frames are drawn into a transient of their own and blitted up to the swapchain at the end
+        bool Scaled = _Data->RenderExtent.width != _Data->Extent.width || _Data->RenderExtent.height != _Data->Extent.height;
+        auto Scene = Color;
+        if (Scaled)
+            Scene = Graph.CreateImage("Scene", {_Data->Format, _Data->RenderExtent, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT});
+        auto Commands = Graph.ImportBuffer("Commands", VulkanResourceUsage::INDIRECT_READ);
+
+        VulkanRenderResource Counts = 0, Histogram = 0;
+        if (_Data->OverdrawActive)
+        {
+            Counts = Graph.ImportImage("OverdrawCounts", _Data->OverdrawPass.GetImage(_Data->CurrentFrame), VK_IMAGE_ASPECT_COLOR_BIT,
+                                       VulkanResourceUsage::COMPUTE_READ, true);
+            Histogram = Graph.ImportBuffer("OverdrawHistogram", VulkanResourceUsage::HOST_READ);
+            Graph.Export(Histogram, VulkanResourceUsage::HOST_READ);
+            Graph.AddPass("OverdrawClear", [&](VkCommandBuffer Cmd)
+                          { _Data->OverdrawPass.Clear(Cmd, _Data->CurrentFrame); })
+                .Write(Counts, VulkanResourceUsage::TRANSFER_WRITE)
+                .Write(Histogram, VulkanResourceUsage::TRANSFER_WRITE);
+        }
 
-        // 🆕 TRANSITION: color attachment optimal → present source (for presentation)
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // ✅ Required for presentation
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = _Data->SwapChainImages[_Data->CurrentImageIndex];
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        barrier.dstAccessMask = 0;
-
-        vkCmdPipelineBarrier(
-            commandBuffer,
-            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, // After color attachment writing
-            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,          // Before presentation
-            0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier);
+        // Everything queued with SubmitBatched goes out as a handful of indirect calls
+        auto &Batches = _Data->Batcher.Prepare(_Data->FrameAllocator);
+        // Too many for the frame allocator, they go out one by one with push constants this frame
+        if (_Data->Batcher.Overflowed())
+        {
+            for (auto &Batched : _Data->Batcher.GetDraws())
+            {
+                VulkanImmediateDraw Draw{};
+                Draw.VertexBuffer = Batched.VertexBuffer;
+                Draw.IndexBuffer = Batched.IndexBuffer;
+                Draw.IndexType = Batched.IndexType;
+                Draw.IndexCount = Batched.IndexCount;
+                Draw.FirstIndex = Batched.FirstIndex;
+                Draw.VertexOffset = Batched.VertexOffset;
+                Draw.Format = Batched.Format;
+                Draw.Constants.Model = Batched.Instance.Model;
+                Draw.Constants.Tint = Batched.Instance.Tint;
+                Draw.Constants.TextureIndex = Batched.Instance.TextureIndex;
+                _Data->ImmediateDraws.push_back(Draw);
+            }
+        }
+        bool HasBatches = !_Data->Batcher.Empty();
+        // Dispatches can't be recorded while rendering
+        if (HasBatches && _Spec.GpuCulling)
+        {
+            Graph.AddPass("Cull", [&](VkCommandBuffer Cmd)
+                          {
+                              _Data->GpuProfiler.BeginScope(Cmd, "Cull", true);
+                              _Data->CullPass.Record(Cmd, Batches, _Data->ViewProj);
+                              _Data->GpuProfiler.EndScope(Cmd); })
+                .Write(Commands, VulkanResourceUsage::COMPUTE_WRITE);
+        }
+
+        uint32_t DrawCount = (uint32_t)_Data->ImmediateDraws.size();
+        uint32_t SliceCount = std::min(_Data->Recorder.GetThreadCount(), DrawCount / std::max(_Spec.MinDrawsPerRecordJob, 1u));
 
+        // Timestamps can't go inside rendering that executes secondaries, so the scope wraps it.
+        // Secondaries can only run inside a statistics query with inheritedQueries
+        bool DrawStatistics = SliceCount <= 1 || _Data->Device.GetPhysicalDevice()->Info.features.inheritedQueries;
+        auto *IndirectPipelines = _Data->OverdrawActive ? _Data->OverdrawIndirectPipeline : _Data->IndirectPipeline;
+        auto IndirectLayout = IndirectPipelines[0].GetLayout();
+        auto BindIndirect = [&](VkCommandBuffer Cmd, VertexFormat Format, uint32_t DrawDataOffset)
+        {
+            _BindPipeline(Cmd, IndirectPipelines[(size_t)Format], DrawDataOffset);
+        };
+        auto RecordDraws = [&](VkCommandBuffer Cmd)
+        {
+            VkImageView ColorView = Scaled ? Graph.GetView(Scene) : _Data->SwapChainImageViews[_Data->CurrentImageIndex];
+            _Data->GpuProfiler.BeginScope(Cmd, "Draw", DrawStatistics);
+            if (SliceCount <= 1)
+            {
+                _BeginRendering(Cmd, 0, ColorView, Graph.GetView(Depth));
+                _RecordImmediateDraws(Cmd, 0, DrawCount);
+                if (HasBatches)
+                    _Data->Batcher.Record(Cmd, IndirectLayout, BindIndirect);
+            }
+            else
+            {
+                // Submit draws are cut in contiguous slices, one secondary each, batched draws go last
+                VkCommandBufferInheritanceRenderingInfo Rendering{};
+                Rendering.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+                Rendering.colorAttachmentCount = 1;
+                Rendering.pColorAttachmentFormats = &_Data->Format;
+                Rendering.depthAttachmentFormat = _Data->DepthFormat;
+                Rendering.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+                uint32_t JobCount = SliceCount + (HasBatches ? 1 : 0);
+                auto &Secondaries = _Data->Recorder.Record(_Data->CurrentFrame, Rendering, JobCount, [&](VkCommandBuffer Secondary, uint32_t Job)
+                                                           {
+                                                               if (Job == SliceCount)
+                                                               {
+                                                                   _Data->Batcher.Record(Secondary, IndirectLayout, BindIndirect);
+                                                                   return;
+                                                               }
+                                                               uint32_t Begin = (uint64_t)DrawCount * Job / SliceCount;
+                                                               uint32_t End = (uint64_t)DrawCount * (Job + 1) / SliceCount;
+                                                               _RecordImmediateDraws(Secondary, Begin, End); }, _Data->GpuProfiler.GetOpenStatistics());
+
+                _BeginRendering(Cmd, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT, ColorView, Graph.GetView(Depth));
+                vkCmdExecuteCommands(Cmd, (uint32_t)Secondaries.size(), Secondaries.data());
+            }
+
+            vkCmdEndRendering(Cmd);
+            _Data->GpuProfiler.EndScope(Cmd);
+        };
+        auto DrawPass = Graph.AddPass("Draw", RecordDraws);
+        DrawPass.Write(Scene, VulkanResourceUsage::COLOR_ATTACHMENT).Write(Depth, VulkanResourceUsage::DEPTH_ATTACHMENT);
+        if (HasBatches && _Spec.GpuCulling)
+            DrawPass.Read(Commands, VulkanResourceUsage::INDIRECT_READ);
+
+        if (_Data->OverdrawActive)
+        {
+            DrawPass.Write(Counts, VulkanResourceUsage::FRAGMENT_WRITE);
+            Graph.AddPass("Overdraw", [&](VkCommandBuffer Cmd)
+                          {
+                              _Data->GpuProfiler.BeginScope(Cmd, "Overdraw");
+                              _Data->OverdrawPass.Resolve(Cmd, _Data->CurrentFrame);
+                              _Data->GpuProfiler.EndScope(Cmd); })
+                .Read(Counts, VulkanResourceUsage::COMPUTE_READ)
+                .Write(Histogram, VulkanResourceUsage::COMPUTE_WRITE);
+        }
+
+        if (Scaled)
+        {
+            Graph.AddPass("Upscale", [&](VkCommandBuffer Cmd)
+                          {
+                              _Data->GpuProfiler.BeginScope(Cmd, "Upscale");
+                              VkImageBlit Region{};
+                              Region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+                              Region.srcOffsets[1] = {(int32_t)_Data->RenderExtent.width, (int32_t)_Data->RenderExtent.height, 1};
+                              Region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+                              Region.dstOffsets[1] = {(int32_t)_Data->Extent.width, (int32_t)_Data->Extent.height, 1};
+                              vkCmdBlitImage(Cmd, Graph.GetImage(Scene), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                             _Data->SwapChainImages[_Data->CurrentImageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region, VK_FILTER_LINEAR);
+                              _Data->GpuProfiler.EndScope(Cmd); })
+                .Read(Scene, VulkanResourceUsage::TRANSFER_READ)
+                .Write(Color, VulkanResourceUsage::TRANSFER_WRITE);
+        }
+
+        Graph.Execute(commandBuffer, _Data->RecordingFrameValue());
+        _Data->Batcher.Clear();
+        _Data->ImmediateDraws.clear();
+
+        _Data->GpuProfiler.EndScope(commandBuffer);
         vkEndCommandBuffer(commandBuffer);
     }
 
     void VulkanRenderApi::Finish()
     {
         vkDeviceWaitIdle(_Data->Device.GetHandle());
+        _CollectRetiredSwapChains(true);
     }
 
     Ref<ResourceFactory> VulkanRenderApi::GetResourceFactory()
@@ -403,11 +898,66 @@ namespace VEngine
         return _ResourceFactory;
     }
 
+    std::vector<GpuScopeTiming> VulkanRenderApi::GetGpuTimings()
+    {
+        return _Data->GpuProfiler.GetTimings();
+    }
+
+    void VulkanRenderApi::SetPipelineStatistics(bool Enabled)
+    {
+        _Data->GpuProfiler.SetStatistics(Enabled);
+    }
+
+    void VulkanRenderApi::SetOverdrawMode(bool Enabled)
+    {
+        _Data->OverdrawRequested = Enabled;
+    }
+
+    std::vector<uint32_t> VulkanRenderApi::GetOverdrawHistogram()
+    {
+        if (!_Data->OverdrawCreated)
+            return {};
+        return _Data->OverdrawPass.GetHistogram();
+    }
+
+    RendererStats VulkanRenderApi::GetStats()
+    {
+        RendererStats Stats;
+        Stats.PipelineCacheHits = _Data->PipelineCache.GetHits();
+        Stats.PipelineCacheMisses = _Data->PipelineCache.GetMisses();
+        Stats.FrameAllocatorUsed = _Data->FrameAllocator.GetUsed();
+        Stats.BatchedDraws = _Data->Batcher.GetDrawCount();
+        Stats.IndirectBatches = _Data->Batcher.GetBatchCount();
+        Stats.SpilledDraws = _Data->Batcher.GetSpilledCount();
+        Stats.FrameAllocatorSize = _Data->FrameAllocator.GetSizePerFrame();
+        Stats.PendingDeletions = (uint32_t)_Data->DeletionQueue.GetPendingCount();
+        Stats.GpuFrameMs = _Data->GpuProfiler.GetFrameMs();
+        Stats.StreamedTextureBytes = _Data->TextureStreamer.GetResidentBytes();
+        Stats.StreamingBudget = _Data->TextureStreamer.GetBudget();
+        Stats.PendingTextureLoads = _Data->TextureStreamer.GetPendingLoads();
+        Stats.GpuMemoryUsage = _Data->MemoryMonitor.GetInfo().Usage;
+        Stats.GpuMemoryBudget = _Data->MemoryMonitor.GetInfo().Budget;
+        Stats.DefragmentationMoves = _Data->Defragmenter.GetMoves();
+        Stats.DefragmentedBytes = _Data->Defragmenter.GetBytesMoved();
+        Stats.GeometryPoolUsed = _Data->GeometryPool.GetUsedBytes();
+        Stats.GeometryPoolCapacity = _Data->GeometryPool.GetCapacity();
+        Stats.RenderGraphBarriers = _Data->RenderGraph.GetBarrierCount();
+        Stats.CulledPasses = _Data->RenderGraph.GetCulledCount();
+        Stats.TransientTargetHeap = _Data->TargetPool.GetHeapSize();
+        Stats.TransientTargetBytes = _Data->TargetPool.GetUnaliasedBytes();
+        Stats.RenderScale = _Data->DynamicResolution ? _Data->Resolution.GetScale() : 1.0f;
+        Stats.FramePacingMs = _Data->FramePacer.GetWaitMs();
+        return Stats;
+    }
+
     void VulkanRenderApi::_CreateInstance()
     {
         std::vector<const char *> RequiredExts, RequiredLayers;
-        RequiredExts.push_back("VK_KHR_win32_surface");
-        RequiredExts.push_back("VK_KHR_surface");
+        if (!_Spec.Headless)
+        {
+            RequiredExts.push_back("VK_KHR_win32_surface");
+            RequiredExts.push_back("VK_KHR_surface");
+        }
 
         if (_Spec.EnableValidationLayer)
         {
@@ -489,6 +1039,13 @@ namespace VEngine
 
     void VulkanRenderApi::_CreateWin32Surface()
     {
+        if (_Spec.Headless)
+        {
+            _Data->SurfaceKHR = VK_NULL_HANDLE;
+            return;
+        }
+
+#ifdef _WIN32
         VkWin32SurfaceCreateInfoKHR createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
         createInfo.hwnd = (HWND)_Spec.Win32Surface;
@@ -497,6 +1054,9 @@ namespace VEngine
         if (vkCreateWin32SurfaceKHR(_Data->Instance, &createInfo, nullptr, &_Data->SurfaceKHR) != VK_SUCCESS)
             throw std::runtime_error("failed to create window surface!");
         PRINTLN("[VULKAN]: Window Surface KHR Created!")
+#else
+        throw std::runtime_error("Only win32 surfaces are supported, use Headless!");
+#endif
     }
 
     void VulkanRenderApi::_CreatePhysicalDevice()
@@ -522,7 +1082,8 @@ namespace VEngine
         {
             _FillVulkanPhysicalDevice(device, _Data->SurfaceKHR);
 
-            device.Info.SwapChainDetails = QuerySwapChainSupport(device.PhysicalDevice, _Data->SurfaceKHR);
+            if (!_Spec.Headless)
+                device.Info.SwapChainDetails = QuerySwapChainSupport(device.PhysicalDevice, _Data->SurfaceKHR);
 
             PRINTLN("[VULKAN]: Device Found: " << device.Info.properties.deviceName << "\n");
         }
@@ -533,6 +1094,14 @@ namespace VEngine
         _FindSuitablePhysicalDevice();
     }
 
+    // The bindless table and the shaders indexing it need all of these, the device enables them unconditionally
+    static bool HasBindlessFeatures(const VkPhysicalDeviceVulkan12Features &Features)
+    {
+        return Features.descriptorIndexing && Features.runtimeDescriptorArray && Features.descriptorBindingPartiallyBound &&
+               Features.descriptorBindingSampledImageUpdateAfterBind && Features.descriptorBindingUpdateUnusedWhilePending &&
+               Features.shaderSampledImageArrayNonUniformIndexing;
+    }
+
     void VulkanRenderApi::_FindSuitablePhysicalDevice()
     {
         int Scores[_Data->PhysicalDevices.size()];
@@ -543,6 +1112,13 @@ namespace VEngine
             auto &deviceinfo = device.Info;
             int CurrentScore = 0;
 
+            if (!HasBindlessFeatures(deviceinfo.features12))
+            {
+                PRINTLN("[VULKAN]: " << deviceinfo.properties.deviceName << " skipped, missing descriptor indexing features");
+                Scores[i++] = -1;
+                continue;
+            }
+
             if (deviceinfo.features13.dynamicRendering == true)
                 CurrentScore += 1000;
             if (deviceinfo.features13.synchronization2 == true)
@@ -579,12 +1155,43 @@ namespace VEngine
             if (Scores[Bestid] < Scores[i])
                 Bestid = i;
         }
+        if (Scores[Bestid] < 0)
+            throw std::runtime_error("No vulkan device supports descriptor indexing");
         PRINTLN("Chosen Device: " << _Data->PhysicalDevices[Bestid].Info.properties.deviceName << "\n")
         _Data->ActivePhysicalDeviceIndex = Bestid;
     }
 
     void VulkanRenderApi::_CreateLogicalDevice()
     {
+        // Optional, lines gpu profiler timestamps up with cpu traces
+        auto &PhysicalDevice = _Data->PhysicalDevices[_Data->ActivePhysicalDeviceIndex];
+        _Data->CalibratedTimestamps = _Spec.GpuProfiling && HasVulkanPhysicalDeviceExtension(PhysicalDevice.PhysicalDevice, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+        if (_Data->CalibratedTimestamps)
+            _Spec.DeviceExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+        _Data->MemoryBudgetExt = HasVulkanPhysicalDeviceExtension(PhysicalDevice.PhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (_Data->MemoryBudgetExt)
+            _Spec.DeviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        // Optional, lets the frame pacer wait for presents to reach the display. Both features have to be there
+        if (!_Spec.Headless && _Spec.PresentWait && HasVulkanPhysicalDeviceExtension(PhysicalDevice.PhysicalDevice, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+            HasVulkanPhysicalDeviceExtension(PhysicalDevice.PhysicalDevice, VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+        {
+            VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+            presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+            VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+            presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+            presentIdFeatures.pNext = &presentWaitFeatures;
+            VkPhysicalDeviceFeatures2 features2{};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &presentIdFeatures;
+            vkGetPhysicalDeviceFeatures2(PhysicalDevice.PhysicalDevice, &features2);
+            _Data->PresentWait = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+        }
+        if (_Data->PresentWait)
+        {
+            _Spec.DeviceExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            _Spec.DeviceExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+        }
+
         _Data->Device.Init(&_Data->PhysicalDevices[_Data->ActivePhysicalDeviceIndex], _Spec.DeviceExtensions);
     }
 
@@ -598,11 +1205,20 @@ namespace VEngine
         return availableFormats[0];
     }
 
-    VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes)
+    VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes, PresentMode Preferred)
     {
-        for (const auto &availablePresentMode : availablePresentModes)
-            if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-                return availablePresentMode;
+        // Closest first, the modes that don't wait for vblank stand in for each other
+        std::vector<VkPresentModeKHR> Candidates;
+        if (Preferred == PresentMode::MAILBOX)
+            Candidates = {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+        else if (Preferred == PresentMode::IMMEDIATE)
+            Candidates = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+        else if (Preferred == PresentMode::FIFO_RELAXED)
+            Candidates = {VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+
+        for (auto Candidate : Candidates)
+            if (std::find(availablePresentModes.begin(), availablePresentModes.end(), Candidate) != availablePresentModes.end())
+                return Candidate;
 
         // Always availale
         return VK_PRESENT_MODE_FIFO_KHR;
@@ -627,8 +1243,14 @@ namespace VEngine
         }
     }
 
-    void VulkanRenderApi::_CreateSwapChain()
+    void VulkanRenderApi::_CreateSwapChain(VkSwapchainKHR OldSwapChain)
     {
+        if (_Spec.Headless)
+        {
+            _CreateOffscreenTargets();
+            return;
+        }
+
         auto &deviceInfo = _Data->PhysicalDevices[_Data->ActivePhysicalDeviceIndex].Info;
         SwapChainSupportDetails &support = deviceInfo.SwapChainDetails;
 
@@ -636,8 +1258,8 @@ namespace VEngine
         VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(support.formats);
         _Data->Format = surfaceFormat.format;
 
-        // Choose present mode (prefer mailbox for triple buffering)
-        VkPresentModeKHR presentMode = ChooseSwapPresentMode(support.presentModes);
+        // Choose present mode
+        VkPresentModeKHR presentMode = ChooseSwapPresentMode(support.presentModes, _Spec.PreferredPresentMode);
 
         // Choose extent
         _Data->Extent = ChooseSwapExtent(support.capabilities, _Data->FrameBufferSize.x, _Data->FrameBufferSize.y);
@@ -677,10 +1299,12 @@ namespace VEngine
         createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
         createInfo.presentMode = presentMode;
         createInfo.clipped = VK_TRUE;
-        createInfo.oldSwapchain = VK_NULL_HANDLE;
+        // Lets the driver hand over resources from the chain being replaced
+        createInfo.oldSwapchain = OldSwapChain;
 
         VULKAN_SUCCESS_ASSERT(vkCreateSwapchainKHR(_Data->Device.GetHandle(), &createInfo, nullptr, &_Data->SwapChain), "[VULKAN]: SwapChain createion Failed!");
-        PRINTLN("[VULKAN]: SwapChain created!");
+        PRINTLN("[VULKAN]: SwapChain created! Present mode " << presentMode);
+        _Data->FramePacer.SetSwapChain(_Data->SwapChain, presentMode);
 
         uint32_t count = 0;
         vkGetSwapchainImagesKHR(_Data->Device.GetHandle(), _Data->SwapChain, &count, nullptr);
@@ -712,18 +1336,128 @@ namespace VEngine
         PRINTLN("[VULKAN]: Image Views created!");
     }
 
-    void VulkanRenderApi::_RecreateSwapChain()
+    bool VulkanRenderApi::_RecreateSwapChain()
     {
-        vkDeviceWaitIdle(_Data->Device.GetHandle());
-        _DestroySwapChain();
-        _CreateSwapChain();
+        if (_Spec.Headless)
+        {
+            if (_Data->FrameBufferSize.x <= 0 || _Data->FrameBufferSize.y <= 0)
+                return false;
+            _Data->FrameBufferChanged = false;
+
+            uint64_t Value = _Data->RecordingFrameValue();
+            for (size_t i = 0; i < _Data->SwapChainImages.size(); i++)
+            {
+                _Data->DeletionQueue.RetireImageView(_Data->SwapChainImageViews[i], Value);
+                _Data->DeletionQueue.RetireImage(_Data->SwapChainImages[i], _Data->OffscreenAllocations[i], Value);
+            }
+
+            _CreateOffscreenTargets();
+            return true;
+        }
+
+        auto &PhysicalDevice = _Data->PhysicalDevices[_Data->ActivePhysicalDeviceIndex];
+        auto &Capabilities = PhysicalDevice.Info.SwapChainDetails.capabilities;
+        // Queried once at device pick, stale as soon as the window changes
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(PhysicalDevice.PhysicalDevice, _Data->SurfaceKHR, &Capabilities);
+
+        // Minimized, FrameBufferChanged stays set so it's tried again every frame
+        if (_Data->FrameBufferSize.x <= 0 || _Data->FrameBufferSize.y <= 0 ||
+            Capabilities.currentExtent.width == 0 || Capabilities.currentExtent.height == 0)
+            return false;
+        _Data->FrameBufferChanged = false;
+
+        // No device idle, depth follows the extent on its own. The old chain and its views go through the deletion
+        // queue once its last present is done, without present wait that's right away
+        VulkanRetiredSwapChain Retired{_Data->SwapChain, _Data->SwapChainImageViews, _Data->FramePacer.GetPresentId()};
+        _Data->RetiredSwapChains.push_back(Retired);
+
+        _CreateSwapChain(Retired.SwapChain);
+        _CollectRetiredSwapChains(false);
+
+        PRINTLN("[VULKAN]: SwapChain Recreated: " << _Data->Extent.width << "x" << _Data->Extent.height);
+        return true;
+    }
+
+    void VulkanRenderApi::_CollectRetiredSwapChains(bool Idle)
+    {
+        VkDevice device = _Data->Device.GetHandle();
+        auto &Retired = _Data->RetiredSwapChains;
+        Retired.erase(std::remove_if(Retired.begin(), Retired.end(), [&](VulkanRetiredSwapChain &Chain)
+                                     {
+                                         if (Idle)
+                                         {
+                                             for (auto imageview : Chain.Views)
+                                                 vkDestroyImageView(device, imageview, nullptr);
+                                             vkDestroySwapchainKHR(device, Chain.SwapChain, nullptr);
+                                             return true;
+                                         }
+                                         if (!_Data->FramePacer.WaitForPresent(Chain.SwapChain, Chain.LastPresentId, 0))
+                                             return false;
+                                         // Last frame that used it is the one before, one more gives its present time to be picked up
+                                         uint64_t Value = _Data->RecordingFrameValue();
+                                         for (auto imageview : Chain.Views)
+                                             _Data->DeletionQueue.RetireImageView(imageview, Value);
+                                         _Data->DeletionQueue.RetireSwapChain(Chain.SwapChain, Value);
+                                         return true; }),
+                      Retired.end());
     }
 
     void VulkanRenderApi::_DestroySwapChain()
     {
         for (auto imageview : _Data->SwapChainImageViews)
             vkDestroyImageView(_Data->Device.GetHandle(), imageview, nullptr);
-        vkDestroySwapchainKHR(_Data->Device.GetHandle(), _Data->SwapChain, nullptr);
+
+        if (_Spec.Headless)
+        {
+            for (size_t i = 0; i < _Data->SwapChainImages.size(); i++)
+                vmaDestroyImage(_Data->Allocator, _Data->SwapChainImages[i], _Data->OffscreenAllocations[i]);
+            _Data->OffscreenAllocations.clear();
+        }
+        else
+            vkDestroySwapchainKHR(_Data->Device.GetHandle(), _Data->SwapChain, nullptr);
+        _Data->SwapChainImages.clear();
+        _Data->SwapChainImageViews.clear();
+    }
+
+    void VulkanRenderApi::_CreateOffscreenTargets()
+    {
+        // Stand in for the swapchain, one image per frame in flight so a frame never waits on another's image
+        _Data->Format = VK_FORMAT_R8G8B8A8_SRGB;
+        _Data->Extent = {(uint32_t)_Data->FrameBufferSize.x, (uint32_t)_Data->FrameBufferSize.y};
+
+        _Data->SwapChainImages.resize(_Spec.InFrameFlightCount);
+        _Data->SwapChainImageViews.resize(_Spec.InFrameFlightCount);
+        _Data->OffscreenAllocations.resize(_Spec.InFrameFlightCount);
+
+        for (int i = 0; i < _Spec.InFrameFlightCount; i++)
+        {
+            VulkanImageSpec ImageSpec{};
+            ImageSpec.Dims.x = _Data->Extent.width;
+            ImageSpec.Dims.y = _Data->Extent.height;
+            ImageSpec.Format = _Data->Format;
+            ImageSpec.ImageType = VK_IMAGE_TYPE_2D;
+            ImageSpec.Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            ImageSpec.Samples = VK_SAMPLE_COUNT_1_BIT;
+            // Transfer source so results can be copied out and compared, destination for the upscale
+            ImageSpec.Usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            ImageSpec.SharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            ImageSpec.Tiling = VK_IMAGE_TILING_OPTIMAL;
+            CreateVulkanImage(_Data->Allocator, _Data->SwapChainImages[i], _Data->OffscreenAllocations[i], ImageSpec);
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = _Data->SwapChainImages[i];
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = _Data->Format;
+            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            viewInfo.subresourceRange.baseMipLevel = 0;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            VULKAN_SUCCESS_ASSERT(vkCreateImageView(_Data->Device.GetHandle(), &viewInfo, nullptr, &_Data->SwapChainImageViews[i]), "[VULKAN]: Offscreen View Creation Failed!");
+        }
+        PRINTLN("[VULKAN]: Offscreen targets created: " << _Data->Extent.width << "x" << _Data->Extent.height);
     }
 
     void ReadFile(const char *FilePath, std::vector<char> &CharData)
@@ -766,19 +1500,196 @@ namespace VEngine
         return stage;
     }
 
+    // In the order the format's struct has them, locations match VertexShader.vert
+    static std::vector<VulkanVertexAttribute> GetVertexAttributes(VertexFormat Format)
+    {
+        if (Format == VertexFormat::PACKED)
+            return {{0, 0, ShaderDataType::HALF4, "position"}, {0, 3, ShaderDataType::SNORM16_2, "normal"}, {0, 4, ShaderDataType::SNORM8_4, "tangent"},
+                    {0, 2, ShaderDataType::HALF2, "tex"}, {0, 1, ShaderDataType::UNORM8_4, "color"}};
+        return {{0, 0, ShaderDataType::FLOAT3, "position"}, {0, 1, ShaderDataType::FLOAT3, "color"}, {0, 2, ShaderDataType::FLOAT2, "tex"}};
+    }
+
+    // One copy of Base per vertex format, in VertexFormat order
+    static std::vector<ShaderSpec> GetVertexFormatShaders(const ShaderSpec &Base)
+    {
+        std::vector<ShaderSpec> Shaders((size_t)VertexFormat::COUNT, Base);
+        Shaders[(size_t)VertexFormat::PACKED].Name += "_packed";
+        Shaders[(size_t)VertexFormat::PACKED].Defines.push_back({"PACKED_VERTEX", "1"});
+        return Shaders;
+    }
+
     void VulkanRenderApi::_CreateGraphiscPipeline()
     {
         VulkanGraphicsPipelineSpec GraphicsSpec;
-        GraphicsSpec.Attributes = {{0, 0, ShaderDataType::FLOAT3, "position"}, {0, 1, ShaderDataType::FLOAT3, "color"}, {0, 2, ShaderDataType::FLOAT2, "tex"}};
-        GraphicsSpec.Paths = {"vert.spv", "frag.spv"};
-        GraphicsSpec.Name = "main";
+        ShaderSpec Shaders;
+        Shaders.Name = "main";
+        Shaders.Paths = {_Spec.ShaderDirectory + "VertexShader.vert", _Spec.ShaderDirectory + "FragmentShader.frag"};
+        Shaders.UsingTypes = {SHDAER_TYPE_VERTEX, SHDAER_TYPE_FRAGMENT};
+        Shaders.CacheDirectory = _Spec.ShaderCacheDirectory;
+
+        ShaderSpec IndirectShaders = Shaders;
+        IndirectShaders.Name = "main_indirect";
+        IndirectShaders.Defines = {{"INDIRECT", "1"}};
+
+        // Plain ones first, then the indirect ones
+        auto Specs = GetVertexFormatShaders(Shaders);
+        auto IndirectSpecs = GetVertexFormatShaders(IndirectShaders);
+        Specs.insert(Specs.end(), IndirectSpecs.begin(), IndirectSpecs.end());
+        auto Compiled = Shader::CreateMany(Specs);
+        if (std::find(Compiled.begin(), Compiled.end(), nullptr) != Compiled.end())
+            throw std::runtime_error("Main shader failed to compile!");
+
         GraphicsSpec.device = _Data->Device.GetHandle();
         GraphicsSpec.SwapChainFormat = _Data->Format;
-        GraphicsSpec.DescLayouts = {_Data->TextureDescriptor.layout, _Data->DescriptorSetLayout};
+        GraphicsSpec.DescLayouts = {_Data->BindlessTable.GetLayout(), _Data->DescriptorSetLayout};
+        GraphicsSpec.PushConstantRanges = {{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawPushConstants)}};
         GraphicsSpec.UseDepth = true;
-        GraphicsSpec.DepthFormat = _Data->DepthData.format;
+        GraphicsSpec.DepthFormat = _Data->DepthFormat;
+        GraphicsSpec.Cache = &_Data->PipelineCache;
+
+        // Same layout everywhere so sets bound for one stay valid for the others
+        size_t FormatCount = (size_t)VertexFormat::COUNT;
+        for (size_t i = 0; i < FormatCount; i++)
+        {
+            GraphicsSpec.Attributes = GetVertexAttributes((VertexFormat)i);
+            GraphicsSpec.Shader = std::static_pointer_cast<VulkanShader>(Compiled[i]);
+            GraphicsSpec.Name = Specs[i].Name.c_str();
+            _Data->GraphicsPipeline[i].Init(GraphicsSpec);
+
+            GraphicsSpec.Shader = std::static_pointer_cast<VulkanShader>(Compiled[FormatCount + i]);
+            GraphicsSpec.Name = Specs[FormatCount + i].Name.c_str();
+            _Data->IndirectPipeline[i].Init(GraphicsSpec);
+        }
+    }
+
+    void VulkanRenderApi::_CreateDrawBatcher()
+    {
+        auto &Info = _Data->Device.GetPhysicalDevice()->Info;
 
-        _Data->GraphicsPipeline.Init(GraphicsSpec);
+        VulkanDrawBatcherSpec Spec{};
+        // Counts only pay off with multi draw calls, without firstInstance every draw is a call of its own
+        Spec.FirstInstance = Info.features.drawIndirectFirstInstance;
+        Spec.UseDrawCount = Info.features12.drawIndirectCount && Spec.FirstInstance;
+        Spec.MaxDrawsPerCall = Info.features.multiDrawIndirect ? Info.properties.limits.maxDrawIndirectCount : 1;
+        Spec.MaxDraws = _Spec.MaxBatchedDraws;
+        Spec.GpuCulling = _Spec.GpuCulling;
+
+        _Data->Batcher.Init(Spec);
+    }
+
+    bool VulkanRenderApi::_CreateOverdrawPass()
+    {
+        if (_Data->OverdrawCreated)
+            return true;
+
+        // Built the first time the mode is switched on, costs one hitch instead of startup time for everyone
+        if (!_Data->Device.GetPhysicalDevice()->Info.features.fragmentStoresAndAtomics)
+        {
+            PRINTLN("[VULKAN]: No fragmentStoresAndAtomics, Overdraw mode unavailable");
+            _Data->OverdrawRequested = false;
+            return false;
+        }
+
+        ShaderSpec Shaders;
+        Shaders.Name = "main_overdraw";
+        Shaders.Paths = {_Spec.ShaderDirectory + "VertexShader.vert", _Spec.ShaderDirectory + "FragmentShader.frag"};
+        Shaders.UsingTypes = {SHDAER_TYPE_VERTEX, SHDAER_TYPE_FRAGMENT};
+        Shaders.CacheDirectory = _Spec.ShaderCacheDirectory;
+        Shaders.Defines = {{"OVERDRAW", "1"}};
+
+        ShaderSpec IndirectShaders = Shaders;
+        IndirectShaders.Name = "main_indirect_overdraw";
+        IndirectShaders.Defines = {{"OVERDRAW", "1"}, {"INDIRECT", "1"}};
+
+        ShaderSpec HistogramShader;
+        HistogramShader.Name = "overdraw_histogram";
+        HistogramShader.Paths = {_Spec.ShaderDirectory + "OverdrawHistogram.comp"};
+        HistogramShader.UsingTypes = {SHDAER_TYPE_COMPUTE};
+        HistogramShader.CacheDirectory = _Spec.ShaderCacheDirectory;
+
+        // Plain and indirect per vertex format, the histogram last
+        auto Specs = GetVertexFormatShaders(Shaders);
+        auto IndirectSpecs = GetVertexFormatShaders(IndirectShaders);
+        Specs.insert(Specs.end(), IndirectSpecs.begin(), IndirectSpecs.end());
+        Specs.push_back(HistogramShader);
+        auto Compiled = Shader::CreateMany(Specs);
+        if (std::find(Compiled.begin(), Compiled.end(), nullptr) != Compiled.end())
+        {
+            PRINTLN("[VULKAN]: Overdraw shaders failed to compile, Overdraw mode unavailable");
+            _Data->OverdrawRequested = false;
+            return false;
+        }
+
+        VulkanOverdrawPassSpec Spec{};
+        Spec.device = _Data->Device.GetHandle();
+        Spec.Allocator = _Data->Allocator;
+        Spec.Shader = std::static_pointer_cast<VulkanShader>(Compiled.back());
+        Spec.Cache = &_Data->PipelineCache;
+        Spec.FrameCount = _Spec.InFrameFlightCount;
+        Spec.BinCount = _Spec.OverdrawBins;
+        _Data->OverdrawPass.Init(Spec);
+
+        VulkanGraphicsPipelineSpec GraphicsSpec;
+        GraphicsSpec.device = _Data->Device.GetHandle();
+        GraphicsSpec.SwapChainFormat = _Data->Format;
+        // First two sets match the main pipelines, so switching keeps them bound
+        GraphicsSpec.DescLayouts = {_Data->BindlessTable.GetLayout(), _Data->DescriptorSetLayout, _Data->OverdrawPass.GetLayout()};
+        GraphicsSpec.PushConstantRanges = {{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawPushConstants)}};
+        GraphicsSpec.UseDepth = true;
+        GraphicsSpec.DepthFormat = _Data->DepthFormat;
+        GraphicsSpec.Cache = &_Data->PipelineCache;
+
+        size_t FormatCount = (size_t)VertexFormat::COUNT;
+        for (size_t i = 0; i < FormatCount; i++)
+        {
+            GraphicsSpec.Attributes = GetVertexAttributes((VertexFormat)i);
+            GraphicsSpec.Shader = std::static_pointer_cast<VulkanShader>(Compiled[i]);
+            GraphicsSpec.Name = Specs[i].Name.c_str();
+            _Data->OverdrawPipeline[i].Init(GraphicsSpec);
+
+            GraphicsSpec.Shader = std::static_pointer_cast<VulkanShader>(Compiled[FormatCount + i]);
+            GraphicsSpec.Name = Specs[FormatCount + i].Name.c_str();
+            _Data->OverdrawIndirectPipeline[i].Init(GraphicsSpec);
+        }
+
+        _Data->OverdrawCreated = true;
+        return true;
+    }
+
+    void VulkanRenderApi::_CreateCullPass()
+    {
+        if (!_Spec.GpuCulling)
+            return;
+
+        ShaderSpec Shaders;
+        Shaders.Name = "frustum_cull";
+        Shaders.Paths = {_Spec.ShaderDirectory + "FrustumCull.comp"};
+        Shaders.UsingTypes = {SHDAER_TYPE_COMPUTE};
+        Shaders.CacheDirectory = _Spec.ShaderCacheDirectory;
+
+        VulkanCullPassSpec Spec{};
+        Spec.device = _Data->Device.GetHandle();
+        Spec.Shader = std::static_pointer_cast<VulkanShader>(Shader::Create(Shaders));
+        if (!Spec.Shader)
+            throw std::runtime_error("Cull shader failed to compile!");
+        Spec.Cache = &_Data->PipelineCache;
+        Spec.Buffer = _Data->FrameAllocator.GetHandle();
+        Spec.MaxDraws = _Spec.MaxBatchedDraws;
+        // Compacted commands lose their order, their slot only survives in firstInstance
+        auto &Info = _Data->Device.GetPhysicalDevice()->Info;
+        Spec.Compact = Info.features12.drawIndirectCount && Info.features.drawIndirectFirstInstance;
+
+        _Data->CullPass.Init(Spec);
+    }
+
+    void VulkanRenderApi::_CreatePipelineCache()
+    {
+        VulkanPipelineCacheSpec Spec{};
+        Spec.device = _Data->Device.GetHandle();
+        Spec.Properties = _Data->Device.GetPhysicalDevice()->Info.properties;
+        Spec.Path = _Spec.PipelineCachePath;
+
+        _Data->PipelineCache.Init(Spec);
     }
 
     void VulkanRenderApi::_CreateCommandPool()
@@ -814,27 +1725,74 @@ namespace VEngine
         PRINTLN("[VULKAN]: Graphics Command Buffers Created !!");
     }
 
+    void VulkanRenderApi::_CreateCommandRecorder()
+    {
+        VulkanCommandRecorderSpec Spec{};
+        Spec.device = _Data->Device.GetHandle();
+        Spec.QueueFamilyIndex = _Data->Device.GetPhysicalDevice()->Info.QueueIndicies.Queues[QueueFamilies::GRAPHICS].value();
+        Spec.FrameCount = _Spec.InFrameFlightCount;
+        Spec.ThreadCount = _Spec.RecordThreadCount;
+
+        _Data->Recorder.Init(Spec);
+    }
+
+    void VulkanRenderApi::_CreateGpuProfiler()
+    {
+        if (!_Spec.GpuProfiling)
+            return;
+
+        VulkanGpuProfilerSpec Spec{};
+        Spec.Instance = _Data->Instance;
+        Spec.device = _Data->Device.GetHandle();
+        Spec.PhysicalDevice = _Data->Device.GetPhysicalDevice()->PhysicalDevice;
+        Spec.QueueFamily = _Data->Device.GetPhysicalDevice()->Info.QueueIndicies.Queues[QueueFamilies::GRAPHICS].value();
+        Spec.FrameCount = _Spec.InFrameFlightCount;
+        Spec.MaxScopes = _Spec.GpuProfilerScopes;
+        Spec.CalibratedTimestamps = _Data->CalibratedTimestamps;
+        Spec.PipelineStatistics = _Data->Device.GetPhysicalDevice()->Info.features.pipelineStatisticsQuery;
+
+        _Data->GpuProfiler.Init(Spec);
+    }
+
+    void VulkanRenderApi::_CreateUploadManager()
+    {
+        VulkanUploadManagerSpec Spec{};
+        Spec.device = _Data->Device.GetHandle();
+        Spec.Allocator = _Data->Allocator;
+        Spec.Queue = _Data->Device.GetQueue(QueueFamilies::TRANSFER);
+        Spec.CommandPool = _Data->TransferCommandPool;
+        Spec.QueueFamily = _Data->Device.GetPhysicalDevice()->Info.QueueIndicies.Queues[QueueFamilies::TRANSFER].value();
+        Spec.GraphicsFamily = _Data->Device.GetPhysicalDevice()->Info.QueueIndicies.Queues[QueueFamilies::GRAPHICS].value();
+        Spec.StagingSizePerFrame = _Spec.StagingSizePerFrame;
+        Spec.FrameCount = _Spec.InFrameFlightCount;
+
+        _Data->UploadManager.Init(Spec);
+    }
+
     void VulkanRenderApi::_CreateSyncObjects()
     {
         _Data->ImageAvailableSemaphores.resize(_Spec.InFrameFlightCount);
         _Data->RenderFinishedSemaphores.resize(_Spec.InFrameFlightCount);
-        _Data->InFlightFences.resize(_Spec.InFrameFlightCount);
+        // 0 is reached from the start so the first frames don't wait
+        _Data->FrameSlotValues.assign(_Spec.InFrameFlightCount, 0);
 
         VkSemaphoreCreateInfo semaphoreInfo{};
         semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-        VkFenceCreateInfo fenceInfo{};
-        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; // Start signaled so first frame doesn't wait forever
         auto device = _Data->Device.GetHandle();
 
         for (size_t i = 0; i < _Spec.InFrameFlightCount; i++)
         {
             VULKAN_SUCCESS_ASSERT(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &_Data->ImageAvailableSemaphores[i]), "Image Available Sempahore Failed!");
             VULKAN_SUCCESS_ASSERT(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &_Data->RenderFinishedSemaphores[i]), "Render Finished Semaphore Failed!");
-            VULKAN_SUCCESS_ASSERT(vkCreateFence(device, &fenceInfo, nullptr, &_Data->InFlightFences[i]), "Fences Failed To create!");
         }
 
+        VkSemaphoreTypeCreateInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        timelineInfo.initialValue = 0;
+        semaphoreInfo.pNext = &timelineInfo;
+        VULKAN_SUCCESS_ASSERT(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &_Data->FrameTimeline), "Frame Timeline Failed!");
+
         std::cout << "Created synchronization objects for " << _Spec.InFrameFlightCount << " frames in flight\n";
     }
 
@@ -842,57 +1800,87 @@ namespace VEngine
     {
         VkDescriptorSetLayoutBinding uboLayoutBinding{};
         uboLayoutBinding.binding = 1;
-        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         uboLayoutBinding.descriptorCount = 1;
         uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
         uboLayoutBinding.pImmutableSamplers = nullptr; // Optional
 
+        // Per draw data of batched draws
+        VkDescriptorSetLayoutBinding drawDataBinding{};
+        drawDataBinding.binding = 2;
+        drawDataBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+        drawDataBinding.descriptorCount = 1;
+        drawDataBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+        VkDescriptorSetLayoutBinding bindings[] = {uboLayoutBinding, drawDataBinding};
+
         VkDescriptorSetLayoutCreateInfo layoutInfo{};
         layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layoutInfo.bindingCount = 1;
-        layoutInfo.pBindings = &uboLayoutBinding;
+        layoutInfo.bindingCount = 2;
+        layoutInfo.pBindings = bindings;
 
         if (vkCreateDescriptorSetLayout(_Data->Device.GetHandle(), &layoutInfo, nullptr, &_Data->DescriptorSetLayout) != VK_SUCCESS)
             throw std::runtime_error("failed to create descriptor set layout!");
     }
 
-    void VulkanRenderApi::_CreateUniformBuffers()
+    void VulkanRenderApi::_CreateFrameAllocator()
     {
-        _Data->UniformBuffers.resize(_Spec.InFrameFlightCount);
-        for (int i = 0; i < _Spec.InFrameFlightCount; i++)
-        {
-            UniformBufferDesc desc{};
-            desc.Size = sizeof(UniformBufferObject);
-            _Data->UniformBuffers[i] = std::make_unique<VulkanUniformBuffer>(_Data->Allocator, desc);
-        }
+        auto &limits = _Data->Device.GetPhysicalDevice()->Info.properties.limits;
+
+        VulkanLinearAllocatorSpec Spec{};
+        Spec.Allocator = _Data->Allocator;
+        // Frame uniforms are the first thing every frame, they always have to fit
+        Spec.SizePerFrame = std::max<VkDeviceSize>(_Spec.FrameAllocatorSize, sizeof(FrameUniformData));
+        Spec.FrameCount = _Spec.InFrameFlightCount;
+        Spec.Alignment = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+        Spec.MaxBindingRange = sizeof(DrawInstanceData) * _Spec.MaxBatchedDraws;
+
+        _Data->FrameAllocator.Init(Spec);
     }
 
-    void VulkanRenderApi::_UploadUniformBuffer()
+    void VulkanRenderApi::_GrowFrameAllocator()
     {
-        static auto startTime = std::chrono::high_resolution_clock::now();
-
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
-        UniformBufferObject ubo{};
-        ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ubo.proj = glm::perspective(glm::radians(45.0f), _Data->FrameBufferSize.x / (float)_Data->FrameBufferSize.y, 0.1f, 10.0f);
-        ubo.proj[1][1] *= -1;
+        VkDeviceSize Wanted = _Data->FrameAllocator.GetOverflow();
+        VkDeviceSize Size = std::max(_Data->FrameAllocator.GetSizePerFrame() * 2, Wanted);
+        PRINTLN("[VULKAN]: Frame Allocator overflowed, a frame wanted " << Wanted / 1024 << " KB of " << _Data->FrameAllocator.GetSizePerFrame() / 1024
+                                                                         << " KB, growing to " << Size / 1024 << " KB per frame");
+
+        // Every frame in flight still reads the old buffer
+        _WaitFrameValue(_Data->FrameTimelineValue);
+        _Data->FrameAllocator.Grow(Size);
+        _WriteDescriptorSets();
+        if (_Spec.GpuCulling)
+            _Data->CullPass.SetBuffer(_Data->FrameAllocator.GetHandle());
+    }
 
-        _Data->UniformBuffers[_Data->CurrentFrame]->UploadData(&ubo, sizeof(ubo));
+    void VulkanRenderApi::_UploadFrameUniforms(const RenderPassSpec &Spec)
+    {
+        FrameUniformData Frame{};
+        Frame.View = Spec.View;
+        Frame.Proj = Spec.Projection;
+        // Vulkan clip space has y pointing down
+        Frame.Proj[1][1] *= -1;
+        Frame.ViewProj = Frame.Proj * Frame.View;
+        _Data->ViewProj = Frame.ViewProj;
+        _Data->View = Spec.View;
+        _Data->ProjScale = std::abs(Spec.Projection[1][1]);
+
+        _Data->FrameUniformOffset = _Data->FrameAllocator.Push(&Frame, sizeof(Frame)).Offset;
     }
 
     void VulkanRenderApi::_CreateDescriptorPool()
     {
-        VkDescriptorPoolSize poolSize{};
-        poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSize.descriptorCount = static_cast<uint32_t>(_Spec.InFrameFlightCount);
+        VkDescriptorPoolSize poolSizes[2]{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        poolSizes[0].descriptorCount = 1;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+        poolSizes[1].descriptorCount = 1;
 
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        poolInfo.poolSizeCount = 1;
-        poolInfo.pPoolSizes = &poolSize;
-        poolInfo.maxSets = static_cast<uint32_t>(_Spec.InFrameFlightCount);
+        poolInfo.poolSizeCount = 2;
+        poolInfo.pPoolSizes = poolSizes;
+        poolInfo.maxSets = 1;
 
         if (vkCreateDescriptorPool(_Data->Device.GetHandle(), &poolInfo, nullptr, &_Data->DescriptorPool) != VK_SUCCESS)
             throw std::runtime_error("failed to create descriptor pool!");
@@ -900,162 +1888,212 @@ namespace VEngine
 
     void VulkanRenderApi::_CreateDescriptorSets()
     {
-        std::vector<VkDescriptorSetLayout> layouts(_Spec.InFrameFlightCount, _Data->DescriptorSetLayout);
+        // One set for all frames, frames live in different regions of the same buffer
         VkDescriptorSetAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
         allocInfo.descriptorPool = _Data->DescriptorPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(_Spec.InFrameFlightCount);
-        allocInfo.pSetLayouts = layouts.data();
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &_Data->DescriptorSetLayout;
 
-        _Data->DescriptorSets.resize(_Spec.InFrameFlightCount);
-        if (vkAllocateDescriptorSets(_Data->Device.GetHandle(), &allocInfo, _Data->DescriptorSets.data()) != VK_SUCCESS)
+        if (vkAllocateDescriptorSets(_Data->Device.GetHandle(), &allocInfo, &_Data->DescriptorSet) != VK_SUCCESS)
             throw std::runtime_error("failed to allocate descriptor sets!");
-
-        for (size_t i = 0; i < _Spec.InFrameFlightCount; i++)
-        {
-            VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.buffer = _Data->UniformBuffers[i]->GetHandle();
-            bufferInfo.offset = 0;
-            bufferInfo.range = sizeof(UniformBufferObject);
-
-            VkWriteDescriptorSet descriptorWrite{};
-            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrite.dstSet = _Data->DescriptorSets[i];
-            descriptorWrite.dstBinding = 1;
-            descriptorWrite.dstArrayElement = 0;
-            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptorWrite.descriptorCount = 1;
-            descriptorWrite.pBufferInfo = &bufferInfo;
-            descriptorWrite.pImageInfo = nullptr;       // Optional
-            descriptorWrite.pTexelBufferView = nullptr; // Optional
-
-            vkUpdateDescriptorSets(_Data->Device.GetHandle(), 1, &descriptorWrite, 0, nullptr);
-        }
+        _WriteDescriptorSets();
     }
 
-    struct VulkanImageSpec
+    void VulkanRenderApi::_WriteDescriptorSets()
     {
-        struct
-        {
-            int x, y;
-        } Dims;
-        VkImageType ImageType;
-        VkFormat Format;
-        VkImageLayout Layout;
-        VkImageUsageFlags Usage;
-        VkSharingMode SharingMode;
-        VkSampleCountFlagBits Samples;
-        VkImageTiling Tiling;
-    };
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.buffer = _Data->FrameAllocator.GetHandle();
+        bufferInfo.offset = 0;
+        bufferInfo.range = sizeof(FrameUniformData);
+
+        // Draw count changes every frame, the shader sizes the array from the range
+        VkDescriptorBufferInfo drawDataInfo{};
+        drawDataInfo.buffer = _Data->FrameAllocator.GetHandle();
+        drawDataInfo.offset = 0;
+        drawDataInfo.range = sizeof(DrawInstanceData) * _Spec.MaxBatchedDraws;
+
+        VkWriteDescriptorSet descriptorWrites[2]{};
+        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet = _Data->DescriptorSet;
+        descriptorWrites[0].dstBinding = 1;
+        descriptorWrites[0].dstArrayElement = 0;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pBufferInfo = &bufferInfo;
+        descriptorWrites[0].pImageInfo = nullptr;       // Optional
+        descriptorWrites[0].pTexelBufferView = nullptr; // Optional
+
+        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet = _Data->DescriptorSet;
+        descriptorWrites[1].dstBinding = 2;
+        descriptorWrites[1].dstArrayElement = 0;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pBufferInfo = &drawDataInfo;
+
+        vkUpdateDescriptorSets(_Data->Device.GetHandle(), 2, descriptorWrites, 0, nullptr);
+    }
 
-    void CreateVulkanImage(VmaAllocator Allocator, VkImage &image, VmaAllocation &Allocation, const VulkanImageSpec &Spec)
+    bool VulkanRenderApi::_IsFormatSupported(VkFormat Format, VkFormatFeatureFlags Features)
     {
-        VkImageCreateInfo imageInfo{};
-        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-        imageInfo.extent.width = Spec.Dims.x;
-        imageInfo.extent.height = Spec.Dims.y;
-        imageInfo.extent.depth = 1;
-        imageInfo.imageType = Spec.ImageType;
-        imageInfo.extent.depth = 1;
-        imageInfo.mipLevels = 1;
-        imageInfo.arrayLayers = 1;
-        imageInfo.format = Spec.Format;
-        imageInfo.tiling = Spec.Tiling;
-        imageInfo.initialLayout = Spec.Layout;
-        imageInfo.usage = Spec.Usage;
-        imageInfo.sharingMode = Spec.SharingMode;
-        imageInfo.samples = Spec.Samples;
-
-        VmaAllocationCreateInfo imageAllocInfo{};
-        imageAllocInfo.usage = VMA_MEMORY_USAGE_AUTO;
-        imageAllocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-
-        vmaCreateImage(Allocator, &imageInfo, &imageAllocInfo, &image, &Allocation, nullptr);
+        auto props = VulkanUtils::GetPhysicalDeviceFormatProperties(_Data->PhysicalDevices[_Data->ActivePhysicalDeviceIndex], Format);
+        return (props.optimalTilingFeatures & Features) == Features;
     }
 
     void VulkanRenderApi::_CreateTextures()
     {
-        const char *TexFilePath = "images.png";
+        // Prebuilt and block compressed first, whatever the device can't sample is skipped
+        VulkanTextureFile File;
+        bool Loaded = false;
+        for (auto &Path : _Spec.TexturePaths)
+        {
+            if (!LoadTextureFile(Path, File))
+                continue;
+            if (!_IsFormatSupported(File.Format, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
+            {
+                PRINTLN("[VULKAN]: Device can't sample " << Path << ", skipping it");
+                continue;
+            }
+            PRINTLN("[VULKAN]: Texture " << Path << " loaded with " << File.MipLevels << " mips" << (File.GenerateMips ? ", generating the rest" : ""));
+            Loaded = true;
+            break;
+        }
 
-        // Load image data using stb_image
-        int texWidth, texHeight, texChannels;
-        stbi_uc *pixels = stbi_load(TexFilePath, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+        // Plain images and files without a mip chain, only the base level comes from the cpu and the rest is
+        // blitted on the gpu. Block compressed formats can't be blitted, they stay at their one level
+        auto CanBlit = [&](VkFormat Format)
+        {
+            return _IsFormatSupported(Format, VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+        };
+        bool GenerateMips = Loaded && File.GenerateMips && CanBlit(File.Format);
+        if (!Loaded)
+        {
+            const char *TexFilePath = "images.png";
 
-        if (!pixels)
-            throw std::runtime_error("failed to load texture image!");
+            // Load image data using stb_image
+            int texWidth, texHeight, texChannels;
+            stbi_uc *pixels = stbi_load(TexFilePath, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 
-        _Data->Texture.height = texHeight;
-        _Data->Texture.width = texWidth;
-        _Data->Texture.format = VK_FORMAT_R8G8B8A8_SRGB;
+            if (!pixels)
+                throw std::runtime_error("failed to load texture image!");
 
-        VkDeviceSize imageSize = texWidth * texHeight * 4;
+            File.Format = VK_FORMAT_R8G8B8A8_SRGB;
+            File.Width = texWidth;
+            File.Height = texHeight;
+            File.Data.assign((char *)pixels, (char *)pixels + (size_t)texWidth * texHeight * 4);
+            File.MipOffsets = {0};
+            File.MipLevels = 1;
+            stbi_image_free(pixels);
 
-        VulkanStageBufferSpec StagingBufferSpec;
-        StagingBufferSpec.Data = (void *)pixels;
-        StagingBufferSpec.Size = imageSize;
-        VulkanStageBuffer StagingBuffer(_Data->Allocator, StagingBufferSpec);
+            GenerateMips = CanBlit(File.Format);
+        }
 
-        stbi_image_free(pixels);
+        _Data->Texture.height = File.Height;
+        _Data->Texture.width = File.Width;
+        _Data->Texture.format = File.Format;
+        _Data->Texture.MipLevels = GenerateMips ? GetFullMipCount(File.Width, File.Height) : File.MipLevels;
 
         VulkanImageSpec ImageSpec{};
-        ImageSpec.Dims.x = texWidth;
-        ImageSpec.Dims.y = texHeight;
-        ImageSpec.Format = VK_FORMAT_R8G8B8A8_SRGB;
+        ImageSpec.Dims.x = File.Width;
+        ImageSpec.Dims.y = File.Height;
+        ImageSpec.Format = File.Format;
         ImageSpec.ImageType = VK_IMAGE_TYPE_2D;
         ImageSpec.Layout = VK_IMAGE_LAYOUT_UNDEFINED;
         ImageSpec.Samples = VK_SAMPLE_COUNT_1_BIT;
         ImageSpec.Usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-        ImageSpec.SharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (GenerateMips)
+            ImageSpec.Usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        // Written on the transfer queue, read on the graphics one
+        ImageSpec.SharingMode = _Data->UploadManager.GetSharingMode();
+        ImageSpec.QueueFamilies = _Data->UploadManager.GetQueueFamilies();
         ImageSpec.Tiling = VK_IMAGE_TILING_OPTIMAL;
+        ImageSpec.MipLevels = _Data->Texture.MipLevels;
+
         CreateVulkanImage(_Data->Allocator, _Data->Texture.image, _Data->Texture.allocation, ImageSpec);
 
-        SingleTimeCommandBuffer SingleCommandSpec{};
-        SingleCommandSpec.Family = QueueFamilies::TRANSFER;
-
-        // Make image able to recieve data from gpu
-        _ResourceFactory->BeginSingleTimeCommand(SingleCommandSpec);
-        _TransitionImageLayout(SingleCommandSpec.Cmd, _Data->Texture.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-        _ResourceFactory->EndSingleTimeCommand(SingleCommandSpec);
-
-        // Copy buffer to image
-        _ResourceFactory->BeginSingleTimeCommand(SingleCommandSpec);
-
-        // Define region to copy
-        VkBufferImageCopy region{};
-        region.bufferOffset = 0;
-        region.bufferRowLength = 0;   // Tightly packed
-        region.bufferImageHeight = 0; // Tightly packed
-
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-
-        region.imageOffset = {0, 0, 0};
-        region.imageExtent = {_Data->Texture.width, _Data->Texture.height, 1};
-
-        // Issue copy command
-        vkCmdCopyBufferToImage(
-            SingleCommandSpec.Cmd,
-            StagingBuffer.GetHandle(),
-            _Data->Texture.image,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            1,
-            &region);
-        _ResourceFactory->EndSingleTimeCommand(SingleCommandSpec);
-
-        // Make image able to be read by shader
-        _ResourceFactory->BeginSingleTimeCommand(SingleCommandSpec);
-        _TransitionImageLayout(SingleCommandSpec.Cmd, _Data->Texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-        _ResourceFactory->EndSingleTimeCommand(SingleCommandSpec);
-
-        _Data->Texture.imageView = _CreateTextureImageView(_Data->Texture.image, _Data->Texture.format, VK_IMAGE_ASPECT_COLOR_BIT);
+        // Every mip the file has goes in one staging region and one copy command
+        _Data->Texture.Upload = _Data->UploadManager.UploadImage(_Data->Texture.image, File.Format, File.Data.data(), File.Data.size(),
+                                                                 File.GetCopyRegions(), _Data->Texture.MipLevels);
+        // Blits need the graphics queue, they go at the start of the first frame after the upload
+        if (GenerateMips && _Data->Texture.MipLevels > 1)
+            _Data->PendingMipTextures.push_back(&_Data->Texture);
+
+        _Data->Texture.imageView = _CreateTextureImageView(_Data->Texture.image, _Data->Texture.format, VK_IMAGE_ASPECT_COLOR_BIT, _Data->Texture.MipLevels);
         _Data->Texture.sampler = _CreateTextureSampler();
+        _Data->Texture.BindlessIndex = _Data->BindlessTable.Register(_Data->Texture.imageView, _Data->Texture.sampler);
+    }
+
+    void VulkanRenderApi::_GenerateMips(VkCommandBuffer commandBuffer)
+    {
+        for (auto Texture : _Data->PendingMipTextures)
+        {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = Texture->image;
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
+            barrier.subresourceRange.levelCount = 1;
+
+            int32_t Width = Texture->width, Height = Texture->height;
+            for (uint32_t i = 1; i < Texture->MipLevels; i++)
+            {
+                // Upload left every level shader readable, the one above becomes the source and this one is overwritten
+                VkImageMemoryBarrier barriers[2] = {barrier, barrier};
+                barriers[0].subresourceRange.baseMipLevel = i - 1;
+                barriers[0].oldLayout = i == 1 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+                barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+                barriers[1].subresourceRange.baseMipLevel = i;
+                barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barriers[1].srcAccessMask = 0;
+                barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                     0, 0, nullptr, 0, nullptr, 2, barriers);
+
+                VkImageBlit blit{};
+                blit.srcOffsets[1] = {Width, Height, 1};
+                blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                blit.srcSubresource.mipLevel = i - 1;
+                blit.srcSubresource.baseArrayLayer = 0;
+                blit.srcSubresource.layerCount = 1;
+                Width = std::max(Width / 2, 1);
+                Height = std::max(Height / 2, 1);
+                blit.dstOffsets[1] = {Width, Height, 1};
+                blit.dstSubresource = blit.srcSubresource;
+                blit.dstSubresource.mipLevel = i;
+
+                vkCmdBlitImage(commandBuffer, Texture->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               Texture->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+            }
 
-        StagingBuffer.Destroy(_Data->Allocator);
+            // Every level but the last was a blit source
+            VkImageMemoryBarrier barriers[2] = {barrier, barrier};
+            barriers[0].subresourceRange.baseMipLevel = 0;
+            barriers[0].subresourceRange.levelCount = Texture->MipLevels - 1;
+            barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barriers[0].srcAccessMask = 0;
+            barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            barriers[1].subresourceRange.baseMipLevel = Texture->MipLevels - 1;
+            barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 2, barriers);
+        }
+        _Data->PendingMipTextures.clear();
     }
 
-    VkImageView VulkanRenderApi::_CreateTextureImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+    VkImageView VulkanRenderApi::_CreateTextureImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t MipLevels)
     {
         VkImageView ImageView;
 
@@ -1066,7 +2104,7 @@ namespace VEngine
         info.viewType = VK_IMAGE_VIEW_TYPE_2D;
         info.subresourceRange.aspectMask = aspectFlags;
         info.subresourceRange.baseMipLevel = 0;
-        info.subresourceRange.levelCount = 1;
+        info.subresourceRange.levelCount = MipLevels;
         info.subresourceRange.baseArrayLayer = 0;
         info.subresourceRange.layerCount = 1;
 
@@ -1095,7 +2133,8 @@ namespace VEngine
         samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         samplerInfo.mipLodBias = 0.0f;
         samplerInfo.minLod = 0.0f;
-        samplerInfo.maxLod = 0.0f;
+        // Every mip the view has
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
         VkSampler sampler;
         if (vkCreateSampler(_Data->Device.GetHandle(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
@@ -1104,108 +2143,130 @@ namespace VEngine
         return sampler;
     }
 
-    void VulkanRenderApi::_CreateTextureDescriptorResources()
+    void VulkanRenderApi::_CreateTextureStreamer()
     {
-        // Create descriptor set layout for texture
-        VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-        samplerLayoutBinding.binding = 0;
-        samplerLayoutBinding.descriptorCount = 1;
-        samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        samplerLayoutBinding.pImmutableSamplers = nullptr;
-        samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-        VkDescriptorSetLayoutCreateInfo layoutInfo{};
-        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layoutInfo.bindingCount = 1;
-        layoutInfo.pBindings = &samplerLayoutBinding;
+        VulkanTextureStreamerSpec Spec{};
+        Spec.device = _Data->Device.GetHandle();
+        Spec.PhysicalDevice = &_Data->PhysicalDevices[_Data->ActivePhysicalDeviceIndex];
+        Spec.Allocator = _Data->Allocator;
+        Spec.Uploads = &_Data->UploadManager;
+        Spec.Bindless = &_Data->BindlessTable;
+        Spec.DeletionQueue = &_Data->DeletionQueue;
+        // Same sampling as the default texture, it has every mip too
+        Spec.Sampler = _Data->Texture.sampler;
+        Spec.FallbackIndex = _Data->Texture.BindlessIndex;
+        Spec.Budget = _Spec.TextureStreamingBudget;
+        Spec.ThreadCount = _Spec.TextureStreamingThreads;
+
+        _Data->TextureStreamer.Init(Spec);
+    }
 
-        if (vkCreateDescriptorSetLayout(_Data->Device.GetHandle(), &layoutInfo, nullptr, &_Data->TextureDescriptor.layout) != VK_SUCCESS)
-            throw std::runtime_error("failed to create texture descriptor set layout!");
-        // Create descriptor pool
-        VkDescriptorPoolSize poolSize{};
-        poolSize.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        poolSize.descriptorCount = static_cast<uint32_t>(_Spec.InFrameFlightCount);
+    void VulkanRenderApi::_CreateMemoryMonitor()
+    {
+        VulkanMemoryMonitorSpec Spec{};
+        Spec.Allocator = _Data->Allocator;
+        Spec.PollInterval = _Spec.MemoryPollInterval;
+        Spec.SoftBudget = _Spec.SoftMemoryBudget;
+        Spec.HardBudget = _Spec.HardMemoryBudget;
+
+        // Close to running out, packing what is there may free whole blocks
+        _Data->MemoryMonitor.SetCallback([this](const MemoryBudgetInfo &Info)
+                                         {
+                                             if (Info.Pressure == MemoryPressure::HARD)
+                                                 _Data->Defragmenter.Request();
+                                             if (_Data->BudgetCallback)
+                                                 _Data->BudgetCallback(Info); });
+        _Data->MemoryMonitor.Init(Spec);
+    }
 
-        VkDescriptorPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        poolInfo.poolSizeCount = 1;
-        poolInfo.pPoolSizes = &poolSize;
-        poolInfo.maxSets = static_cast<uint32_t>(_Spec.InFrameFlightCount);
+    void VulkanRenderApi::_CreateDefragmenter()
+    {
+        VulkanDefragmenterSpec Spec{};
+        Spec.device = _Data->Device.GetHandle();
+        Spec.Allocator = _Data->Allocator;
+        Spec.Uploads = &_Data->UploadManager;
+        Spec.MaxBytesPerPass = _Spec.DefragmentationBytesPerFrame;
 
-        if (vkCreateDescriptorPool(_Data->Device.GetHandle(), &poolInfo, nullptr, &_Data->TextureDescriptor.pool) != VK_SUCCESS)
-            throw std::runtime_error("failed to create texture descriptor pool!");
+        _Data->Defragmenter.Init(Spec);
+    }
 
-        // Allocate descriptor sets
-        std::vector<VkDescriptorSetLayout> layouts(_Spec.InFrameFlightCount, _Data->TextureDescriptor.layout);
-        VkDescriptorSetAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocInfo.descriptorPool = _Data->TextureDescriptor.pool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(_Spec.InFrameFlightCount);
-        allocInfo.pSetLayouts = layouts.data();
+    void VulkanRenderApi::_CreateGeometryPool()
+    {
+        VulkanGeometryPoolSpec Spec{};
+        Spec.Allocator = _Data->Allocator;
+        Spec.Uploads = &_Data->UploadManager;
+        Spec.DeletionQueue = &_Data->DeletionQueue;
+        Spec.BlockSize = _Spec.GeometryPoolBlockSize;
+        Spec.MaxMeshSize = _Spec.GeometryPoolMaxMeshSize;
+
+        _Data->GeometryPool.Init(Spec);
+    }
 
-        _Data->TextureDescriptor.sets.resize(_Spec.InFrameFlightCount);
-        if (vkAllocateDescriptorSets(_Data->Device.GetHandle(), &allocInfo, _Data->TextureDescriptor.sets.data()) != VK_SUCCESS)
-            throw std::runtime_error("failed to allocate texture descriptor sets!");
+    void VulkanRenderApi::_CreateBindlessTable()
+    {
+        VulkanBindlessTableSpec Spec{};
+        Spec.device = _Data->Device.GetHandle();
+        Spec.PhysicalDevice = _Data->Device.GetPhysicalDevice()->PhysicalDevice;
+        Spec.MaxTextures = _Spec.BindlessTextureCount;
 
-        for (int i = 0; i < _Spec.InFrameFlightCount; i++)
-        {
-            VkDescriptorImageInfo imageInfo{};
-            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView = _Data->Texture.imageView;
-            imageInfo.sampler = _Data->Texture.sampler;
-
-            VkWriteDescriptorSet descriptorWrite{};
-            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrite.dstSet = _Data->TextureDescriptor.sets[i];
-            descriptorWrite.dstBinding = 0;
-            descriptorWrite.dstArrayElement = 0;
-            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrite.descriptorCount = 1;
-            descriptorWrite.pImageInfo = &imageInfo;
-
-            vkUpdateDescriptorSets(_Data->Device.GetHandle(), 1, &descriptorWrite, 0, nullptr);
-        }
+        _Data->BindlessTable.Init(Spec);
     }
 
-    void VulkanRenderApi::_CreateDepthData()
+    void VulkanRenderApi::_CreateTargetPool()
     {
-        _Data->DepthData.format = FindDepthFormat();
+        // Depth is cleared and never stored, it is the render graph's like any other transient
+        _Data->DepthFormat = FindDepthFormat();
+
+        VulkanTargetPoolSpec Spec{};
+        Spec.device = _Data->Device.GetHandle();
+        Spec.Allocator = _Data->Allocator;
+        Spec.DeletionQueue = &_Data->DeletionQueue;
+        Spec.KeepFrames = _Spec.TargetPoolKeepFrames;
+        Spec.LazyMemory = _Spec.LazyTargetMemory;
+        _Data->TargetPool.Init(Spec);
+
+        VulkanRenderGraphSpec GraphSpec{};
+        GraphSpec.Targets = &_Data->TargetPool;
+        _Data->RenderGraph.Init(GraphSpec);
+    }
 
-        VulkanImageSpec ImageSpec{};
-        ImageSpec.Dims.x = _Data->FrameBufferSize.x;
-        ImageSpec.Dims.y = _Data->FrameBufferSize.y;
-        ImageSpec.Format = _Data->DepthData.format;
-        ImageSpec.ImageType = VK_IMAGE_TYPE_2D;
-        ImageSpec.Layout = VK_IMAGE_LAYOUT_UNDEFINED;
-        ImageSpec.Samples = VK_SAMPLE_COUNT_1_BIT;
-        ImageSpec.Usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-        ImageSpec.SharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        ImageSpec.Tiling = VK_IMAGE_TILING_OPTIMAL;
+    void VulkanRenderApi::_CreateDynamicResolution()
+    {
+        _Data->RenderExtent = _Data->Extent;
+        if (!_Spec.DynamicResolution)
+            return;
 
-        CreateVulkanImage(_Data->Allocator, _Data->DepthData.image, _Data->DepthData.allocation, ImageSpec);
+        // Frame times are the profiler's, without it the scale would never move
+        if (!_Data->GpuProfiler.IsEnabled())
+        {
+            PRINTLN("[VULKAN]: Dynamic resolution needs gpu profiling for its frame times, it is off");
+            return;
+        }
 
-        // Create image view
-        VkImageViewCreateInfo viewInfo{};
-        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        viewInfo.image = _Data->DepthData.image;
-        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        viewInfo.format = _Data->DepthData.format;
-        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        viewInfo.subresourceRange.baseMipLevel = 0;
-        viewInfo.subresourceRange.levelCount = 1;
-        viewInfo.subresourceRange.baseArrayLayer = 0;
-        viewInfo.subresourceRange.layerCount = 1;
+        // Upscaling is a linear blit into the swapchain image
+        if (!_IsFormatSupported(_Data->Format, VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                                   VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
+        {
+            PRINTLN("[VULKAN]: Swapchain format can't be blitted, dynamic resolution is off");
+            return;
+        }
 
-        vkCreateImageView(_Data->Device.GetHandle(), &viewInfo, nullptr, &_Data->DepthData.imageview);
+        VulkanDynamicResolutionSpec Spec{};
+        Spec.TargetFrameMs = _Spec.TargetFrameMs;
+        Spec.MinScale = _Spec.MinRenderScale;
+        Spec.MaxScale = _Spec.MaxRenderScale;
+        _Data->Resolution.Init(Spec);
+        _Data->DynamicResolution = true;
+    }
 
-        // Transition to correct layout
-        SingleTimeCommandBuffer CommandSpec{};
-        CommandSpec.Family = QueueFamilies::GRAPHICS;
-        _ResourceFactory->BeginSingleTimeCommand(CommandSpec);
-        _TransitionAttachmentImageLayout(CommandSpec.Cmd, _Data->DepthData.image, _Data->DepthData.format,
-                                         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                                         VK_IMAGE_LAYOUT_UNDEFINED);
-        _ResourceFactory->EndSingleTimeCommand(CommandSpec);
+    void VulkanRenderApi::_CreateFramePacer()
+    {
+        VulkanFramePacerSpec Spec{};
+        Spec.device = _Data->Device.GetHandle();
+        Spec.PresentWait = _Data->PresentWait;
+        Spec.MaxQueuedPresents = std::max(_Spec.MaxQueuedPresents, 1u);
+        Spec.MaxFrameRate = _Spec.MaxFrameRate;
+        _Data->FramePacer.Init(Spec);
     }
 
     VkFormat VulkanRenderApi::FindDepthFormat()
@@ -1281,59 +2342,6 @@ namespace VEngine
         vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
     }
 
-    void VulkanRenderApi::_TransitionAttachmentImageLayout(VkCommandBuffer commandBuffer, VkImage Image, VkFormat Format, VkImageLayout NewLayout, VkImageLayout OldLayout)
-    {
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = OldLayout;
-        barrier.newLayout = NewLayout;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = Image;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-
-        if (NewLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-        {
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-            if (HasStencilComponent(Format))
-            {
-                barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-            }
-        }
-        else
-        {
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        }
-
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-
-        VkPipelineStageFlags sourceStage, destinationStage;
-
-        if (OldLayout == VK_IMAGE_LAYOUT_UNDEFINED && NewLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-        {
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        }
-        else if (OldLayout == VK_IMAGE_LAYOUT_UNDEFINED && NewLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-        {
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-            sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        }
-        else
-        {
-            throw std::invalid_argument("unsupported layout transition!");
-        }
-
-        vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-    }
-
 #pragma endregion
 #pragma region VulkanUtils
     void VulkanUtils::GetInstanceExtensions(std::vector<VkExtensionProperties> &Props)
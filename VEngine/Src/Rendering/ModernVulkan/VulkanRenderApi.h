@@ -17,13 +17,70 @@ namespace VEngine
         std::vector<const char *> DeviceExtensions;
         std::vector<const char *> InstanceExtensions;
         std::vector<const char *> InstanceLayers;
-        void *Win32Surface;
+        void *Win32Surface = nullptr;
+        // No window or surface, frames are rendered into offscreen images of FrameBufferSize
+        bool Headless = false;
 
         struct
         {
             int x, y;
         } FrameBufferSize;
         int InFrameFlightCount = 0;
+        // Staging ring holds this much upload data for every frame in flight
+        uint64_t StagingSizePerFrame = 32 * 1024 * 1024;
+        std::string PipelineCachePath = "PipelineCache.bin";
+        // GLSL sources are compiled at startup, SPIR-V is cached by content hash
+        std::string ShaderDirectory = "Shaders/";
+        std::string ShaderCacheDirectory = "ShaderCache";
+        uint32_t BindlessTextureCount = 16 * 1024;
+        // Tried in order, the first the device can sample wins. images.png with gpu made mips is the fallback
+        std::vector<std::string> TexturePaths = {"images.ktx2", "images.dds"};
+        // Bytes streamed texture mips may use, 0 follows vma's budget for the device local heaps
+        uint64_t TextureStreamingBudget = 0;
+        uint32_t TextureStreamingThreads = 2;
+        // Frames between gpu memory budget reads, and the shares of it the budget callback fires at
+        uint32_t MemoryPollInterval = 30;
+        float SoftMemoryBudget = 0.8f;
+        float HardMemoryBudget = 0.95f;
+        // Moves static buffers together when device local blocks get fragmented, at most this much per frame
+        bool Defragmentation = true;
+        uint64_t DefragmentationBytesPerFrame = 8 * 1024 * 1024;
+        // Static meshes up to GeometryPoolMaxMeshSize share big buffers of GeometryPoolBlockSize, 0 gives every mesh its own
+        uint64_t GeometryPoolBlockSize = 64 * 1024 * 1024;
+        uint64_t GeometryPoolMaxMeshSize = 16 * 1024 * 1024;
+        // Frames the render graph's unused targets and spare heap space are kept, so resizing back and forth reuses them
+        uint32_t TargetPoolKeepFrames = 120;
+        // Attachment only targets in lazily allocated memory where the device has it, tilers keep them on chip
+        bool LazyTargetMemory = true;
+        // Draws the scene smaller when the gpu frame time goes over TargetFrameMs and scales it up to the swapchain.
+        // The frame time comes from the gpu profiler, without GpuProfiling this stays off
+        bool DynamicResolution = false;
+        float TargetFrameMs = 16.0f;
+        float MinRenderScale = 0.5f;
+        float MaxRenderScale = 1.0f;
+        // Falls back to the closest mode the surface has, fifo is always there
+        PresentMode PreferredPresentMode = PresentMode::MAILBOX;
+        // Frames per second the cpu starts at most, 0 is unlimited
+        float MaxFrameRate = 0.0f;
+        // Under fifo the cpu waits for earlier presents to reach the display, where the device has
+        // VK_KHR_present_wait, so at most MaxQueuedPresents are ahead of it
+        bool PresentWait = true;
+        uint32_t MaxQueuedPresents = 1;
+        // Per draw uniform/storage data written each frame
+        uint64_t FrameAllocatorSize = 4 * 1024 * 1024;
+        // Draws one indirect chunk holds, more in a frame are split over several
+        uint32_t MaxBatchedDraws = 16 * 1024;
+        // Frustum cull batched draws in a compute pass before drawing them
+        bool GpuCulling = true;
+        // Threads recording Submit draws, 0 is one per core
+        uint32_t RecordThreadCount = 0;
+        // Draws are only split over threads in slices at least this big
+        uint32_t MinDrawsPerRecordJob = 256;
+        // Timestamp scopes around the frame's passes, read through GetGpuTimings
+        bool GpuProfiling = true;
+        uint32_t GpuProfilerScopes = 64;
+        // Histogram size of the overdraw mode
+        uint32_t OverdrawBins = 16;
 
         VulkanRenderSpec() {}
     };
@@ -40,13 +97,26 @@ namespace VEngine
         void Render() override;
         void FrameBufferResize(int x, int y) override;
 
-        void Submit(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer> &IB) override;
+        void Submit(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer> &IB, const DrawParams &Params) override;
+        void SubmitBatched(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer> &IB, const DrawParams &Params) override;
         void Present() override;
         void Begin(const RenderPassSpec &Spec) override;
         void End() override;
         void Finish() override;
 
         Ref<ResourceFactory> GetResourceFactory() override;
+        RendererStats GetStats() override;
+        std::vector<GpuScopeTiming> GetGpuTimings() override;
+        void SetPipelineStatistics(bool Enabled) override;
+        void SetOverdrawMode(bool Enabled) override;
+        std::vector<uint32_t> GetOverdrawHistogram() override;
+        uint64_t GetSubmittedFrame() override;
+        uint64_t GetCompletedFrame() override;
+        void WaitForFrame(uint64_t Frame) override;
+        void SetMemoryBudgetCallback(const MemoryBudgetCallback &Callback) override;
+        void SetPresentMode(PresentMode Mode) override;
+        void SetFrameRateLimit(float MaxFrameRate) override;
+        void WaitForNextFrame() override;
 
     private:
         void _CreateInstance();
@@ -59,31 +129,64 @@ namespace VEngine
 
         void _CreateLogicalDevice();
 
-        void _CreateSwapChain();
-        void _RecreateSwapChain();
+        void _CreateSwapChain(VkSwapchainKHR OldSwapChain = VK_NULL_HANDLE);
+        // False while the window has no area, the frame is skipped then
+        bool _RecreateSwapChain();
+        VkResult _AcquireImage();
         void _DestroySwapChain();
+        // Hands retired swapchains whose last present is done to the deletion queue, destroys all of them when Idle
+        void _CollectRetiredSwapChains(bool Idle);
+        // Headless stand ins for the swapchain images
+        void _CreateOffscreenTargets();
 
+        void _CreatePipelineCache();
         void _CreateGraphiscPipeline();
+        void _CreateDrawBatcher();
+        void _CreateCullPass();
+        // False when the device or shaders can't do it
+        bool _CreateOverdrawPass();
+        void _BindPipeline(VkCommandBuffer commandBuffer, const VulkanGraphicsPipeline &Pipeline, uint32_t DrawDataOffset);
+        void _BeginRendering(VkCommandBuffer commandBuffer, VkRenderingFlags Flags, VkImageView ColorView, VkImageView DepthView);
+        // Draws [Begin, End) of the frame's Submit draws, safe to call from any thread
+        void _RecordImmediateDraws(VkCommandBuffer commandBuffer, uint32_t Begin, uint32_t End);
 
         void _CreateCommandPool();
         void _CreateCommandBuffer();
+        void _CreateCommandRecorder();
+        void _CreateGpuProfiler();
 
         void _CreateSyncObjects();
+        void _WaitFrameValue(uint64_t Value);
+        uint64_t _GetCompletedFrameValue();
+        void _CreateUploadManager();
 
         void _CreateDescriptorSetLayout();
-        void _CreateUniformBuffers();
-        void _UploadUniformBuffer();
+        void _CreateFrameAllocator();
+        // Waits for every frame in flight, then regrows the allocator to what the overflowing frame wanted
+        void _GrowFrameAllocator();
+        void _UploadFrameUniforms(const RenderPassSpec &Spec);
         void _CreateDescriptorPool();
         void _CreateDescriptorSets();
+        void _WriteDescriptorSets();
 
         void _CreateTextures();
         void _TransitionImageLayout(VkCommandBuffer commandBuffer, VkImage Image, VkImageLayout NewLayout, VkImageLayout OldLayout);
-        void _TransitionAttachmentImageLayout(VkCommandBuffer commandBuffer, VkImage Image,VkFormat Format, VkImageLayout NewLayout, VkImageLayout OldLayout);
-        VkImageView _CreateTextureImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+        VkImageView _CreateTextureImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t MipLevels = 1);
+        bool _IsFormatSupported(VkFormat Format, VkFormatFeatureFlags Features);
+        // Blits the mip chains of textures that only got their base level uploaded
+        void _GenerateMips(VkCommandBuffer commandBuffer);
+        void _CreateTextureStreamer();
+        void _CreateMemoryMonitor();
+        void _CreateDefragmenter();
+        void _CreateGeometryPool();
+        // Index a draw samples with, and tells the streamer how big it is on screen
+        uint32_t _TouchTexture(const DrawParams &Params);
         VkSampler _CreateTextureSampler();
-        void _CreateTextureDescriptorResources();
+        void _CreateBindlessTable();
 
-        void _CreateDepthData();
+        void _CreateTargetPool();
+        void _CreateDynamicResolution();
+        void _CreateFramePacer();
         VkFormat FindDepthFormat();
         VkFormat FindSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
         bool HasStencilComponent(VkFormat format);
@@ -1,27 +1,44 @@
 #pragma once
 
-#define PRINTLN(x)      \
-    {                   \
-        std::cout << x; \
-    }
-#define PRINTLN(x)              \
-    {                           \
-        std::cout << x << "\n"; \
-    }
-#define VULKAN_SUCCESS_ASSERT(x, errmsg)      \
-    {                                         \
-        if (x != VK_SUCCESS)                  \
-            throw std::runtime_error(errmsg); \
-    }
-
 namespace VEngine
 {
-    struct DepthBufferData
+    // Written once per frame, must match FrameData in the shaders
+    struct FrameUniformData
+    {
+        glm::mat4 View;
+        glm::mat4 Proj;
+        glm::mat4 ViewProj;
+    };
+
+    // Must match the push_constant block in the vertex shader, keep under the 128 bytes every device has
+    struct DrawPushConstants
     {
-        VkImage image;
-        VkImageView imageview;
-        VkFormat format;
-        VmaAllocation allocation;
+        glm::mat4 Model;
+        glm::vec4 Tint;
+        uint32_t TextureIndex;
+    };
+
+    // A replaced swapchain, the presentation engine may still read its images after the frames using them are done
+    struct VulkanRetiredSwapChain
+    {
+        VkSwapchainKHR SwapChain;
+        std::vector<VkImageView> Views;
+        // Last present queued to it, 0 when it never got one or present wait is off
+        uint64_t LastPresentId;
+    };
+
+    // A Submit, kept till End so the frame's draws can be recorded over several threads
+    struct VulkanImmediateDraw
+    {
+        VkBuffer VertexBuffer;
+        VkBuffer IndexBuffer;
+        VkIndexType IndexType;
+        uint32_t IndexCount;
+        // Where the mesh starts in pooled buffers
+        uint32_t FirstIndex;
+        int32_t VertexOffset;
+        VertexFormat Format;
+        DrawPushConstants Constants;
     };
 
     struct VulkanRenderData
@@ -38,13 +55,30 @@ namespace VEngine
         VulkanDevice Device;
 
         VmaAllocator Allocator;
+        bool MemoryBudgetExt = false;
+        VulkanMemoryMonitor MemoryMonitor;
+        MemoryBudgetCallback BudgetCallback;
+        VulkanDefragmenter Defragmenter;
+        // Static vertex and index data, meshes are ranges in a few shared buffers
+        VulkanGeometryPool GeometryPool;
 
         VkSwapchainKHR SwapChain;
         VkFormat Format;
         VkExtent2D Extent;
+        // What the scene is drawn at, smaller than Extent when dynamic resolution scaled it down
+        VkExtent2D RenderExtent;
+        VulkanDynamicResolution Resolution;
+        bool DynamicResolution = false;
+        // VK_KHR_present_id and VK_KHR_present_wait are enabled
+        bool PresentWait = false;
+        VulkanFramePacer FramePacer;
 
         std::vector<VkImage> SwapChainImages;
         std::vector<VkImageView> SwapChainImageViews;
+        // Only used headless, the images above are allocated by us then
+        std::vector<VmaAllocation> OffscreenAllocations;
+        // Waiting for their last present, then handed to the deletion queue
+        std::vector<VulkanRetiredSwapChain> RetiredSwapChains;
 
         struct
         {
@@ -52,30 +86,64 @@ namespace VEngine
         } FrameBufferSize;
 
         VkCommandPool GraphicsCommandPool, TransferCommandPool;
+        VulkanUploadManager UploadManager;
         std::vector<VkCommandBuffer> GraphicsCommandBuffers;
         std::vector<VkSemaphore> ImageAvailableSemaphores;
         std::vector<VkSemaphore> RenderFinishedSemaphores;
-        std::vector<VkFence> InFlightFences;
+        // Every graphics submission signals the next value, frame slots keep the last value they submitted
+        VkSemaphore FrameTimeline;
+        uint64_t FrameTimelineValue = 0;
+        std::vector<uint64_t> FrameSlotValues;
+        VulkanDeletionQueue DeletionQueue;
         uint32_t CurrentFrame = 0;
         uint32_t CurrentImageIndex = 0;
         bool FrameBufferChanged = false;
+        // No image was acquired this frame, End, Render and Present do nothing
+        bool FrameSkipped = false;
+
+        VulkanPipelineCache PipelineCache;
+        // Every pipeline has one per VertexFormat
+        VulkanGraphicsPipeline GraphicsPipeline[(size_t)VertexFormat::COUNT];
+        // Same shaders built with INDIRECT, per draw data comes from a storage buffer
+        VulkanGraphicsPipeline IndirectPipeline[(size_t)VertexFormat::COUNT];
+        VulkanDrawBatcher Batcher;
+        VulkanCullPass CullPass;
+        // Rebuilt in every End, owns the barriers between the frame's passes
+        VulkanRenderGraph RenderGraph;
 
-        VulkanGraphicsPipeline GraphicsPipeline;
+        // Overdraw mode, pipelines swap the fragment stage for one counting shaded fragments
+        VulkanOverdrawPass OverdrawPass;
+        VulkanGraphicsPipeline OverdrawPipeline[(size_t)VertexFormat::COUNT], OverdrawIndirectPipeline[(size_t)VertexFormat::COUNT];
+        bool OverdrawCreated = false, OverdrawRequested = false, OverdrawActive = false;
 
         VkDescriptorPool DescriptorPool;
         VkDescriptorSetLayout DescriptorSetLayout;
-        std::vector<Scope<VulkanUniformBuffer>> UniformBuffers;
-        std::vector<VkDescriptorSet> DescriptorSets;
+        // Per draw uniform data, bound through dynamic offsets into one shared set
+        VulkanLinearAllocator FrameAllocator;
+        VkDescriptorSet DescriptorSet;
+        // Where this frame's camera data sits in the frame allocator
+        uint32_t FrameUniformOffset = 0;
+        glm::mat4 ViewProj;
+        // Camera of the frame, draws are sized on screen with it for texture streaming
+        glm::mat4 View;
+        float ProjScale = 1.0f;
+        VkClearColorValue ClearColor;
+
+        std::vector<VulkanImmediateDraw> ImmediateDraws;
+        VulkanCommandRecorder Recorder;
+        VulkanGpuProfiler GpuProfiler;
+        bool CalibratedTimestamps = false;
 
         VulkanTextures Texture;
-        VulkanTextureDescriptor TextureDescriptor;
-        DepthBufferData DepthData;
-    };
+        // Base level uploaded, waiting for their mips to be blitted at the next Begin
+        std::vector<VulkanTextures *> PendingMipTextures;
+        VulkanTextureStreamer TextureStreamer;
+        VulkanBindlessTable BindlessTable;
+        // Depth images come from the target pool through the render graph
+        VkFormat DepthFormat;
+        VulkanTargetPool TargetPool;
 
-    struct UniformBufferObject
-    {
-        glm::mat4 model;
-        glm::mat4 view;
-        glm::mat4 proj;
+        // Value the frame being recorded will signal, anything retired now is free once it is reached
+        uint64_t RecordingFrameValue() const { return FrameTimelineValue + 1; }
     };
 } // namespace VEngine
@@ -0,0 +1,317 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanTargetPool.h"
+#include "VulkanRenderGraph.h"
+
+namespace VEngine
+{
+    static constexpr VkAccessFlags2 WRITE_ACCESS = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+                                                   VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                                   VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+    VulkanRenderPassBuilder &VulkanRenderPassBuilder::Read(VulkanRenderResource Resource, VulkanResourceUsage Usage)
+    {
+        for (auto &use : _Graph->_Passes[_Pass].Uses)
+            if (use.Resource == Resource)
+                throw std::runtime_error("render graph pass uses a resource twice!");
+        _Graph->_Passes[_Pass].Uses.push_back({Resource, Usage, false});
+        return *this;
+    }
+
+    VulkanRenderPassBuilder &VulkanRenderPassBuilder::Write(VulkanRenderResource Resource, VulkanResourceUsage Usage)
+    {
+        Read(Resource, Usage);
+        _Graph->_Passes[_Pass].Uses.back().Writes = true;
+        return *this;
+    }
+
+    VulkanRenderPassBuilder &VulkanRenderPassBuilder::SideEffect()
+    {
+        _Graph->_Passes[_Pass].SideEffect = true;
+        return *this;
+    }
+
+    VulkanRenderGraph::UsageInfo VulkanRenderGraph::_GetUsageInfo(VulkanResourceUsage Usage)
+    {
+        switch (Usage)
+        {
+        case VulkanResourceUsage::COLOR_ATTACHMENT:
+            return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        case VulkanResourceUsage::DEPTH_ATTACHMENT:
+            return {VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+        case VulkanResourceUsage::INDIRECT_READ:
+            return {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED};
+        case VulkanResourceUsage::COMPUTE_READ:
+            return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+        case VulkanResourceUsage::COMPUTE_WRITE:
+            return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_GENERAL};
+        case VulkanResourceUsage::FRAGMENT_WRITE:
+            return {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_GENERAL};
+        case VulkanResourceUsage::TRANSFER_READ:
+            return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+        case VulkanResourceUsage::TRANSFER_WRITE:
+            return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+        case VulkanResourceUsage::HOST_READ:
+            return {VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+        case VulkanResourceUsage::PRESENT:
+            // Same stage the acquire semaphore is waited and the present semaphore signaled at
+            return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR};
+        }
+        throw std::invalid_argument("unknown render graph usage!");
+    }
+
+    void VulkanRenderGraph::Init(const VulkanRenderGraphSpec &Spec)
+    {
+        _Spec = Spec;
+    }
+
+    void VulkanRenderGraph::Reset()
+    {
+        _Resources.clear();
+        _Passes.clear();
+        _ImageBarriers.clear();
+        _MemoryBarrier = {};
+        _CulledCount = 0;
+        _BarrierCount = 0;
+    }
+
+    VulkanRenderResource VulkanRenderGraph::ImportImage(const char *Name, VkImage Image, VkImageAspectFlags Aspect, VulkanResourceUsage Last, bool Discard)
+    {
+        auto Info = _GetUsageInfo(Last);
+
+        Resource Res{};
+        Res.Name = Name;
+        Res.Image = Image;
+        Res.Aspect = Aspect;
+        Res.Layout = Discard ? VK_IMAGE_LAYOUT_UNDEFINED : Info.Layout;
+        if (Info.Access & WRITE_ACCESS)
+        {
+            Res.WriteStages = Info.Stages;
+            Res.WriteAccess = Info.Access & WRITE_ACCESS;
+        }
+        else
+            Res.ReadStages = Info.Stages;
+
+        _Resources.push_back(Res);
+        return (VulkanRenderResource)_Resources.size() - 1;
+    }
+
+    VulkanRenderResource VulkanRenderGraph::ImportBuffer(const char *Name, VulkanResourceUsage Last)
+    {
+        return ImportImage(Name, VK_NULL_HANDLE, 0, Last, true);
+    }
+
+    void VulkanRenderGraph::Export(VulkanRenderResource Resource, VulkanResourceUsage Usage)
+    {
+        _Resources[Resource].Exported = true;
+        _Resources[Resource].ExportUsage = Usage;
+    }
+
+    VulkanRenderResource VulkanRenderGraph::CreateImage(const char *Name, const VulkanTargetDesc &Desc)
+    {
+        Resource Res{};
+        Res.Name = Name;
+        Res.Aspect = VulkanTargetPool::GetAspect(Desc.Format);
+        Res.Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        Res.Transient = true;
+        Res.Desc = Desc;
+
+        _Resources.push_back(Res);
+        return (VulkanRenderResource)_Resources.size() - 1;
+    }
+
+    VulkanRenderPassBuilder VulkanRenderGraph::AddPass(const char *Name, const VulkanRenderPassFn &Fn)
+    {
+        _Passes.push_back({Name, Fn, {}, false, false});
+        return VulkanRenderPassBuilder(this, (uint32_t)_Passes.size() - 1);
+    }
+
+    void VulkanRenderGraph::_Cull()
+    {
+        std::vector<bool> Needed(_Resources.size());
+        for (size_t i = 0; i < _Resources.size(); i++)
+            Needed[i] = _Resources[i].Exported;
+
+        // Writes count as partial, an earlier writer of a needed resource stays too
+        for (size_t i = _Passes.size(); i-- > 0;)
+        {
+            auto &pass = _Passes[i];
+            pass.Alive = pass.SideEffect;
+            for (auto &use : pass.Uses)
+                pass.Alive |= use.Writes && Needed[use.Resource];
+
+            if (!pass.Alive)
+            {
+                _CulledCount++;
+                continue;
+            }
+            for (auto &use : pass.Uses)
+                Needed[use.Resource] = true;
+        }
+    }
+
+    void VulkanRenderGraph::_PlaceTransients(uint64_t FrameValue)
+    {
+        _Targets.clear();
+        _TargetResources.clear();
+        std::vector<int32_t> Target(_Resources.size(), -1);
+
+        uint32_t Index = 0;
+        for (auto &pass : _Passes)
+        {
+            if (!pass.Alive)
+                continue;
+            for (auto &use : pass.Uses)
+            {
+                auto &Res = _Resources[use.Resource];
+                if (!Res.Transient)
+                    continue;
+                if (Target[use.Resource] < 0)
+                {
+                    Target[use.Resource] = (int32_t)_Targets.size();
+                    _Targets.push_back({Res.Desc, Index, Index});
+                    _TargetResources.push_back(use.Resource);
+                }
+                _Targets[Target[use.Resource]].Last = Index;
+
+                auto Info = _GetUsageInfo(use.Usage);
+                _TransientStages |= Info.Stages;
+                _TransientAccess |= Info.Access & WRITE_ACCESS;
+            }
+            Index++;
+        }
+        if (_Targets.empty())
+            return;
+
+        _Spec.Targets->Allocate(_Targets, FrameValue);
+        for (size_t i = 0; i < _Targets.size(); i++)
+        {
+            auto &Res = _Resources[_TargetResources[i]];
+            Res.Image = _Targets[i].Image;
+            Res.View = _Targets[i].View;
+            Res.WriteStages = _TransientStages;
+            Res.WriteAccess = _TransientAccess;
+        }
+    }
+
+    void VulkanRenderGraph::_Access(Resource &Res, VulkanResourceUsage Usage, bool Writes)
+    {
+        auto Info = _GetUsageInfo(Usage);
+
+        if (Res.Image != VK_NULL_HANDLE && Res.Layout != Info.Layout)
+        {
+            VkImageMemoryBarrier2 barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+            barrier.srcStageMask = Res.WriteStages | Res.ReadStages;
+            barrier.srcAccessMask = Res.WriteAccess;
+            barrier.dstStageMask = Info.Stages;
+            barrier.dstAccessMask = Info.Access;
+            barrier.oldLayout = Res.Layout;
+            barrier.newLayout = Info.Layout;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = Res.Image;
+            barrier.subresourceRange = {Res.Aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+            _ImageBarriers.push_back(barrier);
+
+            // The transition is a write of its own, whatever comes next orders after it
+            Res.Layout = Info.Layout;
+            Res.WriteStages = Info.Stages;
+            Res.WriteAccess = Writes ? Info.Access & WRITE_ACCESS : VK_ACCESS_2_NONE;
+            Res.ReadStages = Writes ? VK_PIPELINE_STAGE_2_NONE : Info.Stages;
+            Res.VisibleStages = Writes ? VK_PIPELINE_STAGE_2_NONE : Info.Stages;
+            Res.VisibleAccess = Writes ? VK_ACCESS_2_NONE : Info.Access;
+            return;
+        }
+
+        if (Writes)
+        {
+            // After reads only their execution has to be done, the write they saw already is
+            if (Res.ReadStages)
+            {
+                _MemoryBarrier.srcStageMask |= Res.ReadStages;
+                _MemoryBarrier.dstStageMask |= Info.Stages;
+            }
+            else if (Res.WriteStages)
+            {
+                _MemoryBarrier.srcStageMask |= Res.WriteStages;
+                _MemoryBarrier.srcAccessMask |= Res.WriteAccess;
+                _MemoryBarrier.dstStageMask |= Info.Stages;
+                _MemoryBarrier.dstAccessMask |= Info.Access;
+            }
+
+            Res.WriteStages = Info.Stages;
+            Res.WriteAccess = Info.Access & WRITE_ACCESS;
+            Res.ReadStages = VK_PIPELINE_STAGE_2_NONE;
+            Res.VisibleStages = VK_PIPELINE_STAGE_2_NONE;
+            Res.VisibleAccess = VK_ACCESS_2_NONE;
+            return;
+        }
+
+        // Reads after reads need nothing, so does a write that is already visible to this reader
+        bool Visible = !(Info.Stages & ~Res.VisibleStages) && !(Info.Access & ~Res.VisibleAccess);
+        if (Res.WriteStages && !Visible)
+        {
+            _MemoryBarrier.srcStageMask |= Res.WriteStages;
+            _MemoryBarrier.srcAccessMask |= Res.WriteAccess;
+            _MemoryBarrier.dstStageMask |= Info.Stages;
+            _MemoryBarrier.dstAccessMask |= Info.Access;
+        }
+        Res.ReadStages |= Info.Stages;
+        Res.VisibleStages |= Info.Stages;
+        Res.VisibleAccess |= Info.Access;
+    }
+
+    void VulkanRenderGraph::_FlushBarriers(VkCommandBuffer Cmd)
+    {
+        bool Memory = _MemoryBarrier.srcStageMask || _MemoryBarrier.dstStageMask;
+        if (!Memory && _ImageBarriers.empty())
+            return;
+
+        _MemoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        VkDependencyInfo Dependency{};
+        Dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        Dependency.memoryBarrierCount = Memory ? 1 : 0;
+        Dependency.pMemoryBarriers = &_MemoryBarrier;
+        Dependency.imageMemoryBarrierCount = (uint32_t)_ImageBarriers.size();
+        Dependency.pImageMemoryBarriers = _ImageBarriers.data();
+        vkCmdPipelineBarrier2(Cmd, &Dependency);
+
+        _MemoryBarrier = {};
+        _ImageBarriers.clear();
+        _BarrierCount++;
+    }
+
+    void VulkanRenderGraph::Execute(VkCommandBuffer Cmd, uint64_t FrameValue)
+    {
+        _Cull();
+        _PlaceTransients(FrameValue);
+
+        for (auto &pass : _Passes)
+        {
+            if (!pass.Alive)
+                continue;
+            for (auto &use : pass.Uses)
+                _Access(_Resources[use.Resource], use.Usage, use.Writes);
+            _FlushBarriers(Cmd);
+            pass.Fn(Cmd);
+        }
+
+        // Everything used after the graph is handed over with one last barrier
+        for (auto &Res : _Resources)
+            if (Res.Exported)
+                _Access(Res, Res.ExportUsage, false);
+        _FlushBarriers(Cmd);
+    }
+} // namespace VEngine
@@ -0,0 +1,157 @@
+#pragma once
+
+namespace VEngine
+{
+    // How a pass touches a resource, every usage maps to one set of stages, accesses and layout
+    enum class VulkanResourceUsage
+    {
+        COLOR_ATTACHMENT,
+        DEPTH_ATTACHMENT,
+        INDIRECT_READ,
+        // Storage reads and writes, images are in GENERAL
+        COMPUTE_READ,
+        COMPUTE_WRITE,
+        FRAGMENT_WRITE,
+        TRANSFER_READ,
+        TRANSFER_WRITE,
+        HOST_READ,
+        PRESENT
+    };
+
+    struct VulkanRenderGraphSpec
+    {
+        // Where the graph's own images come from
+        VulkanTargetPool *Targets;
+    };
+
+    using VulkanRenderResource = uint32_t;
+    using VulkanRenderPassFn = std::function<void(VkCommandBuffer)>;
+
+    class VulkanRenderGraph;
+
+    // Returned by AddPass, declares what the pass uses
+    class VulkanRenderPassBuilder
+    {
+    public:
+        VulkanRenderPassBuilder(VulkanRenderGraph *Graph, uint32_t Pass) : _Graph(Graph), _Pass(Pass) {}
+
+        VulkanRenderPassBuilder &Read(VulkanRenderResource Resource, VulkanResourceUsage Usage);
+        VulkanRenderPassBuilder &Write(VulkanRenderResource Resource, VulkanResourceUsage Usage);
+        // Never culled, for passes whose results leave through something the graph doesn't see
+        VulkanRenderPassBuilder &SideEffect();
+
+    private:
+        VulkanRenderGraph *_Graph;
+        uint32_t _Pass;
+    };
+
+    // Frame graph over one command buffer. Passes declare the resources they read and write,
+    // Execute drops every pass nothing exported depends on and records the rest in declaration
+    // order, which is a dependency order since a pass can only depend on the ones declared before it.
+    // Barriers are worked out from the tracked state of each resource and merged into one
+    // vkCmdPipelineBarrier2 per pass boundary, images only get an image barrier on a layout change.
+    // Images created by the graph only live for the frame, they come from the target pool once
+    // culling is done and alias each other's memory when their passes don't overlap.
+    // Rebuilt every frame, Reset keeps the storage
+    class VulkanRenderGraph
+    {
+    public:
+        VulkanRenderGraph() {}
+        ~VulkanRenderGraph() {}
+
+        void Init(const VulkanRenderGraphSpec &Spec);
+        void Reset();
+
+        // Last is how the resource was used before the graph, Discard drops the contents
+        VulkanRenderResource ImportImage(const char *Name, VkImage Image, VkImageAspectFlags Aspect, VulkanResourceUsage Last, bool Discard);
+        VulkanRenderResource ImportBuffer(const char *Name, VulkanResourceUsage Last);
+        // Used after the graph, passes writing it are kept and it is left ready for Usage
+        void Export(VulkanRenderResource Resource, VulkanResourceUsage Usage);
+        // Transient image, undefined at its first use and gone after its last
+        VulkanRenderResource CreateImage(const char *Name, const VulkanTargetDesc &Desc);
+
+        VulkanRenderPassBuilder AddPass(const char *Name, const VulkanRenderPassFn &Fn);
+
+        // FrameValue is the frame timeline value the command buffer signals
+        void Execute(VkCommandBuffer Cmd, uint64_t FrameValue);
+
+        // Only inside pass functions for created images
+        VkImage GetImage(VulkanRenderResource Resource) const { return _Resources[Resource].Image; }
+        VkImageView GetView(VulkanRenderResource Resource) const { return _Resources[Resource].View; }
+
+        uint32_t GetCulledCount() const { return _CulledCount; }
+        uint32_t GetBarrierCount() const { return _BarrierCount; }
+
+    private:
+        friend class VulkanRenderPassBuilder;
+
+        struct UsageInfo
+        {
+            VkPipelineStageFlags2 Stages;
+            VkAccessFlags2 Access;
+            VkImageLayout Layout;
+        };
+
+        struct Resource
+        {
+            const char *Name;
+            VkImage Image;
+            VkImageView View;
+            VkImageAspectFlags Aspect;
+            VkImageLayout Layout;
+            // Last write still to be made visible, and everything reading since
+            VkPipelineStageFlags2 WriteStages;
+            VkAccessFlags2 WriteAccess;
+            VkPipelineStageFlags2 ReadStages;
+            // Stages and accesses the last write was already made visible to
+            VkPipelineStageFlags2 VisibleStages;
+            VkAccessFlags2 VisibleAccess;
+            bool Exported;
+            VulkanResourceUsage ExportUsage;
+            bool Transient;
+            VulkanTargetDesc Desc;
+        };
+
+        struct Use
+        {
+            VulkanRenderResource Resource;
+            VulkanResourceUsage Usage;
+            bool Writes;
+        };
+
+        struct Pass
+        {
+            const char *Name;
+            VulkanRenderPassFn Fn;
+            std::vector<Use> Uses;
+            bool SideEffect;
+            bool Alive;
+        };
+
+        static UsageInfo _GetUsageInfo(VulkanResourceUsage Usage);
+        void _Cull();
+        // Lifetimes of the transients left after culling, then their images from the pool
+        void _PlaceTransients(uint64_t FrameValue);
+        // Adds what moving the resource to Usage needs to the pending barriers
+        void _Access(Resource &Res, VulkanResourceUsage Usage, bool Writes);
+        void _FlushBarriers(VkCommandBuffer Cmd);
+
+    private:
+        VulkanRenderGraphSpec _Spec;
+        std::vector<Resource> _Resources;
+        std::vector<Pass> _Passes;
+
+        std::vector<VulkanTransientTarget> _Targets;
+        std::vector<VulkanRenderResource> _TargetResources;
+        // Everything transients were ever used with. Aliased memory and images handed on from the
+        // last frame were touched by some of it, a first use orders after all of it
+        VkPipelineStageFlags2 _TransientStages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 _TransientAccess = VK_ACCESS_2_NONE;
+
+        VkMemoryBarrier2 _MemoryBarrier{};
+        std::vector<VkImageMemoryBarrier2> _ImageBarriers;
+
+        uint32_t _CulledCount = 0;
+        uint32_t _BarrierCount = 0;
+    };
+} // namespace VEngine
@@ -1,12 +1,35 @@
 #include "VeVPCH.h"
 
+#ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
+#endif
 #include "vulkan/vulkan.h"
 
 #include "vk_mem_alloc.h"
 #include "VulkanRenderApi.h"
 #include "VulkanDevice.h"
 #include "VulkanResourceFactory.h"
+#include "VulkanStagingRing.h"
+#include "VulkanUploadManager.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanShader.h"
+#include "VulkanBindlessTable.h"
+#include "VulkanLinearAllocator.h"
+#include "VulkanDrawBatcher.h"
+#include "VulkanCullPass.h"
+#include "VulkanCommandRecorder.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanGpuProfiler.h"
+#include "VulkanOverdrawPass.h"
+#include "VulkanTextureLoader.h"
+#include "VulkanTextureStreamer.h"
+#include "VulkanMemoryMonitor.h"
+#include "VulkanDefragmenter.h"
+#include "VulkanGeometryPool.h"
+#include "VulkanTargetPool.h"
+#include "VulkanRenderGraph.h"
+#include "VulkanDynamicResolution.h"
+#include "VulkanFramePacer.h"
 #include "VulkanRenderData.h"
 
 namespace VEngine
@@ -22,59 +45,50 @@ namespace VEngine
 
     Ref<VertexBuffer> VulkanResourceFactory::CreateVertexBuffer(const VertexBufferDesc &desc)
     {
-        Ref<VulkanVertexBuffer> VB = std::make_shared<VulkanVertexBuffer>(_Data->Allocator, desc);
-
-        if (desc.Type == BufferTypes::STATIC_DRAW)
+        // Static meshes share the pool's buffers when the stride is known
+        VulkanGeometryRange Range;
+        if (desc.Type == BufferTypes::STATIC_DRAW && desc.Count > 0 && desc.SizeInBytes % desc.Count == 0 &&
+            _Data->GeometryPool.Allocate(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, desc.SizeInBytes / desc.Count, desc.Count, Range))
         {
-            // Use staging buffer
-            VulkanStageBufferSpec StagingBufferSpec{};
-            StagingBufferSpec.Data = desc.Data;
-            StagingBufferSpec.Size = desc.SizeInBytes;
-
-            VulkanStageBuffer StagingBuffer(_Data->Allocator, StagingBufferSpec);
-
-            SingleTimeCommandBuffer SingleComamndSpec{};
-            SingleComamndSpec.Family = QueueFamilies::TRANSFER;
+            Ref<VulkanVertexBuffer> VB = std::make_shared<VulkanVertexBuffer>(&_Data->GeometryPool, Range, desc);
+            VB->SetUploadToken(_Data->GeometryPool.Upload(Range, desc.Data, desc.SizeInBytes));
+            return VB;
+        }
 
-            this->BeginSingleTimeCommand(SingleComamndSpec);
-            this->CopyBuffer(StagingBuffer.GetHandle(), VB->GetHandle(), desc.SizeInBytes, SingleComamndSpec);
-            this->EndSingleTimeCommand(SingleComamndSpec);
+        Ref<VulkanVertexBuffer> VB = std::make_shared<VulkanVertexBuffer>(_Data->Allocator, _Data->UploadManager, desc);
 
-            StagingBuffer.Destroy(_Data->Allocator);
-        }
+        // Copy is batched on the transfer queue, draws wait on the upload timeline instead of the cpu
+        if (desc.Type == BufferTypes::STATIC_DRAW)
+            VB->SetUploadToken(_Data->UploadManager.UploadBuffer(VB->GetHandle(), desc.Data, desc.SizeInBytes));
 
         return VB;
     }
 
     bool VulkanResourceFactory::DeleteVertexBuffer(const Ref<VertexBuffer> &VB)
     {
+        // Frames already recorded may still draw it
         auto VulkanVB = std::static_pointer_cast<VulkanVertexBuffer>(VB);
-        VulkanVB->Destroy(_Data->Allocator);
+        VulkanVB->Retire(_Data->DeletionQueue, _Data->RecordingFrameValue());
         return true;
     }
 
     Ref<IndexBuffer> VulkanResourceFactory::CreateIndexBuffer(const IndexBufferDesc &desc)
     {
-        Ref<VulkanIndexBuffer> IB = std::make_shared<VulkanIndexBuffer>(_Data->Allocator, desc);
-
-        if (desc.Type == BufferTypes::STATIC_DRAW)
+        VulkanGeometryRange Range;
+        uint32_t Stride = desc.DataType == IndexBufferType::UINT_32 ? 4 : desc.DataType == IndexBufferType::UINT_16 ? 2 : 0;
+        if (desc.Type == BufferTypes::STATIC_DRAW && Stride &&
+            _Data->GeometryPool.Allocate(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, Stride, desc.Count, Range))
         {
-            // Use staging buffer
-            VulkanStageBufferSpec StagingBufferSpec{};
-            StagingBufferSpec.Data = desc.Data;
-            StagingBufferSpec.Size = desc.SizeInBytes;
-
-            VulkanStageBuffer StagingBuffer(_Data->Allocator, StagingBufferSpec);
-
-            SingleTimeCommandBuffer SingleComamndSpec{};
-            SingleComamndSpec.Family = QueueFamilies::TRANSFER;
+            Ref<VulkanIndexBuffer> IB = std::make_shared<VulkanIndexBuffer>(&_Data->GeometryPool, Range, desc);
+            IB->SetUploadToken(_Data->GeometryPool.Upload(Range, desc.Data, desc.SizeInBytes));
+            return IB;
+        }
 
-            this->BeginSingleTimeCommand(SingleComamndSpec);
-            this->CopyBuffer(StagingBuffer.GetHandle(), IB->GetHandle(), desc.SizeInBytes, SingleComamndSpec);
-            this->EndSingleTimeCommand(SingleComamndSpec);
+        Ref<VulkanIndexBuffer> IB = std::make_shared<VulkanIndexBuffer>(_Data->Allocator, _Data->UploadManager, desc);
 
-            StagingBuffer.Destroy(_Data->Allocator);
-        }
+        // Copy is batched on the transfer queue, draws wait on the upload timeline instead of the cpu
+        if (desc.Type == BufferTypes::STATIC_DRAW)
+            IB->SetUploadToken(_Data->UploadManager.UploadBuffer(IB->GetHandle(), desc.Data, desc.SizeInBytes));
 
         return IB;
     }
@@ -82,7 +96,19 @@ namespace VEngine
     bool VulkanResourceFactory::DeleteIndexBuffer(const Ref<IndexBuffer> &IB)
     {
         auto VulkanIB = std::static_pointer_cast<VulkanIndexBuffer>(IB);
-        VulkanIB->Destroy(_Data->Allocator);
+        VulkanIB->Retire(_Data->DeletionQueue, _Data->RecordingFrameValue());
+        return true;
+    }
+
+    Ref<Texture> VulkanResourceFactory::CreateTexture(const TextureDesc &desc)
+    {
+        // Nothing is read here, the streamer's workers pick it up at the next frame
+        return _Data->TextureStreamer.Create(desc);
+    }
+
+    bool VulkanResourceFactory::DeleteTexture(const Ref<Texture> &Tex)
+    {
+        _Data->TextureStreamer.Release(std::static_pointer_cast<VulkanStreamedTexture>(Tex), _Data->RecordingFrameValue());
         return true;
     }
 
@@ -95,6 +121,11 @@ namespace VEngine
         vkCmdCopyBuffer(Spec.Cmd, Src, Dst, 1, &copyRegion);
     }
 
+    bool VulkanResourceFactory::IsUploadComplete(UploadToken Token)
+    {
+        return _Data->UploadManager.IsComplete(Token);
+    }
+
     void VulkanResourceFactory::BeginSingleTimeCommand(SingleTimeCommandBuffer &Spec)
     {
         VkCommandBufferAllocateInfo allocInfo{};
@@ -134,7 +165,7 @@ namespace VEngine
             vkFreeCommandBuffers(_Data->Device.GetHandle(), _Data->TransferCommandPool, 1, &Spec.Cmd);
     }
 
-    // TODO: Make as muhc as posible few staging buffer
+    // Only used for single copies that don't fit in the staging ring
     VulkanStageBuffer::VulkanStageBuffer(VmaAllocator Allocator, const VulkanStageBufferSpec &spec)
     {
         VkBufferCreateInfo bufferInfo = {};
@@ -170,10 +201,11 @@ namespace VEngine
         vkCmdCopyBuffer(TransferCommandBuffer, _Buffer, DstBuffer, 1, &copyRegion);
     }
 
-    VulkanVertexBuffer::VulkanVertexBuffer(VmaAllocator Allocator, const VertexBufferDesc &desc)
+    VulkanVertexBuffer::VulkanVertexBuffer(VmaAllocator Allocator, const VulkanUploadManager &Uploads, const VertexBufferDesc &desc)
     {
         this->_Count = desc.Count;
         this->_Size = desc.SizeInBytes;
+        this->_Format = desc.Format;
 
         VkBufferCreateInfo bufferInfo = {};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -184,9 +216,10 @@ namespace VEngine
         if (desc.Type == BufferTypes::STATIC_DRAW)
         {
             // TODO: Use staging buffer VMA_MEMORY_USAGE_GPU_ONLY
-            bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+            // Transfer source so defragmentation can copy it elsewhere
+            bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
             allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY; // For frequent updates
-            bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            Uploads.SetSharing(bufferInfo);
             allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
         }
         else if (desc.Type == BufferTypes::DYNAMIC_DARW)
@@ -207,19 +240,74 @@ namespace VEngine
         }
 
         vmaCreateBuffer(Allocator, &bufferInfo, &allocInfo, &_Buffer, &_Allocation, &_AllocatoinInfo);
+        _Allocator = Allocator;
+        _Usage = bufferInfo.usage;
+        // Only device local buffers are worth moving, mapped ones are written by the cpu anyway
+        if (desc.Type == BufferTypes::STATIC_DRAW)
+            vmaSetAllocationUserData(Allocator, _Allocation, static_cast<VulkanMovableBuffer *>(this));
+    }
+
+    VulkanVertexBuffer::VulkanVertexBuffer(VulkanGeometryPool *Pool, const VulkanGeometryRange &Range, const VertexBufferDesc &desc)
+        : _Pool(Pool), _Range(Range)
+    {
+        this->_Count = desc.Count;
+        this->_Size = desc.SizeInBytes;
+        this->_Format = desc.Format;
+        _Buffer = Range.Buffer;
+        _Usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    }
+
+    VulkanVertexBuffer::~VulkanVertexBuffer()
+    {
+        // Never retired, the allocation leaks but must not be moved with this gone
+        if (_Allocation)
+            vmaSetAllocationUserData(_Allocator, _Allocation, nullptr);
     }
 
     void VulkanVertexBuffer::UploadData(const void *data, uint32_t size)
     {
+        // Pooled ranges hold whole elements only
+        VkDeviceSize Capacity = _Pool ? (VkDeviceSize)_Range.Count * _Range.Stride : _Size;
+        if (size > Capacity)
+            throw std::runtime_error("Vertex Buffer Upload Larger Than The Buffer!");
+        if (_Pool)
+        {
+            // Earlier frames may still draw the old contents, they keep them till they're done
+            _UploadToken = _Pool->Update(_Range, data, size);
+            _Buffer = _Range.Buffer;
+            return;
+        }
+        // Defragmentation may have moved the mapping
+        vmaGetAllocationInfo(_Allocator, _Allocation, &_AllocatoinInfo);
         memcpy(_AllocatoinInfo.pMappedData, data, size);
     }
 
     void VulkanVertexBuffer::Destroy(VmaAllocator Allocator)
     {
+        // Pool buffers go with the pool
+        if (_Pool)
+            return;
         vmaDestroyBuffer(Allocator, _Buffer, _Allocation);
+        _Buffer = VK_NULL_HANDLE;
+        _Allocation = nullptr;
+    }
+
+    void VulkanVertexBuffer::Retire(VulkanDeletionQueue &Queue, uint64_t Value)
+    {
+        if (_Pool)
+        {
+            _Pool->Free(_Range, Value);
+            _Buffer = VK_NULL_HANDLE;
+            return;
+        }
+        if (_Allocation)
+            vmaSetAllocationUserData(_Allocator, _Allocation, nullptr);
+        Queue.RetireBuffer(_Buffer, _Allocation, Value);
+        _Buffer = VK_NULL_HANDLE;
+        _Allocation = nullptr;
     }
 
-    VulkanIndexBuffer::VulkanIndexBuffer(VmaAllocator Allocator, const IndexBufferDesc &desc)
+    VulkanIndexBuffer::VulkanIndexBuffer(VmaAllocator Allocator, const VulkanUploadManager &Uploads, const IndexBufferDesc &desc)
     {
         this->_Count = desc.Count;
         this->_Size = desc.SizeInBytes;
@@ -235,9 +323,10 @@ namespace VEngine
         if (desc.Type == BufferTypes::STATIC_DRAW)
         {
             // TODO: Use staging buffer VMA_MEMORY_USAGE_GPU_ONLY
-            bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+            // Transfer source so defragmentation can copy it elsewhere
+            bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
             allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY; // For frequent updates
-            bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            Uploads.SetSharing(bufferInfo);
         }
         else if (desc.Type == BufferTypes::DYNAMIC_DARW)
         {
@@ -257,16 +346,71 @@ namespace VEngine
         }
 
         vmaCreateBuffer(Allocator, &bufferInfo, &allocInfo, &_Buffer, &_Allocation, &_AllocatoinInfo);
+        _Allocator = Allocator;
+        _Usage = bufferInfo.usage;
+        // Only device local buffers are worth moving, mapped ones are written by the cpu anyway
+        if (desc.Type == BufferTypes::STATIC_DRAW)
+            vmaSetAllocationUserData(Allocator, _Allocation, static_cast<VulkanMovableBuffer *>(this));
+    }
+
+    VulkanIndexBuffer::VulkanIndexBuffer(VulkanGeometryPool *Pool, const VulkanGeometryRange &Range, const IndexBufferDesc &desc)
+        : _Pool(Pool), _Range(Range)
+    {
+        this->_Count = desc.Count;
+        this->_Size = desc.SizeInBytes;
+        this->_DataType = desc.DataType;
+        _Buffer = Range.Buffer;
+        _Usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    }
+
+    VulkanIndexBuffer::~VulkanIndexBuffer()
+    {
+        // Never retired, the allocation leaks but must not be moved with this gone
+        if (_Allocation)
+            vmaSetAllocationUserData(_Allocator, _Allocation, nullptr);
     }
 
     void VulkanIndexBuffer::UploadData(const void *data, uint32_t size)
     {
+        // Pooled ranges hold whole elements only
+        VkDeviceSize Capacity = _Pool ? (VkDeviceSize)_Range.Count * _Range.Stride : _Size;
+        if (size > Capacity)
+            throw std::runtime_error("Index Buffer Upload Larger Than The Buffer!");
+        if (_Pool)
+        {
+            // Earlier frames may still draw the old contents, they keep them till they're done
+            _UploadToken = _Pool->Update(_Range, data, size);
+            _Buffer = _Range.Buffer;
+            return;
+        }
+        // Defragmentation may have moved the mapping
+        vmaGetAllocationInfo(_Allocator, _Allocation, &_AllocatoinInfo);
         memcpy(_AllocatoinInfo.pMappedData, data, size);
     }
 
     void VulkanIndexBuffer::Destroy(VmaAllocator Allocator)
     {
+        // Pool buffers go with the pool
+        if (_Pool)
+            return;
         vmaDestroyBuffer(Allocator, _Buffer, _Allocation);
+        _Buffer = VK_NULL_HANDLE;
+        _Allocation = nullptr;
+    }
+
+    void VulkanIndexBuffer::Retire(VulkanDeletionQueue &Queue, uint64_t Value)
+    {
+        if (_Pool)
+        {
+            _Pool->Free(_Range, Value);
+            _Buffer = VK_NULL_HANDLE;
+            return;
+        }
+        if (_Allocation)
+            vmaSetAllocationUserData(_Allocator, _Allocation, nullptr);
+        Queue.RetireBuffer(_Buffer, _Allocation, Value);
+        _Buffer = VK_NULL_HANDLE;
+        _Allocation = nullptr;
     }
 
     void _ReadFile(const char *FilePath, std::vector<char> &CharData)
@@ -298,6 +442,20 @@ namespace VEngine
         return shaderModule;
     }
 
+    VkShaderModule _CreateShaderModule(VkDevice device, const std::vector<uint32_t> &code)
+    {
+        VkShaderModuleCreateInfo createinfo{};
+        createinfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createinfo.codeSize = code.size() * sizeof(uint32_t);
+        createinfo.pCode = code.data();
+
+        VkShaderModule shaderModule;
+        if (vkCreateShaderModule(device, &createinfo, nullptr, &shaderModule) != VK_SUCCESS)
+            throw std::runtime_error("failed to create shader module!");
+
+        return shaderModule;
+    }
+
     VkPipelineShaderStageCreateInfo _CreateShaderStages(VkShaderModule module, VkShaderStageFlagBits type, const char *Name)
     {
         VkPipelineShaderStageCreateInfo stage{};
@@ -337,6 +495,17 @@ namespace VEngine
             return sizeof(unsigned int) * 3;
         case ShaderDataType::UINT4:
             return sizeof(unsigned int) * 4;
+        case ShaderDataType::HALF2:
+        case ShaderDataType::SNORM16_2:
+        case ShaderDataType::UNORM16_2:
+            return sizeof(uint16_t) * 2;
+        case ShaderDataType::HALF4:
+        case ShaderDataType::SNORM16_4:
+        case ShaderDataType::UNORM16_4:
+            return sizeof(uint16_t) * 4;
+        case ShaderDataType::UNORM8_4:
+        case ShaderDataType::SNORM8_4:
+            return sizeof(uint8_t) * 4;
         default:
             break;
         }
@@ -370,6 +539,22 @@ namespace VEngine
             return VkFormat::VK_FORMAT_R32G32B32_UINT;
         case ShaderDataType::UINT4:
             return VkFormat::VK_FORMAT_R32G32B32A32_UINT;
+        case ShaderDataType::HALF2:
+            return VkFormat::VK_FORMAT_R16G16_SFLOAT;
+        case ShaderDataType::HALF4:
+            return VkFormat::VK_FORMAT_R16G16B16A16_SFLOAT;
+        case ShaderDataType::SNORM16_2:
+            return VkFormat::VK_FORMAT_R16G16_SNORM;
+        case ShaderDataType::SNORM16_4:
+            return VkFormat::VK_FORMAT_R16G16B16A16_SNORM;
+        case ShaderDataType::UNORM16_2:
+            return VkFormat::VK_FORMAT_R16G16_UNORM;
+        case ShaderDataType::UNORM16_4:
+            return VkFormat::VK_FORMAT_R16G16B16A16_UNORM;
+        case ShaderDataType::UNORM8_4:
+            return VkFormat::VK_FORMAT_R8G8B8A8_UNORM;
+        case ShaderDataType::SNORM8_4:
+            return VkFormat::VK_FORMAT_R8G8B8A8_SNORM;
         }
     }
 
@@ -395,12 +580,20 @@ namespace VEngine
         VkShaderModule ShaderModules[ShaderTypes::COUNT];
         VkPipelineShaderStageCreateInfo ShaderStages[ShaderTypes::COUNT];
 
-        std::vector<char> Sources[ShaderTypes::COUNT];
-        _ReadFile(Spec.Paths[VERTEX], Sources[VERTEX]);
-        _ReadFile(Spec.Paths[FRAGMENT], Sources[FRAGMENT]);
+        if (Spec.Shader)
+        {
+            ShaderModules[VERTEX] = _CreateShaderModule(Spec.device, Spec.Shader->GetSpirv(SHDAER_TYPE_VERTEX));
+            ShaderModules[FRAGMENT] = _CreateShaderModule(Spec.device, Spec.Shader->GetSpirv(SHDAER_TYPE_FRAGMENT));
+        }
+        else
+        {
+            std::vector<char> Sources[ShaderTypes::COUNT];
+            _ReadFile(Spec.Paths[VERTEX], Sources[VERTEX]);
+            _ReadFile(Spec.Paths[FRAGMENT], Sources[FRAGMENT]);
 
-        ShaderModules[VERTEX] = _CreateShaderModule(Spec.device, Sources[VERTEX]);
-        ShaderModules[FRAGMENT] = _CreateShaderModule(Spec.device, Sources[FRAGMENT]);
+            ShaderModules[VERTEX] = _CreateShaderModule(Spec.device, Sources[VERTEX]);
+            ShaderModules[FRAGMENT] = _CreateShaderModule(Spec.device, Sources[FRAGMENT]);
+        }
 
         ShaderStages[VERTEX] = _CreateShaderStages(ShaderModules[VERTEX], VK_SHADER_STAGE_VERTEX_BIT, "main");
         ShaderStages[FRAGMENT] = _CreateShaderStages(ShaderModules[FRAGMENT], VK_SHADER_STAGE_FRAGMENT_BIT, "main");
@@ -462,6 +655,8 @@ namespace VEngine
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipelineLayoutInfo.setLayoutCount = Spec.DescLayouts.size();
         pipelineLayoutInfo.pSetLayouts = Spec.DescLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = Spec.PushConstantRanges.size();
+        pipelineLayoutInfo.pPushConstantRanges = Spec.PushConstantRanges.data();
         VULKAN_SUCCESS_ASSERT(vkCreatePipelineLayout(Spec.device, &pipelineLayoutInfo, nullptr, &_PipelineLayout), "[VULKAN]: Pipeline Layout creation failed!");
 
         // 🆕 NEW: Add dynamic rendering structure
@@ -581,8 +776,21 @@ namespace VEngine
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
         pipelineInfo.basePipelineIndex = -1;
 
+        // Feedback tells whether the driver found the pipeline in the cache
+        VkPipelineCreationFeedback PipelineFeedback{};
+        VkPipelineCreationFeedbackCreateInfo feedbackInfo{};
+        feedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+        feedbackInfo.pPipelineCreationFeedback = &PipelineFeedback;
+        feedbackInfo.pipelineStageCreationFeedbackCount = 0;
+        renderingInfo.pNext = &feedbackInfo;
+
+        VkPipelineCache Cache = Spec.Cache ? Spec.Cache->GetHandle() : VK_NULL_HANDLE;
+
         // Create pipeline!
-        VULKAN_SUCCESS_ASSERT(vkCreateGraphicsPipelines(Spec.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_Pipeline), "Graphics pipeline Failed to create!");
+        VULKAN_SUCCESS_ASSERT(vkCreateGraphicsPipelines(Spec.device, Cache, 1, &pipelineInfo, nullptr, &_Pipeline), "Graphics pipeline Failed to create!");
+
+        if (Spec.Cache)
+            Spec.Cache->RecordFeedback(PipelineFeedback);
 
         // Cleanup shaders
         for (int i = 0; i < ShaderTypes::COUNT; i++)
@@ -595,6 +803,64 @@ namespace VEngine
         vkDestroyPipelineLayout(device, _PipelineLayout, nullptr);
     }
 
+    void VulkanGraphicsPipeline::Retire(VulkanDeletionQueue &Queue, uint64_t Value)
+    {
+        Queue.RetirePipeline(_Pipeline, Value);
+        Queue.RetirePipelineLayout(_PipelineLayout, Value);
+        _Pipeline = VK_NULL_HANDLE;
+        _PipelineLayout = VK_NULL_HANDLE;
+    }
+
+    void VulkanComputePipeline::Init(const VulkanComputePipelineSpec &Spec)
+    {
+        VkShaderModule ShaderModule = _CreateShaderModule(Spec.device, Spec.Shader->GetSpirv(SHDAER_TYPE_COMPUTE));
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = Spec.DescLayouts.size();
+        pipelineLayoutInfo.pSetLayouts = Spec.DescLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = Spec.PushConstantRanges.size();
+        pipelineLayoutInfo.pPushConstantRanges = Spec.PushConstantRanges.data();
+        VULKAN_SUCCESS_ASSERT(vkCreatePipelineLayout(Spec.device, &pipelineLayoutInfo, nullptr, &_PipelineLayout), "[VULKAN]: Pipeline Layout creation failed!");
+
+        VkPipelineCreationFeedback PipelineFeedback{};
+        VkPipelineCreationFeedbackCreateInfo feedbackInfo{};
+        feedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+        feedbackInfo.pPipelineCreationFeedback = &PipelineFeedback;
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.pNext = &feedbackInfo;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = ShaderModule;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = _PipelineLayout;
+        pipelineInfo.basePipelineIndex = -1;
+
+        VkPipelineCache Cache = Spec.Cache ? Spec.Cache->GetHandle() : VK_NULL_HANDLE;
+        VULKAN_SUCCESS_ASSERT(vkCreateComputePipelines(Spec.device, Cache, 1, &pipelineInfo, nullptr, &_Pipeline), "Compute pipeline Failed to create!");
+
+        if (Spec.Cache)
+            Spec.Cache->RecordFeedback(PipelineFeedback);
+
+        vkDestroyShaderModule(Spec.device, ShaderModule, nullptr);
+    }
+
+    void VulkanComputePipeline::Destroy(VkDevice device)
+    {
+        vkDestroyPipeline(device, _Pipeline, nullptr);
+        vkDestroyPipelineLayout(device, _PipelineLayout, nullptr);
+    }
+
+    void VulkanComputePipeline::Retire(VulkanDeletionQueue &Queue, uint64_t Value)
+    {
+        Queue.RetirePipeline(_Pipeline, Value);
+        Queue.RetirePipelineLayout(_PipelineLayout, Value);
+        _Pipeline = VK_NULL_HANDLE;
+        _PipelineLayout = VK_NULL_HANDLE;
+    }
+
     VulkanUniformBuffer::VulkanUniformBuffer(VmaAllocator Allocator, const UniformBufferDesc &desc)
     {
         _Size = desc.Size;
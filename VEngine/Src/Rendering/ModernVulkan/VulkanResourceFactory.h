@@ -4,6 +4,28 @@
 
 namespace VEngine
 {
+    class VulkanPipelineCache;
+    class VulkanShader;
+    class VulkanDeletionQueue;
+    class VulkanGeometryPool;
+    class VulkanUploadManager;
+
+    // Value on the upload timeline semaphore, resources recorded with this token are
+    // safe to read on the gpu once the timeline reaches it
+    using UploadToken = uint64_t;
+
+    // Elements of one mesh inside a pool buffer. First is in elements, so it goes straight into
+    // vertexOffset or firstIndex
+    struct VulkanGeometryRange
+    {
+        VkBuffer Buffer = VK_NULL_HANDLE;
+        uint32_t First = 0;
+        uint32_t Count = 0;
+        uint32_t Stride = 0;
+        uint32_t Pool = 0, Block = 0;
+        VmaVirtualAllocation Allocation = VK_NULL_HANDLE;
+    };
+
     struct SingleTimeCommandBuffer
     {
         VkCommandBuffer Cmd;
@@ -24,7 +46,11 @@ namespace VEngine
         Ref<IndexBuffer> CreateIndexBuffer(const IndexBufferDesc &desc) override;
         bool DeleteIndexBuffer(const Ref<IndexBuffer> &IB) override;
 
+        Ref<Texture> CreateTexture(const TextureDesc &desc) override;
+        bool DeleteTexture(const Ref<Texture> &Tex) override;
+
         void CopyBuffer(VkBuffer Src, VkBuffer Dst, VkDeviceSize Size, SingleTimeCommandBuffer &Spec);
+        bool IsUploadComplete(UploadToken Token);
 
         void BeginSingleTimeCommand(SingleTimeCommandBuffer &Spec);
         void EndSingleTimeCommand(SingleTimeCommandBuffer &Spec);
@@ -37,6 +63,20 @@ namespace VEngine
     {
     };
 
+    // Device local buffer the defragmenter may move, set as its allocation's user data
+    class VulkanMovableBuffer
+    {
+    public:
+        virtual ~VulkanMovableBuffer() {}
+
+        virtual VkBuffer GetHandle() = 0;
+        virtual VkBufferUsageFlags GetUsage() const = 0;
+        virtual VkDeviceSize GetBufferSize() const = 0;
+        virtual UploadToken GetUploadToken() const = 0;
+        // Buffer is bound to the allocation's new place and already has the data copied in
+        virtual void Relocate(VkBuffer Buffer) = 0;
+    };
+
     struct VulkanStageBufferSpec
     {
         uint32_t Size;
@@ -62,21 +102,38 @@ namespace VEngine
         VmaAllocationInfo _AllocatoinInfo;
     };
 
-    class VulkanVertexBuffer : public VertexBuffer
+    class VulkanVertexBuffer : public VertexBuffer, public VulkanMovableBuffer
     {
     public:
-        VulkanVertexBuffer(VmaAllocator Allocator, const VertexBufferDesc &desc);
-        ~VulkanVertexBuffer() {}
+        // Static data is uploaded through Uploads, which decides how the buffer is shared between queues
+        VulkanVertexBuffer(VmaAllocator Allocator, const VulkanUploadManager &Uploads, const VertexBufferDesc &desc);
+        // Static data sub-allocated from the geometry pool, the range is owned from here on
+        VulkanVertexBuffer(VulkanGeometryPool *Pool, const VulkanGeometryRange &Range, const VertexBufferDesc &desc);
+        ~VulkanVertexBuffer();
 
         virtual void UploadData(const void *data, uint32_t size) override;
         void Destroy(VmaAllocator Allocator);
-
-        VkBuffer GetHandle() { return _Buffer; }
+        // Destroyed once the gpu reaches Value on the frame timeline
+        void Retire(VulkanDeletionQueue &Queue, uint64_t Value);
+
+        VkBuffer GetHandle() override { return _Buffer; }
+        VkBufferUsageFlags GetUsage() const override { return _Usage; }
+        VkDeviceSize GetBufferSize() const override { return _Size; }
+        UploadToken GetUploadToken() const override { return _UploadToken; }
+        void SetUploadToken(UploadToken Token) { _UploadToken = Token; }
+        void Relocate(VkBuffer Buffer) override { _Buffer = Buffer; }
+        // First vertex in the buffer, only pooled buffers don't start at 0
+        uint32_t GetFirstVertex() const { return _Range.First; }
 
     private:
+        VmaAllocator _Allocator = VK_NULL_HANDLE;
         VkBuffer _Buffer;
-        VmaAllocation _Allocation;
+        VkBufferUsageFlags _Usage;
+        VmaAllocation _Allocation = nullptr;
         VmaAllocationInfo _AllocatoinInfo;
+        UploadToken _UploadToken = 0;
+        VulkanGeometryPool *_Pool = nullptr;
+        VulkanGeometryRange _Range;
     };
 
     struct UniformBufferDesc
@@ -102,21 +159,37 @@ namespace VEngine
         VmaAllocationInfo _AllocatoinInfo;
     };
 
-    class VulkanIndexBuffer : public IndexBuffer
+    class VulkanIndexBuffer : public IndexBuffer, public VulkanMovableBuffer
     {
     public:
-        VulkanIndexBuffer(VmaAllocator Allocator, const IndexBufferDesc &desc);
-        ~VulkanIndexBuffer() {}
+        VulkanIndexBuffer(VmaAllocator Allocator, const VulkanUploadManager &Uploads, const IndexBufferDesc &desc);
+        // Static data sub-allocated from the geometry pool, the range is owned from here on
+        VulkanIndexBuffer(VulkanGeometryPool *Pool, const VulkanGeometryRange &Range, const IndexBufferDesc &desc);
+        ~VulkanIndexBuffer();
 
         void UploadData(const void *data, uint32_t size) override;
         void Destroy(VmaAllocator Allocator);
-
-        VkBuffer GetHandle() { return _Buffer; }
+        // Destroyed once the gpu reaches Value on the frame timeline
+        void Retire(VulkanDeletionQueue &Queue, uint64_t Value);
+
+        VkBuffer GetHandle() override { return _Buffer; }
+        VkBufferUsageFlags GetUsage() const override { return _Usage; }
+        VkDeviceSize GetBufferSize() const override { return _Size; }
+        UploadToken GetUploadToken() const override { return _UploadToken; }
+        void SetUploadToken(UploadToken Token) { _UploadToken = Token; }
+        void Relocate(VkBuffer Buffer) override { _Buffer = Buffer; }
+        // First index in the buffer, only pooled buffers don't start at 0
+        uint32_t GetFirstIndex() const { return _Range.First; }
 
     private:
+        VmaAllocator _Allocator = VK_NULL_HANDLE;
         VkBuffer _Buffer;
-        VmaAllocation _Allocation;
+        VkBufferUsageFlags _Usage;
+        VmaAllocation _Allocation = nullptr;
         VmaAllocationInfo _AllocatoinInfo;
+        UploadToken _UploadToken = 0;
+        VulkanGeometryPool *_Pool = nullptr;
+        VulkanGeometryRange _Range;
     };
 
     enum class ShaderDataType
@@ -133,6 +206,15 @@ namespace VEngine
         UINT2,
         UINT3,
         UINT4,
+        // Packed, the shader reads all of these as floats
+        HALF2,
+        HALF4,
+        SNORM16_2,
+        SNORM16_4,
+        UNORM16_2,
+        UNORM16_4,
+        UNORM8_4,
+        SNORM8_4,
     };
 
     struct VulkanVertexAttribute
@@ -150,14 +232,18 @@ namespace VEngine
 
     struct VulkanGraphicsPipelineSpec
     {
+        // Precompiled SPIR-V files, only read when Shader is not set
         std::vector<const char *> Paths;
+        Ref<VulkanShader> Shader;
         std::vector<VulkanVertexAttribute> Attributes;
         VkDevice device;
         const char *Name;
         VkFormat SwapChainFormat;
         std::vector<VkDescriptorSetLayout> DescLayouts;
+        std::vector<VkPushConstantRange> PushConstantRanges;
         bool UseDepth = false;
         VkFormat DepthFormat;
+        VulkanPipelineCache *Cache = nullptr;
     };
 
     class VulkanGraphicsPipeline
@@ -168,6 +254,35 @@ namespace VEngine
 
         void Init(const VulkanGraphicsPipelineSpec &Spec);
         void Destroy(VkDevice device);
+        void Retire(VulkanDeletionQueue &Queue, uint64_t Value);
+
+        VkPipeline GetHandle() const { return _Pipeline; }
+        VkPipelineLayout GetLayout() const { return _PipelineLayout; }
+
+    private:
+        VkPipeline _Pipeline;
+        VkPipelineLayout _PipelineLayout;
+    };
+
+    struct VulkanComputePipelineSpec
+    {
+        Ref<VulkanShader> Shader;
+        VkDevice device;
+        const char *Name;
+        std::vector<VkDescriptorSetLayout> DescLayouts;
+        std::vector<VkPushConstantRange> PushConstantRanges;
+        VulkanPipelineCache *Cache = nullptr;
+    };
+
+    class VulkanComputePipeline
+    {
+    public:
+        VulkanComputePipeline() {}
+        ~VulkanComputePipeline() {}
+
+        void Init(const VulkanComputePipelineSpec &Spec);
+        void Destroy(VkDevice device);
+        void Retire(VulkanDeletionQueue &Queue, uint64_t Value);
 
         VkPipeline GetHandle() const { return _Pipeline; }
         VkPipelineLayout GetLayout() const { return _PipelineLayout; }
@@ -185,13 +300,10 @@ namespace VEngine
         VmaAllocation allocation;
         uint32_t width, height;
         VkFormat format;
-    };
-
-    struct VulkanTextureDescriptor
-    {
-        VkDescriptorSetLayout layout;
-        VkDescriptorPool pool;
-        std::vector<VkDescriptorSet> sets;
+        uint32_t MipLevels = 1;
+        UploadToken Upload = 0;
+        // Slot in the bindless table
+        uint32_t BindlessIndex = UINT32_MAX;
     };
 
 } // namespace VEngien
@@ -0,0 +1,290 @@
+#include "VeVPCH.h"
+
+#include <filesystem>
+#include <iomanip>
+#include <thread>
+#include <shaderc/shaderc.hpp>
+
+#include "VulkanShader.h"
+
+namespace VEngine
+{
+    // Bump when anything about how SPIR-V is produced changes so old cache entries stop matching
+    static const char *SHADER_CACHE_VERSION = "VEngineShaderCache-1";
+
+    static void HashBytes(uint64_t &Hash, const void *Data, size_t Size)
+    {
+        // FNV-1a
+        const uint8_t *Bytes = (const uint8_t *)Data;
+        for (size_t i = 0; i < Size; i++)
+        {
+            Hash ^= Bytes[i];
+            Hash *= 1099511628211ull;
+        }
+    }
+
+    static void HashString(uint64_t &Hash, const std::string &String)
+    {
+        HashBytes(Hash, String.data(), String.size());
+        // Separator so ("ab", "c") and ("a", "bc") hash differently
+        HashBytes(Hash, "\0", 1);
+    }
+
+    // Changes with the shaderc build, a newer compiler can produce different SPIR-V from the same source.
+    // A tiny shader is compiled once per run, its header carries glslang's generator version
+    static uint64_t GetCompilerFingerprint()
+    {
+        static const uint64_t Fingerprint = []()
+        {
+            uint64_t Hash = 14695981039346656037ull;
+            unsigned int Version = 0, Revision = 0;
+            shaderc_get_spv_version(&Version, &Revision);
+            HashBytes(Hash, &Version, sizeof(Version));
+            HashBytes(Hash, &Revision, sizeof(Revision));
+
+            shaderc::Compiler Compiler;
+            auto Result = Compiler.CompileGlslToSpv("#version 450\nvoid main() {}\n", shaderc_compute_shader, "fingerprint");
+            if (Result.GetCompilationStatus() == shaderc_compilation_status_success)
+                HashBytes(Hash, Result.cbegin(), (Result.cend() - Result.cbegin()) * sizeof(uint32_t));
+            return Hash;
+        }();
+        return Fingerprint;
+    }
+
+    static bool ReadText(const std::filesystem::path &Path, std::string &Text)
+    {
+        std::ifstream file(Path, std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        std::stringstream ss;
+        ss << file.rdbuf();
+        Text = ss.str();
+        return true;
+    }
+
+    // Adds every file reachable through #include "..." to the hash, starting at Path
+    static void HashIncludeClosure(uint64_t &Hash, const std::filesystem::path &Path, std::set<std::string> &Visited)
+    {
+        std::string Source;
+        if (!ReadText(Path, Source))
+            return;
+
+        std::istringstream Lines(Source);
+        std::string Line;
+        while (std::getline(Lines, Line))
+        {
+            auto Pos = Line.find("#include");
+            if (Pos == std::string::npos)
+                continue;
+
+            auto Begin = Line.find('"', Pos);
+            auto End = Begin == std::string::npos ? std::string::npos : Line.find('"', Begin + 1);
+            if (End == std::string::npos)
+                continue;
+
+            auto IncludePath = Path.parent_path() / Line.substr(Begin + 1, End - Begin - 1);
+            auto Key = IncludePath.lexically_normal().string();
+            if (!Visited.insert(Key).second)
+                continue;
+
+            std::string Included;
+            if (ReadText(IncludePath, Included))
+            {
+                HashString(Hash, Key);
+                HashString(Hash, Included);
+            }
+            HashIncludeClosure(Hash, IncludePath, Visited);
+        }
+    }
+
+    class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface
+    {
+    public:
+        struct IncludeData
+        {
+            shaderc_include_result Result;
+            std::string Name, Content;
+        };
+
+        shaderc_include_result *GetInclude(const char *RequestedSource, shaderc_include_type Type,
+                                           const char *RequestingSource, size_t IncludeDepth) override
+        {
+            auto *Data = new IncludeData();
+            auto Path = std::filesystem::path(RequestingSource).parent_path() / RequestedSource;
+            Data->Name = Path.lexically_normal().string();
+
+            // Empty name tells shaderc the include failed, content then holds the error
+            if (!ReadText(Path, Data->Content))
+            {
+                Data->Content = "Failed to open include " + Data->Name;
+                Data->Name.clear();
+            }
+
+            Data->Result.source_name = Data->Name.c_str();
+            Data->Result.source_name_length = Data->Name.size();
+            Data->Result.content = Data->Content.c_str();
+            Data->Result.content_length = Data->Content.size();
+            Data->Result.user_data = Data;
+            return &Data->Result;
+        }
+
+        void ReleaseInclude(shaderc_include_result *Result) override
+        {
+            delete (IncludeData *)Result->user_data;
+        }
+    };
+
+    static shaderc_shader_kind ShaderTypeToKind(ShaderType Type)
+    {
+        switch (Type)
+        {
+        case SHDAER_TYPE_VERTEX:
+            return shaderc_vertex_shader;
+        case SHDAER_TYPE_FRAGMENT:
+            return shaderc_fragment_shader;
+        case SHDAER_TYPE_COMPUTE:
+            return shaderc_compute_shader;
+        default:
+            throw std::invalid_argument("unsupported shader type!");
+        }
+    }
+
+    static std::vector<uint32_t> CompileStage(const ShaderSpec &Spec, const std::string &Path, const std::string &Source, ShaderType Type)
+    {
+        // Compiler per job, workers never share one
+        shaderc::Compiler Compiler;
+        shaderc::CompileOptions Options;
+        Options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+        Options.SetOptimizationLevel(Spec.Optimize ? shaderc_optimization_level_performance : shaderc_optimization_level_zero);
+        if (Spec.DebugInfo)
+            Options.SetGenerateDebugInfo();
+        for (auto &Define : Spec.Defines)
+            Options.AddMacroDefinition(Define.Name, Define.Value);
+        Options.SetIncluder(std::make_unique<ShaderIncluder>());
+
+        auto Result = Compiler.CompileGlslToSpv(Source, ShaderTypeToKind(Type), Path.c_str(), Options);
+        if (Result.GetCompilationStatus() != shaderc_compilation_status_success)
+            throw std::runtime_error("Shader compilation failed: " + Result.GetErrorMessage());
+
+        return std::vector<uint32_t>(Result.cbegin(), Result.cend());
+    }
+
+    static void WriteCacheEntry(const std::filesystem::path &Path, const std::vector<uint32_t> &Spirv)
+    {
+        std::error_code Error;
+        std::filesystem::create_directories(Path.parent_path(), Error);
+
+        // Several workers may produce the same entry, the rename keeps readers from seeing half a file
+        auto TempPath = Path;
+        TempPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream file(TempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+                return;
+            file.write((const char *)Spirv.data(), Spirv.size() * sizeof(uint32_t));
+        }
+        std::filesystem::rename(TempPath, Path, Error);
+        if (Error)
+            std::filesystem::remove(TempPath, Error);
+    }
+
+    static bool ReadCacheEntry(const std::filesystem::path &Path, std::vector<uint32_t> &Spirv)
+    {
+        std::ifstream file(Path, std::ios::ate | std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        size_t Size = (size_t)file.tellg();
+        if (Size == 0 || Size % sizeof(uint32_t) != 0)
+            return false;
+
+        Spirv.resize(Size / sizeof(uint32_t));
+        file.seekg(0);
+        file.read((char *)Spirv.data(), Size);
+        return (bool)file;
+    }
+
+    bool VulkanShader::Init(const ShaderSpec &Spec)
+    {
+        Prepare(Spec);
+        return Resolve();
+    }
+
+    void VulkanShader::Destroy()
+    {
+        for (int i = 0; i < SHDAER_TYPE_COUNT; i++)
+            _Spirv[i].clear();
+    }
+
+    void VulkanShader::Prepare(const ShaderSpec &Spec)
+    {
+        if (Spec.Paths.size() != Spec.UsingTypes.size())
+            throw std::invalid_argument("ShaderSpec needs one type for every path!");
+
+        for (int i = 0; i < Spec.Paths.size(); i++)
+        {
+            ShaderType Type = Spec.UsingTypes[i];
+            std::string Path = Spec.Paths[i];
+
+            std::string Source;
+            if (!ReadText(Path, Source))
+                throw std::runtime_error("failed to open shader " + Path);
+
+            // Key covers the compiler, source, include closure, defines and every compiler option
+            uint64_t Hash = 14695981039346656037ull;
+            HashString(Hash, SHADER_CACHE_VERSION);
+            uint64_t Compiler = GetCompilerFingerprint();
+            HashBytes(Hash, &Compiler, sizeof(Compiler));
+            HashBytes(Hash, &Type, sizeof(Type));
+            HashString(Hash, Source);
+            std::set<std::string> Visited;
+            HashIncludeClosure(Hash, Path, Visited);
+            for (auto &Define : Spec.Defines)
+            {
+                HashString(Hash, Define.Name);
+                HashString(Hash, Define.Value);
+            }
+            HashBytes(Hash, &Spec.Optimize, sizeof(Spec.Optimize));
+            HashBytes(Hash, &Spec.DebugInfo, sizeof(Spec.DebugInfo));
+
+            std::stringstream Key;
+            Key << std::hex << std::setw(16) << std::setfill('0') << Hash;
+            auto CachePath = std::filesystem::path(Spec.CacheDirectory) / (Key.str() + ".spv");
+
+            if (ReadCacheEntry(CachePath, _Spirv[Type]))
+            {
+                _CacheHits++;
+                continue;
+            }
+
+            // Miss, compile on a worker and store the result for next launch
+            _Pending[Type] = std::async(std::launch::async, [Spec, Path, Source, Type, CachePath]()
+                                        {
+                                            auto Spirv = CompileStage(Spec, Path, Source, Type);
+                                            WriteCacheEntry(CachePath, Spirv);
+                                            return Spirv; });
+        }
+    }
+
+    bool VulkanShader::Resolve()
+    {
+        bool Success = true;
+        for (int i = 0; i < SHDAER_TYPE_COUNT; i++)
+        {
+            if (!_Pending[i].valid())
+                continue;
+
+            try
+            {
+                _Spirv[i] = _Pending[i].get();
+            }
+            catch (const std::exception &e)
+            {
+                PRINTLN("[VULKAN]: " << e.what());
+                Success = false;
+            }
+        }
+        return Success;
+    }
+} // namespace VEngine
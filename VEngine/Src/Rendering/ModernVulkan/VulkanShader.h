@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Shaders.h"
+
+namespace VEngine
+{
+    // GLSL compiled with shaderc, SPIR-V is stored on disk under a hash of everything
+    // that affects the output so unchanged shaders are only read back
+    class VulkanShader : public Shader
+    {
+    public:
+        VulkanShader() {}
+        ~VulkanShader() {}
+
+        bool Init(const ShaderSpec &Spec) override;
+        void Destroy() override;
+
+        // Init split in two so many shaders can have their misses compiling at the same time
+        void Prepare(const ShaderSpec &Spec);
+        bool Resolve();
+
+        bool HasStage(ShaderType Type) const { return !_Spirv[Type].empty(); }
+        const std::vector<uint32_t> &GetSpirv(ShaderType Type) const { return _Spirv[Type]; }
+        uint32_t GetCacheHits() const { return _CacheHits; }
+
+    private:
+        std::vector<uint32_t> _Spirv[SHDAER_TYPE_COUNT];
+        std::future<std::vector<uint32_t>> _Pending[SHDAER_TYPE_COUNT];
+        uint32_t _CacheHits = 0;
+    };
+} // namespace VEngine
@@ -0,0 +1,97 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanStagingRing.h"
+
+namespace VEngine
+{
+    static VkDeviceSize AlignUp(VkDeviceSize Value, VkDeviceSize Alignment)
+    {
+        return (Value + Alignment - 1) / Alignment * Alignment;
+    }
+
+    void VulkanStagingRing::Init(const VulkanStagingRingSpec &Spec)
+    {
+        _Allocator = Spec.Allocator;
+        _Capacity = Spec.SizePerFrame * Spec.FrameCount;
+
+        VkBufferCreateInfo bufferInfo = {};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = _Capacity;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VmaAllocationCreateInfo allocInfo = {};
+        allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+        allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VULKAN_SUCCESS_ASSERT(vmaCreateBuffer(_Allocator, &bufferInfo, &allocInfo, &_Buffer, &_Allocation, &_AllocatoinInfo), "Staging Ring Failed!");
+        PRINTLN("[VULKAN]: Staging Ring Created: " << _Capacity / (1024 * 1024) << " MB");
+    }
+
+    void VulkanStagingRing::Destroy()
+    {
+        vmaDestroyBuffer(_Allocator, _Buffer, _Allocation);
+        _Regions.clear();
+    }
+
+    bool VulkanStagingRing::TryAllocate(VkDeviceSize Size, VkDeviceSize Alignment, UploadToken Token, VulkanStagingAllocation &Allocation)
+    {
+        if (Size > _Capacity)
+            return false;
+
+        if (_Regions.empty())
+            _Head = _Tail = 0;
+        else if (_Head == _Tail)
+            return false; // Full
+
+        VkDeviceSize Start = AlignUp(_Head, Alignment);
+
+        if (_Regions.empty() || _Head > _Tail)
+        {
+            // Free space is [Head, Capacity) and then [0, Tail) after wrapping
+            if (Start + Size > _Capacity)
+            {
+                if (!_Regions.empty() && Size > _Tail)
+                    return false;
+                Start = 0;
+            }
+        }
+        else if (Start + Size > _Tail)
+            return false;
+
+        _Regions.push_back({Start, Start + Size, Token});
+        _Head = Start + Size;
+        if (_Head == _Capacity && _Tail != 0)
+            _Head = 0;
+
+        Allocation.Buffer = _Buffer;
+        Allocation.Offset = Start;
+        Allocation.Mapped = (char *)_AllocatoinInfo.pMappedData + Start;
+        return true;
+    }
+
+    void VulkanStagingRing::Write(const VulkanStagingAllocation &Allocation, const void *Data, VkDeviceSize Size)
+    {
+        memcpy(Allocation.Mapped, Data, Size);
+        // No-op on coherent memory
+        vmaFlushAllocation(_Allocator, _Allocation, Allocation.Offset, Size);
+    }
+
+    void VulkanStagingRing::Reclaim(UploadToken Completed)
+    {
+        while (!_Regions.empty() && _Regions.front().Token <= Completed)
+            _Regions.pop_front();
+
+        if (_Regions.empty())
+            _Head = _Tail = 0;
+        else
+            _Tail = _Regions.front().Begin;
+    }
+} // namespace VEngine
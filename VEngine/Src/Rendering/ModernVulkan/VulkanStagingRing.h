@@ -0,0 +1,55 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanStagingRingSpec
+    {
+        VmaAllocator Allocator;
+        VkDeviceSize SizePerFrame = 32 * 1024 * 1024;
+        int FrameCount = 2;
+    };
+
+    struct VulkanStagingAllocation
+    {
+        VkBuffer Buffer = VK_NULL_HANDLE;
+        VkDeviceSize Offset = 0;
+        void *Mapped = nullptr;
+    };
+
+    // One persistently mapped upload buffer, regions are handed out in order and given
+    // back once the upload timeline passes the token they were recorded with
+    class VulkanStagingRing
+    {
+    public:
+        VulkanStagingRing() {}
+        ~VulkanStagingRing() {}
+
+        void Init(const VulkanStagingRingSpec &Spec);
+        void Destroy();
+
+        // Fails instead of blocking when the ring has no room, caller decides how to wait
+        bool TryAllocate(VkDeviceSize Size, VkDeviceSize Alignment, UploadToken Token, VulkanStagingAllocation &Allocation);
+        void Write(const VulkanStagingAllocation &Allocation, const void *Data, VkDeviceSize Size);
+        void Reclaim(UploadToken Completed);
+
+        bool Empty() const { return _Regions.empty(); }
+        UploadToken OldestToken() const { return _Regions.front().Token; }
+        VkDeviceSize GetCapacity() const { return _Capacity; }
+
+    private:
+        struct Region
+        {
+            VkDeviceSize Begin, End;
+            UploadToken Token;
+        };
+
+        VmaAllocator _Allocator;
+        VkBuffer _Buffer = VK_NULL_HANDLE;
+        VmaAllocation _Allocation;
+        VmaAllocationInfo _AllocatoinInfo;
+
+        VkDeviceSize _Capacity = 0;
+        VkDeviceSize _Head = 0, _Tail = 0;
+        std::deque<Region> _Regions;
+    };
+} // namespace VEngine
@@ -0,0 +1,292 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanTargetPool.h"
+
+namespace VEngine
+{
+    static constexpr VkImageUsageFlags ATTACHMENT_USAGE = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                                                          VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+
+    static VkDeviceSize AlignUp(VkDeviceSize Value, VkDeviceSize Alignment)
+    {
+        return (Value + Alignment - 1) / Alignment * Alignment;
+    }
+
+    void VulkanTargetPool::Init(const VulkanTargetPoolSpec &Spec)
+    {
+        _Spec = Spec;
+
+        VmaAllocationCreateInfo LazyInfo{};
+        LazyInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+        uint32_t TypeIndex;
+        _LazySupported = vmaFindMemoryTypeIndex(_Spec.Allocator, UINT32_MAX, &LazyInfo, &TypeIndex) == VK_SUCCESS;
+        PRINTLN("[VULKAN]: Target Pool Created, lazily allocated memory " << (_LazySupported ? "available" : "not available"));
+    }
+
+    void VulkanTargetPool::Destroy()
+    {
+        for (auto &image : _Images)
+        {
+            vkDestroyImageView(_Spec.device, image.View, nullptr);
+            vmaDestroyImage(_Spec.Allocator, image.Handle, image.Allocation);
+        }
+        _Images.clear();
+        if (_Heap)
+            vmaFreeMemory(_Spec.Allocator, _Heap);
+        _Heap = nullptr;
+        _HeapSize = 0;
+    }
+
+    VkImageAspectFlags VulkanTargetPool::GetAspect(VkFormat Format)
+    {
+        switch (Format)
+        {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return VK_IMAGE_ASPECT_COLOR_BIT;
+        }
+    }
+
+    bool VulkanTargetPool::_IsLazy(const VulkanTargetDesc &Desc)
+    {
+        return _LazySupported && _Spec.LazyMemory && !(Desc.Usage & ~ATTACHMENT_USAGE);
+    }
+
+    VkImageCreateInfo VulkanTargetPool::_GetImageInfo(const VulkanTargetDesc &Desc)
+    {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = {Desc.Extent.width, Desc.Extent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = Desc.Format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = Desc.Usage;
+        // Never leaves tile memory on the gpus that have it
+        if (_IsLazy(Desc))
+            imageInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.samples = Desc.Samples;
+        return imageInfo;
+    }
+
+    VkImageView VulkanTargetPool::_CreateView(VkImage Image, const VulkanTargetDesc &Desc)
+    {
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = Image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = Desc.Format;
+        viewInfo.subresourceRange = {GetAspect(Desc.Format), 0, 1, 0, 1};
+
+        VkImageView View;
+        VULKAN_SUCCESS_ASSERT(vkCreateImageView(_Spec.device, &viewInfo, nullptr, &View), "Target View Creation Failed!");
+        return View;
+    }
+
+    VulkanTargetPool::Image &VulkanTargetPool::_GetImage(const VulkanTargetDesc &Desc, VkDeviceSize Offset, bool Dedicated)
+    {
+        // A heap image can be handed out twice, only to targets that don't overlap and so share the memory anyway
+        for (auto &image : _Images)
+        {
+            if (!(image.Desc == Desc))
+                continue;
+            bool Match = Dedicated ? image.Allocation && !image.InUse : !image.Allocation && image.Offset == Offset;
+            if (!Match)
+                continue;
+            image.InUse = true;
+            image.LastUsed = _Frame;
+            return image;
+        }
+
+        Image image{};
+        image.Desc = Desc;
+        image.Offset = Offset;
+        image.InUse = true;
+        image.LastUsed = _Frame;
+
+        auto imageInfo = _GetImageInfo(Desc);
+        if (Dedicated)
+        {
+            VmaAllocationCreateInfo allocInfo{};
+            allocInfo.usage = _IsLazy(Desc) ? VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED : VMA_MEMORY_USAGE_AUTO;
+            allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            VULKAN_SUCCESS_ASSERT(vmaCreateImage(_Spec.Allocator, &imageInfo, &allocInfo, &image.Handle, &image.Allocation, nullptr),
+                                  "Target Image Creation Failed!");
+        }
+        else
+        {
+            VULKAN_SUCCESS_ASSERT(vkCreateImage(_Spec.device, &imageInfo, nullptr, &image.Handle), "Target Image Creation Failed!");
+            VULKAN_SUCCESS_ASSERT(vmaBindImageMemory2(_Spec.Allocator, _Heap, Offset, image.Handle, nullptr), "Target Image Bind Failed!");
+        }
+        image.View = _CreateView(image.Handle, Desc);
+
+        _Images.push_back(image);
+        return _Images.back();
+    }
+
+    void VulkanTargetPool::_Retire(Image &image, uint64_t Value)
+    {
+        _Spec.DeletionQueue->RetireImageView(image.View, Value);
+        // Heap images have no allocation of their own, only the image goes
+        _Spec.DeletionQueue->RetireImage(image.Handle, image.Allocation, Value);
+    }
+
+    void VulkanTargetPool::_ResizeHeap(VkDeviceSize Size, VkDeviceSize Alignment, uint32_t TypeBits, uint64_t Value)
+    {
+        bool Fits = Size == 0 || (_Heap && Size <= _HeapSize && Alignment <= _HeapAlignment && (TypeBits & (1u << _HeapMemoryType)));
+        if (Fits && Size * 2 > _HeapSize)
+            _HeapPeakFrame = _Frame;
+        // Only shrinks once a smaller frame has been the norm for a while
+        bool Shrink = Fits && _Heap && _Frame - _HeapPeakFrame > _Spec.KeepFrames;
+        if (Fits && !Shrink)
+            return;
+
+        _FreeHeap(Value);
+        if (Size == 0)
+            return;
+
+        VkMemoryRequirements Requirements{};
+        Requirements.size = Size;
+        Requirements.alignment = Alignment;
+        Requirements.memoryTypeBits = TypeBits;
+
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        VmaAllocationInfo Info;
+        VULKAN_SUCCESS_ASSERT(vmaAllocateMemory(_Spec.Allocator, &Requirements, &allocInfo, &_Heap, &Info), "Target Heap Allocation Failed!");
+
+        _HeapSize = Size;
+        _HeapAlignment = Alignment;
+        _HeapMemoryType = Info.memoryType;
+        _HeapPeakFrame = _Frame;
+        PRINTLN("[VULKAN]: Target heap is now " << Size / 1024 << " KB");
+    }
+
+    void VulkanTargetPool::_FreeHeap(uint64_t Value)
+    {
+        // Every heap image is bound to the old memory, they all go with it
+        for (size_t i = _Images.size(); i-- > 0;)
+        {
+            if (_Images[i].Allocation)
+                continue;
+            _Retire(_Images[i], Value);
+            _Images.erase(_Images.begin() + i);
+        }
+        if (_Heap)
+        {
+            VmaAllocator Allocator = _Spec.Allocator;
+            VmaAllocation Heap = _Heap;
+            _Spec.DeletionQueue->Retire([Allocator, Heap]()
+                                        { vmaFreeMemory(Allocator, Heap); }, Value);
+        }
+        _Heap = nullptr;
+        _HeapSize = 0;
+    }
+
+    void VulkanTargetPool::Allocate(std::vector<VulkanTransientTarget> &Targets, uint64_t FrameValue)
+    {
+        _Frame++;
+        for (auto &image : _Images)
+            image.InUse = false;
+
+        _Placements.clear();
+        _UnaliasedBytes = 0;
+        VkDeviceSize Alignment = 1;
+        uint32_t TypeBits = UINT32_MAX;
+        std::vector<uint32_t> Dedicated;
+
+        for (uint32_t i = 0; i < (uint32_t)Targets.size(); i++)
+        {
+            auto imageInfo = _GetImageInfo(Targets[i].Desc);
+            VkDeviceImageMemoryRequirements Info{};
+            Info.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS;
+            Info.pCreateInfo = &imageInfo;
+            VkMemoryRequirements2 Requirements{};
+            Requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+            vkGetDeviceImageMemoryRequirements(_Spec.device, &Info, &Requirements);
+            auto &Req = Requirements.memoryRequirements;
+            _UnaliasedBytes += Req.size;
+
+            // Lazy ones have memory of their own, so do ones whose memory types the heap can't share
+            if (_IsLazy(Targets[i].Desc) || !(TypeBits & Req.memoryTypeBits))
+            {
+                Dedicated.push_back(i);
+                continue;
+            }
+            TypeBits &= Req.memoryTypeBits;
+            Alignment = std::max(Alignment, Req.alignment);
+            _Placements.push_back({i, Req, 0});
+        }
+
+        // Biggest first, each at the lowest offset no overlapping target placed before it covers
+        std::sort(_Placements.begin(), _Placements.end(), [](const Placement &a, const Placement &b)
+                  { return a.Requirements.size > b.Requirements.size; });
+        VkDeviceSize Size = 0;
+        for (size_t p = 0; p < _Placements.size(); p++)
+        {
+            auto &Current = _Placements[p];
+            auto &Target = Targets[Current.Target];
+            VkDeviceSize Offset = 0;
+            bool Moved = true;
+            while (Moved)
+            {
+                Moved = false;
+                for (size_t q = 0; q < p; q++)
+                {
+                    auto &Placed = _Placements[q];
+                    auto &Other = Targets[Placed.Target];
+                    bool Lifetimes = Target.First <= Other.Last && Other.First <= Target.Last;
+                    bool Memory = Offset < Placed.Offset + Placed.Requirements.size && Placed.Offset < Offset + Current.Requirements.size;
+                    if (Lifetimes && Memory)
+                    {
+                        Offset = AlignUp(Placed.Offset + Placed.Requirements.size, Current.Requirements.alignment);
+                        Moved = true;
+                    }
+                }
+            }
+            Current.Offset = Offset;
+            Size = std::max(Size, Offset + Current.Requirements.size);
+        }
+        _ResizeHeap(Size, Alignment, TypeBits, FrameValue);
+
+        for (auto &Current : _Placements)
+        {
+            auto &image = _GetImage(Targets[Current.Target].Desc, Current.Offset, false);
+            Targets[Current.Target].Image = image.Handle;
+            Targets[Current.Target].View = image.View;
+        }
+        for (auto i : Dedicated)
+        {
+            auto &image = _GetImage(Targets[i].Desc, 0, true);
+            Targets[i].Image = image.Handle;
+            Targets[i].View = image.View;
+        }
+
+        // Old extents stay around for a while, a resize back picks them up again
+        for (size_t i = _Images.size(); i-- > 0;)
+        {
+            if (_Images[i].InUse || _Frame - _Images[i].LastUsed <= _Spec.KeepFrames)
+                continue;
+            _Retire(_Images[i], FrameValue);
+            _Images.erase(_Images.begin() + i);
+        }
+    }
+} // namespace VEngine
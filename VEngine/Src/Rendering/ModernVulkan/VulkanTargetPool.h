@@ -0,0 +1,111 @@
+#pragma once
+
+namespace VEngine
+{
+    class VulkanDeletionQueue;
+
+    struct VulkanTargetPoolSpec
+    {
+        VkDevice device;
+        VmaAllocator Allocator;
+        VulkanDeletionQueue *DeletionQueue;
+        // Frames an unused image or a too big heap is kept before it goes, so a resize back and forth reuses them
+        uint32_t KeepFrames = 120;
+        // Attachment only targets go into lazily allocated memory when the device has it
+        bool LazyMemory = true;
+    };
+
+    struct VulkanTargetDesc
+    {
+        VkFormat Format;
+        VkExtent2D Extent;
+        VkImageUsageFlags Usage;
+        VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+
+        bool operator==(const VulkanTargetDesc &Other) const
+        {
+            return Format == Other.Format && Extent.width == Other.Extent.width && Extent.height == Other.Extent.height &&
+                   Usage == Other.Usage && Samples == Other.Samples;
+        }
+    };
+
+    // One target of a frame, First and Last are the passes it lives through in recording order
+    struct VulkanTransientTarget
+    {
+        VulkanTargetDesc Desc;
+        uint32_t First;
+        uint32_t Last;
+
+        VkImage Image = VK_NULL_HANDLE;
+        VkImageView View = VK_NULL_HANDLE;
+    };
+
+    // Images for the render graph's transient targets, the contents never outlive a frame.
+    // Targets whose passes don't overlap are placed into the same memory of one shared heap,
+    // every (desc, offset) keeps its image so an unchanged frame creates nothing. Attachment only
+    // targets get lazily allocated memory of their own instead where the device offers it.
+    // Images and heap space left unused for KeepFrames frames are given back
+    class VulkanTargetPool
+    {
+    public:
+        VulkanTargetPool() {}
+        ~VulkanTargetPool() {}
+
+        void Init(const VulkanTargetPoolSpec &Spec);
+        // Only once the device is idle
+        void Destroy();
+
+        // Places one frame's targets, the images stay valid until the next Allocate
+        void Allocate(std::vector<VulkanTransientTarget> &Targets, uint64_t FrameValue);
+
+        static VkImageAspectFlags GetAspect(VkFormat Format);
+
+        VkDeviceSize GetHeapSize() const { return _HeapSize; }
+        // What the frame's targets would take without aliasing
+        VkDeviceSize GetUnaliasedBytes() const { return _UnaliasedBytes; }
+
+    private:
+        struct Image
+        {
+            VulkanTargetDesc Desc;
+            // In the heap, dedicated images have their own allocation
+            VkDeviceSize Offset;
+            VkImage Handle;
+            VkImageView View;
+            VmaAllocation Allocation;
+            uint64_t LastUsed;
+            bool InUse;
+        };
+
+        struct Placement
+        {
+            uint32_t Target;
+            VkMemoryRequirements Requirements;
+            VkDeviceSize Offset;
+        };
+
+        bool _IsLazy(const VulkanTargetDesc &Desc);
+        VkImageCreateInfo _GetImageInfo(const VulkanTargetDesc &Desc);
+        VkImageView _CreateView(VkImage Image, const VulkanTargetDesc &Desc);
+        Image &_GetImage(const VulkanTargetDesc &Desc, VkDeviceSize Offset, bool Dedicated);
+        void _Retire(Image &image, uint64_t Value);
+        void _ResizeHeap(VkDeviceSize Size, VkDeviceSize Alignment, uint32_t TypeBits, uint64_t Value);
+        void _FreeHeap(uint64_t Value);
+
+    private:
+        VulkanTargetPoolSpec _Spec;
+        bool _LazySupported = false;
+        uint64_t _Frame = 0;
+
+        VmaAllocation _Heap = nullptr;
+        VkDeviceSize _HeapSize = 0;
+        VkDeviceSize _HeapAlignment = 0;
+        uint32_t _HeapMemoryType = 0;
+        // Frame the heap was last needed at its full size
+        uint64_t _HeapPeakFrame = 0;
+
+        std::vector<Image> _Images;
+        std::vector<Placement> _Placements;
+        VkDeviceSize _UnaliasedBytes = 0;
+    };
+} // namespace VEngine
@@ -0,0 +1,373 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanTextureLoader.h"
+
+namespace VEngine
+{
+    // Every mip starts on this, covers the 16 byte blocks of BC2/3/5/6/7 and ASTC
+    static const VkDeviceSize MIP_ALIGNMENT = 16;
+
+    static VkDeviceSize AlignUp(VkDeviceSize Value, VkDeviceSize Alignment)
+    {
+        return (Value + Alignment - 1) / Alignment * Alignment;
+    }
+
+    static bool ReadFile(const std::string &Path, std::vector<char> &Bytes)
+    {
+        std::ifstream file(Path, std::ios::ate | std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        size_t Size = (size_t)file.tellg();
+        Bytes.resize(Size);
+        file.seekg(0);
+        file.read(Bytes.data(), Size);
+        return true;
+    }
+
+    template <typename T>
+    static T ReadAt(const std::vector<char> &Bytes, size_t Offset)
+    {
+        T Value;
+        memcpy(&Value, Bytes.data() + Offset, sizeof(T));
+        return Value;
+    }
+
+    static void AddMip(VulkanTextureFile &File, const char *Src, VkDeviceSize Size)
+    {
+        VkDeviceSize Offset = AlignUp(File.Data.size(), MIP_ALIGNMENT);
+        File.Data.resize(Offset + Size);
+        memcpy(File.Data.data() + Offset, Src, Size);
+        File.MipOffsets.push_back(Offset);
+    }
+
+    // Bytes and edge of one texel block, false for formats the loaders don't know
+    static bool GetFormatBlock(VkFormat Format, uint32_t &Bytes, uint32_t &Block)
+    {
+        Bytes = 0;
+        Block = 1;
+        switch (Format)
+        {
+        case VK_FORMAT_R8_UNORM:
+        case VK_FORMAT_R8_SRGB:
+            Bytes = 1;
+            break;
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_R8G8_SRGB:
+            Bytes = 2;
+            break;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+        case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32_SFLOAT:
+            Bytes = 4;
+            break;
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            Bytes = 8;
+            break;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            Bytes = 16;
+            break;
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC4_SNORM_BLOCK:
+            Bytes = 8;
+            Block = 4;
+            break;
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC5_SNORM_BLOCK:
+        case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+        case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+        case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+            Bytes = 16;
+            Block = 4;
+            break;
+        default:
+            return false;
+        }
+        return true;
+    }
+
+    VkDeviceSize GetMipSize(VkFormat Format, uint32_t Width, uint32_t Height)
+    {
+        uint32_t Bytes, Block;
+        if (!GetFormatBlock(Format, Bytes, Block))
+            return 0;
+        return (VkDeviceSize)((Width + Block - 1) / Block) * ((Height + Block - 1) / Block) * Bytes;
+    }
+
+    uint32_t GetBlockExtent(VkFormat Format)
+    {
+        uint32_t Bytes, Block;
+        GetFormatBlock(Format, Bytes, Block);
+        return Block;
+    }
+
+    std::vector<VkBufferImageCopy> VulkanTextureFile::GetCopyRegions() const
+    {
+        std::vector<VkBufferImageCopy> Regions;
+        for (uint32_t i = 0; i < MipLevels; i++)
+        {
+            VkBufferImageCopy region{};
+            region.bufferOffset = MipOffsets[i];
+            // Tightly packed, for block formats that is whole blocks
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = i;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {0, 0, 0};
+            region.imageExtent = {std::max(Width >> i, 1u), std::max(Height >> i, 1u), 1};
+            Regions.push_back(region);
+        }
+        return Regions;
+    }
+
+    uint32_t GetFullMipCount(uint32_t Width, uint32_t Height)
+    {
+        uint32_t Count = 1;
+        for (uint32_t Size = std::max(Width, Height); Size > 1; Size >>= 1)
+            Count++;
+        return Count;
+    }
+
+    bool LoadTextureFile(const std::string &Path, VulkanTextureFile &File)
+    {
+        auto EndsWith = [&](const char *Ext)
+        {
+            size_t Len = strlen(Ext);
+            return Path.size() >= Len && Path.compare(Path.size() - Len, Len, Ext) == 0;
+        };
+
+        if (EndsWith(".ktx2"))
+            return LoadKtx2Texture(Path, File);
+        if (EndsWith(".dds"))
+            return LoadDdsTexture(Path, File);
+        return false;
+    }
+
+    bool LoadKtx2Texture(const std::string &Path, VulkanTextureFile &File)
+    {
+        static const unsigned char Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+        // Identifier, 9 header words, then the dfd/kvd/sgd index
+        static const size_t LEVEL_INDEX_OFFSET = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+
+        std::vector<char> Bytes;
+        if (!ReadFile(Path, Bytes))
+            return false;
+
+        if (Bytes.size() < LEVEL_INDEX_OFFSET || memcmp(Bytes.data(), Identifier, sizeof(Identifier)) != 0)
+        {
+            PRINTLN("[VULKAN]: Not a KTX2 file: " << Path);
+            return false;
+        }
+
+        uint32_t Format = ReadAt<uint32_t>(Bytes, 12);
+        uint32_t Width = ReadAt<uint32_t>(Bytes, 20);
+        uint32_t Height = ReadAt<uint32_t>(Bytes, 24);
+        uint32_t Depth = ReadAt<uint32_t>(Bytes, 28);
+        uint32_t Layers = ReadAt<uint32_t>(Bytes, 32);
+        uint32_t Faces = ReadAt<uint32_t>(Bytes, 36);
+        uint32_t Levels = ReadAt<uint32_t>(Bytes, 40);
+        uint32_t Supercompression = ReadAt<uint32_t>(Bytes, 44);
+
+        // Basis universal ends up as VK_FORMAT_UNDEFINED and needs a transcoder
+        if (Format == VK_FORMAT_UNDEFINED || Supercompression != 0)
+        {
+            PRINTLN("[VULKAN]: Supercompressed KTX2 is not supported: " << Path);
+            return false;
+        }
+        if (Depth > 1 || Layers > 1 || Faces != 1 || Height == 0)
+        {
+            PRINTLN("[VULKAN]: Only plain 2D KTX2 textures are supported: " << Path);
+            return false;
+        }
+
+        // 0 asks the loader to generate the mips, the file only carries the base then
+        uint32_t StoredLevels = std::max(Levels, 1u);
+        if (StoredLevels > GetFullMipCount(Width, Height) || Bytes.size() < LEVEL_INDEX_OFFSET + (size_t)StoredLevels * 24)
+        {
+            PRINTLN("[VULKAN]: Bad KTX2 level index: " << Path);
+            return false;
+        }
+        if (GetMipSize((VkFormat)Format, Width, Height) == 0)
+        {
+            PRINTLN("[VULKAN]: Unsupported KTX2 format " << Format << ": " << Path);
+            return false;
+        }
+
+        File = VulkanTextureFile{};
+        File.Format = (VkFormat)Format;
+        File.Width = Width;
+        File.Height = Height;
+        File.MipLevels = StoredLevels;
+        File.GenerateMips = Levels == 0;
+
+        for (uint32_t i = 0; i < StoredLevels; i++)
+        {
+            uint64_t Offset = ReadAt<uint64_t>(Bytes, LEVEL_INDEX_OFFSET + i * 24);
+            uint64_t Length = ReadAt<uint64_t>(Bytes, LEVEL_INDEX_OFFSET + i * 24 + 8);
+            // Without supercompression a level is exactly its one image, anything else would copy past it
+            VkDeviceSize Size = GetMipSize(File.Format, std::max(Width >> i, 1u), std::max(Height >> i, 1u));
+            if (Offset > Bytes.size() || Length > Bytes.size() - Offset || Length != Size)
+            {
+                PRINTLN("[VULKAN]: Truncated or malformed KTX2 level " << i << ": " << Path);
+                return false;
+            }
+            AddMip(File, Bytes.data() + Offset, Size);
+        }
+        return true;
+    }
+
+    static uint32_t MakeFourCC(char a, char b, char c, char d)
+    {
+        return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+    }
+
+    static VkFormat DxgiToVulkan(uint32_t Dxgi)
+    {
+        switch (Dxgi)
+        {
+        case 28:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+        case 29:
+            return VK_FORMAT_R8G8B8A8_SRGB;
+        case 71:
+            return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case 72:
+            return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+        case 74:
+            return VK_FORMAT_BC2_UNORM_BLOCK;
+        case 75:
+            return VK_FORMAT_BC2_SRGB_BLOCK;
+        case 77:
+            return VK_FORMAT_BC3_UNORM_BLOCK;
+        case 78:
+            return VK_FORMAT_BC3_SRGB_BLOCK;
+        case 80:
+            return VK_FORMAT_BC4_UNORM_BLOCK;
+        case 81:
+            return VK_FORMAT_BC4_SNORM_BLOCK;
+        case 83:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case 84:
+            return VK_FORMAT_BC5_SNORM_BLOCK;
+        case 87:
+            return VK_FORMAT_B8G8R8A8_UNORM;
+        case 91:
+            return VK_FORMAT_B8G8R8A8_SRGB;
+        case 95:
+            return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+        case 96:
+            return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+        case 98:
+            return VK_FORMAT_BC7_UNORM_BLOCK;
+        case 99:
+            return VK_FORMAT_BC7_SRGB_BLOCK;
+        default:
+            return VK_FORMAT_UNDEFINED;
+        }
+    }
+
+    bool LoadDdsTexture(const std::string &Path, VulkanTextureFile &File)
+    {
+        // Magic, then the 124 byte header with the pixel format at 76
+        static const size_t HEADER_SIZE = 4 + 124;
+
+        std::vector<char> Bytes;
+        if (!ReadFile(Path, Bytes))
+            return false;
+
+        if (Bytes.size() < HEADER_SIZE || ReadAt<uint32_t>(Bytes, 0) != MakeFourCC('D', 'D', 'S', ' '))
+        {
+            PRINTLN("[VULKAN]: Not a DDS file: " << Path);
+            return false;
+        }
+
+        uint32_t Height = ReadAt<uint32_t>(Bytes, 12);
+        uint32_t Width = ReadAt<uint32_t>(Bytes, 16);
+        uint32_t MipCount = ReadAt<uint32_t>(Bytes, 28);
+        uint32_t FourCC = ReadAt<uint32_t>(Bytes, 84);
+
+        size_t DataOffset = HEADER_SIZE;
+        VkFormat Format = VK_FORMAT_UNDEFINED;
+        if (FourCC == MakeFourCC('D', 'X', '1', '0'))
+        {
+            if (Bytes.size() < HEADER_SIZE + 20)
+                return false;
+            Format = DxgiToVulkan(ReadAt<uint32_t>(Bytes, HEADER_SIZE));
+            // Resource dimension 3 is TEXTURE2D, array size has to be 1
+            if (ReadAt<uint32_t>(Bytes, HEADER_SIZE + 4) != 3 || ReadAt<uint32_t>(Bytes, HEADER_SIZE + 12) > 1)
+            {
+                PRINTLN("[VULKAN]: Only plain 2D DDS textures are supported: " << Path);
+                return false;
+            }
+            DataOffset += 20;
+        }
+        // Legacy headers carry no color space, they only ever hold color textures here
+        else if (FourCC == MakeFourCC('D', 'X', 'T', '1'))
+            Format = VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+        else if (FourCC == MakeFourCC('D', 'X', 'T', '3'))
+            Format = VK_FORMAT_BC2_SRGB_BLOCK;
+        else if (FourCC == MakeFourCC('D', 'X', 'T', '5'))
+            Format = VK_FORMAT_BC3_SRGB_BLOCK;
+        else if (FourCC == MakeFourCC('A', 'T', 'I', '1') || FourCC == MakeFourCC('B', 'C', '4', 'U'))
+            Format = VK_FORMAT_BC4_UNORM_BLOCK;
+        else if (FourCC == MakeFourCC('A', 'T', 'I', '2') || FourCC == MakeFourCC('B', 'C', '5', 'U'))
+            Format = VK_FORMAT_BC5_UNORM_BLOCK;
+
+        if (Format == VK_FORMAT_UNDEFINED || Width == 0 || Height == 0)
+        {
+            PRINTLN("[VULKAN]: Unsupported DDS format: " << Path);
+            return false;
+        }
+        // More levels than the image can have would overshift the mip sizes below
+        if (MipCount > GetFullMipCount(Width, Height))
+        {
+            PRINTLN("[VULKAN]: DDS file has more mips than its size allows: " << Path);
+            return false;
+        }
+
+        File = VulkanTextureFile{};
+        File.Format = Format;
+        File.Width = Width;
+        File.Height = Height;
+        File.MipLevels = std::max(MipCount, 1u);
+
+        for (uint32_t i = 0; i < File.MipLevels; i++)
+        {
+            VkDeviceSize Size = GetMipSize(Format, std::max(Width >> i, 1u), std::max(Height >> i, 1u));
+            if (DataOffset + Size > Bytes.size())
+            {
+                PRINTLN("[VULKAN]: Truncated DDS file: " << Path);
+                return false;
+            }
+            AddMip(File, Bytes.data() + DataOffset, Size);
+            DataOffset += Size;
+        }
+        return true;
+    }
+} // namespace VEngine
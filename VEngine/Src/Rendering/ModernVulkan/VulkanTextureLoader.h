@@ -0,0 +1,32 @@
+#pragma once
+
+namespace VEngine
+{
+    // A texture as it sits in a container file, every mip is tightly packed one after the other
+    struct VulkanTextureFile
+    {
+        VkFormat Format = VK_FORMAT_UNDEFINED;
+        uint32_t Width = 0, Height = 0;
+        uint32_t MipLevels = 0;
+        // Only the base level is stored, the file asks for the rest to be generated
+        bool GenerateMips = false;
+        std::vector<char> Data;
+        // Where each mip starts in Data, mip 0 is the biggest
+        std::vector<VkDeviceSize> MipOffsets;
+
+        // One copy per mip, offsets relative to the start of Data
+        std::vector<VkBufferImageCopy> GetCopyRegions() const;
+    };
+
+    // KTX2 without supercompression and DDS (legacy DXTn and DX10 headers), 2D only. Picked by extension
+    bool LoadTextureFile(const std::string &Path, VulkanTextureFile &File);
+    bool LoadKtx2Texture(const std::string &Path, VulkanTextureFile &File);
+    bool LoadDdsTexture(const std::string &Path, VulkanTextureFile &File);
+
+    // Bytes of one tightly packed Width x Height image, 0 for formats the loaders don't know
+    VkDeviceSize GetMipSize(VkFormat Format, uint32_t Width, uint32_t Height);
+    // Width and height of a texel block, 4 for the block compressed formats
+    uint32_t GetBlockExtent(VkFormat Format);
+    // floor(log2(max(Width, Height))) + 1
+    uint32_t GetFullMipCount(uint32_t Width, uint32_t Height);
+} // namespace VEngine
@@ -0,0 +1,491 @@
+#include "VeVPCH.h"
+
+#include <cfloat>
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanDevice.h"
+#include "VulkanResourceFactory.h"
+#include "VulkanStagingRing.h"
+#include "VulkanUploadManager.h"
+#include "VulkanBindlessTable.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanTextureLoader.h"
+#include "VulkanTextureStreamer.h"
+#include "VulkanUtils.h"
+
+namespace VEngine
+{
+    void VulkanTextureStreamer::Init(const VulkanTextureStreamerSpec &Spec)
+    {
+        _Spec = Spec;
+        _Spec.ThreadCount = std::max(_Spec.ThreadCount, 1u);
+        _Budget = _QueryBudget();
+
+        for (uint32_t i = 0; i < _Spec.ThreadCount; i++)
+            _Workers.emplace_back(&VulkanTextureStreamer::_WorkerLoop, this);
+
+        PRINTLN("[VULKAN]: Texture Streamer Created with " << _Budget / (1024 * 1024) << " MB budget and " << _Spec.ThreadCount << " threads");
+    }
+
+    void VulkanTextureStreamer::Destroy()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            _Quit = true;
+            _Queue.clear();
+            _Finished.clear();
+        }
+        _Wake.notify_all();
+        for (auto &Worker : _Workers)
+            Worker.join();
+        _Workers.clear();
+
+        for (auto &Tex : _Textures)
+        {
+            if (Tex->_Image == VK_NULL_HANDLE)
+                continue;
+            vkDestroyImageView(_Spec.device, Tex->_View, nullptr);
+            vmaDestroyImage(_Spec.Allocator, Tex->_Image, Tex->_Allocation);
+            _Spec.Bindless->Release(Tex->_BindlessIndex);
+        }
+        _Textures.clear();
+        _ResidentBytes = 0;
+    }
+
+    Ref<VulkanStreamedTexture> VulkanTextureStreamer::Create(const TextureDesc &desc)
+    {
+        auto Tex = std::make_shared<VulkanStreamedTexture>(desc);
+        Tex->_BindlessIndex = _Spec.FallbackIndex;
+        // Queued with the next Update, ahead of everything that already has mips
+        _Textures.push_back(Tex);
+        return Tex;
+    }
+
+    void VulkanTextureStreamer::Release(const Ref<VulkanStreamedTexture> &Tex, uint64_t FrameValue)
+    {
+        {
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            // A load already running is dropped when it comes back
+            Tex->_Released = true;
+            _Queue.erase(std::remove(_Queue.begin(), _Queue.end(), Tex), _Queue.end());
+        }
+        _Textures.erase(std::remove(_Textures.begin(), _Textures.end(), Tex), _Textures.end());
+        _Retire(*Tex, FrameValue);
+    }
+
+    void VulkanTextureStreamer::Touch(VulkanStreamedTexture &Tex, float ScreenSize, float Distance, uint64_t FrameValue)
+    {
+        // Biggest and closest draw of the frame decides
+        if (Tex._LastUsedFrame != FrameValue)
+        {
+            Tex._ScreenSize = 0.0f;
+            Tex._Distance = FLT_MAX;
+            Tex._LastUsedFrame = FrameValue;
+        }
+        Tex._ScreenSize = std::max(Tex._ScreenSize, ScreenSize);
+        Tex._Distance = std::min(Tex._Distance, Distance);
+    }
+
+    uint32_t VulkanTextureStreamer::GetPendingLoads()
+    {
+        std::lock_guard<std::mutex> Lock(_Mutex);
+        return (uint32_t)(_Queue.size() + _Finished.size()) + _Loading;
+    }
+
+    void VulkanTextureStreamer::_WorkerLoop()
+    {
+        while (true)
+        {
+            Ref<VulkanStreamedTexture> Tex;
+            {
+                std::unique_lock<std::mutex> Lock(_Mutex);
+                _Wake.wait(Lock, [&]
+                           { return _Quit || !_Queue.empty(); });
+                if (_Quit)
+                    return;
+                Tex = _Queue.back();
+                _Queue.pop_back();
+                Tex->_State = VulkanStreamedTexture::LoadState::LOADING;
+                _Loading++;
+            }
+
+            LoadResult Result;
+            Result.Tex = Tex;
+            Result.Success = LoadTextureFile(Tex->_Path, Result.File);
+
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            _Finished.push_back(std::move(Result));
+            _Loading--;
+        }
+    }
+
+    VkDeviceSize VulkanTextureStreamer::_QueryBudget()
+    {
+        if (_Spec.Budget)
+            return _Spec.Budget;
+
+        VmaBudget Budgets[VK_MAX_MEMORY_HEAPS];
+        vmaGetHeapBudgets(_Spec.Allocator, Budgets);
+        const VkPhysicalDeviceMemoryProperties *Props;
+        vmaGetMemoryProperties(_Spec.Allocator, &Props);
+
+        VkDeviceSize Budget = 0, Usage = 0;
+        for (uint32_t i = 0; i < Props->memoryHeapCount; i++)
+        {
+            if (!(Props->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+                continue;
+            Budget += Budgets[i].budget;
+            Usage += Budgets[i].usage;
+        }
+
+        // Whatever else lives in vram, other processes included, comes off the top
+        VkDeviceSize Others = Usage > _ResidentBytes ? Usage - _ResidentBytes : 0;
+        VkDeviceSize Left = Budget > Others ? Budget - Others : 0;
+        return std::min((VkDeviceSize)(Budget * _Spec.BudgetHeapShare), Left);
+    }
+
+    VkDeviceSize VulkanTextureStreamer::_EstimateBytes(const VulkanStreamedTexture &Tex, uint32_t Mip)
+    {
+        VkDeviceSize Bytes = 0;
+        for (uint32_t i = Mip; i < Tex._MipBytes.size(); i++)
+            Bytes += Tex._MipBytes[i];
+        return Bytes;
+    }
+
+    uint32_t VulkanTextureStreamer::_WantedMipFor(const VulkanStreamedTexture &Tex)
+    {
+        if (Tex._ScreenSize <= 0.0f)
+            return Tex._FloorMip;
+
+        // One texel per pixel the draw covers
+        float Ratio = (float)std::max(Tex._Width, Tex._Height) / Tex._ScreenSize;
+        uint32_t Mip = Ratio > 1.0f ? (uint32_t)std::floor(std::log2(Ratio)) : 0;
+        return std::min(Mip, Tex._FloorMip);
+    }
+
+    void VulkanTextureStreamer::Update(VkCommandBuffer Cmd, uint64_t FrameValue)
+    {
+        _Budget = _QueryBudget();
+
+        std::deque<LoadResult> Finished;
+        {
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            Finished.swap(_Finished);
+        }
+
+        VkDeviceSize Uploaded = 0;
+        while (!Finished.empty())
+        {
+            auto &Result = Finished.front();
+            if (!_Commit(Cmd, Result, FrameValue, Uploaded))
+                break;
+            Finished.pop_front();
+        }
+
+        // Over the per frame upload limit, the rest goes first next frame
+        if (!Finished.empty())
+        {
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            while (!Finished.empty())
+            {
+                _Finished.push_front(std::move(Finished.back()));
+                Finished.pop_back();
+            }
+        }
+
+        // Budget can shrink under us when something else takes vram
+        _MakeRoom(Cmd, 0, nullptr, FrameValue);
+
+        std::vector<Ref<VulkanStreamedTexture>> Queue;
+        {
+            std::lock_guard<std::mutex> Lock(_Mutex);
+            for (auto &Tex : _Textures)
+            {
+                auto State = Tex->_State.load();
+                if (State == VulkanStreamedTexture::LoadState::LOADING || State == VulkanStreamedTexture::LoadState::FAILED)
+                    continue;
+                Tex->_State = VulkanStreamedTexture::LoadState::IDLE;
+
+                // Never read, the first load brings its small mips
+                if (Tex->_MipLevels == 0)
+                {
+                    Queue.push_back(Tex);
+                    continue;
+                }
+
+                // Only what was drawn last frame asks for more
+                if (Tex->_LastUsedFrame + 1 < FrameValue)
+                    continue;
+                Tex->_WantedMip = _WantedMipFor(*Tex);
+                if (Tex->_WantedMip >= Tex->_ResidentMip)
+                    continue;
+                Tex->_TargetMip = Tex->_WantedMip;
+                Queue.push_back(Tex);
+            }
+
+            // Workers take from the back, unread textures first then biggest on screen then closest
+            std::sort(Queue.begin(), Queue.end(), [](const Ref<VulkanStreamedTexture> &a, const Ref<VulkanStreamedTexture> &b)
+                      {
+                          if ((a->_MipLevels == 0) != (b->_MipLevels == 0))
+                              return a->_MipLevels != 0;
+                          if (a->_ScreenSize != b->_ScreenSize)
+                              return a->_ScreenSize < b->_ScreenSize;
+                          return a->_Distance > b->_Distance; });
+
+            for (auto &Tex : Queue)
+                Tex->_State = VulkanStreamedTexture::LoadState::QUEUED;
+            _Queue.swap(Queue);
+        }
+        _Wake.notify_all();
+    }
+
+    bool VulkanTextureStreamer::_Commit(VkCommandBuffer Cmd, LoadResult &Result, uint64_t FrameValue, VkDeviceSize &Uploaded)
+    {
+        auto &Tex = *Result.Tex;
+        auto &File = Result.File;
+        if (Tex._Released)
+            return true;
+
+        if (!Result.Success || File.MipLevels == 0)
+        {
+            PRINTLN("[VULKAN]: Failed to stream " << Tex._Path);
+            Tex._State = VulkanStreamedTexture::LoadState::FAILED;
+            return true;
+        }
+
+        bool FirstLoad = Tex._MipLevels == 0;
+        if (FirstLoad)
+        {
+            auto props = VulkanUtils::GetPhysicalDeviceFormatProperties(*_Spec.PhysicalDevice, File.Format);
+            VkFormatFeatureFlags Features = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+            if ((props.optimalTilingFeatures & Features) != Features)
+            {
+                PRINTLN("[VULKAN]: Device can't sample " << Tex._Path);
+                Tex._State = VulkanStreamedTexture::LoadState::FAILED;
+                return true;
+            }
+
+            Tex._Width = File.Width;
+            Tex._Height = File.Height;
+            Tex._MipLevels = File.MipLevels;
+            Tex._Format = File.Format;
+            Tex._ResidentMip = Tex._MipLevels;
+            Tex._FloorMip = Tex._MipLevels - 1;
+            while (Tex._FloorMip > 0 && std::max(File.Width >> (Tex._FloorMip - 1), File.Height >> (Tex._FloorMip - 1)) <= _Spec.MinResidentSize)
+                Tex._FloorMip--;
+            for (uint32_t i = 0; i < File.MipLevels; i++)
+            {
+                VkDeviceSize End = i + 1 < File.MipLevels ? File.MipOffsets[i + 1] : File.Data.size();
+                Tex._MipBytes.push_back(End - File.MipOffsets[i]);
+            }
+            Tex._TargetMip = Tex._FloorMip;
+        }
+
+        uint32_t Mip = Tex._TargetMip;
+        if (Mip >= Tex._ResidentMip)
+        {
+            Tex._State = VulkanStreamedTexture::LoadState::IDLE;
+            return true;
+        }
+
+        VkDeviceSize Size = File.Data.size() - File.MipOffsets[Mip];
+        if (Uploaded > 0 && Uploaded + Size > _Spec.MaxUploadPerFrame)
+            return false;
+
+        // Small mips always go in, anything more only as far as the budget allows
+        VkDeviceSize Current = Tex._Bytes;
+        _MakeRoom(Cmd, _EstimateBytes(Tex, Mip) - std::min(Current, _EstimateBytes(Tex, Mip)), &Tex, FrameValue);
+        while (!FirstLoad && Mip < Tex._ResidentMip && _ResidentBytes - Current + _EstimateBytes(Tex, Mip) > _Budget)
+            Mip++;
+        if (Mip >= Tex._ResidentMip)
+        {
+            Tex._State = VulkanStreamedTexture::LoadState::IDLE;
+            return true;
+        }
+
+        VkImage Image;
+        VmaAllocation Allocation;
+        _CreateImage(Tex, Mip, Image, Allocation);
+
+        // Mips from Mip down in one staging region, rebased onto the new image's levels
+        VkDeviceSize Base = File.MipOffsets[Mip];
+        std::vector<VkBufferImageCopy> Regions;
+        for (auto &region : File.GetCopyRegions())
+        {
+            if (region.imageSubresource.mipLevel < Mip)
+                continue;
+            Regions.push_back(region);
+            Regions.back().bufferOffset -= Base;
+            Regions.back().imageSubresource.mipLevel -= Mip;
+        }
+        Size = File.Data.size() - Base;
+        _Spec.Uploads->UploadImage(Image, File.Format, File.Data.data() + Base, Size, Regions, Tex._MipLevels - Mip);
+        Uploaded += Size;
+
+        _Replace(Tex, Image, Allocation, Mip, FrameValue);
+        Tex._State = VulkanStreamedTexture::LoadState::IDLE;
+        return true;
+    }
+
+    void VulkanTextureStreamer::_MakeRoom(VkCommandBuffer Cmd, VkDeviceSize Bytes, const VulkanStreamedTexture *Keep, uint64_t FrameValue)
+    {
+        while (_ResidentBytes + Bytes > _Budget)
+        {
+            // Least recently drawn first, a load only pushes out textures that matter less than it
+            VulkanStreamedTexture *Victim = nullptr;
+            for (auto &Tex : _Textures)
+            {
+                if (Tex.get() == Keep || Tex->_Image == VK_NULL_HANDLE || Tex->_ResidentMip >= Tex->_FloorMip)
+                    continue;
+                if (Keep && (Tex->_LastUsedFrame > Keep->_LastUsedFrame ||
+                             (Tex->_LastUsedFrame == Keep->_LastUsedFrame && Tex->_ScreenSize >= Keep->_ScreenSize)))
+                    continue;
+                if (!Victim || Tex->_LastUsedFrame < Victim->_LastUsedFrame ||
+                    (Tex->_LastUsedFrame == Victim->_LastUsedFrame && Tex->_ScreenSize < Victim->_ScreenSize))
+                    Victim = Tex.get();
+            }
+            if (!Victim)
+                return;
+
+            // Down to what its draws still want, at least one mip
+            uint32_t Mip = std::max(Victim->_ResidentMip + 1, std::min(_WantedMipFor(*Victim), Victim->_FloorMip));
+            _Shrink(Cmd, *Victim, Mip, FrameValue);
+        }
+    }
+
+    void VulkanTextureStreamer::_Shrink(VkCommandBuffer Cmd, VulkanStreamedTexture &Tex, uint32_t Mip, uint64_t FrameValue)
+    {
+        VkImage Image;
+        VmaAllocation Allocation;
+        _CreateImage(Tex, Mip, Image, Allocation);
+        uint32_t Levels = Tex._MipLevels - Mip;
+
+        VkImageMemoryBarrier barriers[2]{};
+        for (auto &barrier : barriers)
+        {
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
+            barrier.subresourceRange.baseMipLevel = 0;
+        }
+        // Old image is only read from here on, frames still sampling it are done before the copy
+        barriers[0].image = Tex._Image;
+        barriers[0].subresourceRange.levelCount = Tex._MipLevels - Tex._ResidentMip;
+        barriers[0].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barriers[0].srcAccessMask = 0;
+        barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barriers[1].image = Image;
+        barriers[1].subresourceRange.levelCount = Levels;
+        barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[1].srcAccessMask = 0;
+        barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(Cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 2, barriers);
+
+        std::vector<VkImageCopy> Copies(Levels);
+        for (uint32_t i = 0; i < Levels; i++)
+        {
+            auto &copy = Copies[i];
+            copy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            copy.srcSubresource.mipLevel = Mip - Tex._ResidentMip + i;
+            copy.srcSubresource.baseArrayLayer = 0;
+            copy.srcSubresource.layerCount = 1;
+            copy.dstSubresource = copy.srcSubresource;
+            copy.dstSubresource.mipLevel = i;
+            copy.extent = {std::max(Tex._Width >> (Mip + i), 1u), std::max(Tex._Height >> (Mip + i), 1u), 1};
+        }
+        vkCmdCopyImage(Cmd, Tex._Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, Levels, Copies.data());
+
+        barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(Cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barriers[1]);
+
+        _Replace(Tex, Image, Allocation, Mip, FrameValue);
+    }
+
+    void VulkanTextureStreamer::_CreateImage(VulkanStreamedTexture &Tex, uint32_t Mip, VkImage &Image, VmaAllocation &Allocation)
+    {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = {std::max(Tex._Width >> Mip, 1u), std::max(Tex._Height >> Mip, 1u), 1};
+        imageInfo.mipLevels = Tex._MipLevels - Mip;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = Tex._Format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        // Source too, an eviction copies the mips that stay into a smaller image
+        imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        _Spec.Uploads->SetSharing(imageInfo);
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+        VULKAN_SUCCESS_ASSERT(vmaCreateImage(_Spec.Allocator, &imageInfo, &allocInfo, &Image, &Allocation, nullptr), "Streamed Texture Image Failed!");
+    }
+
+    void VulkanTextureStreamer::_Replace(VulkanStreamedTexture &Tex, VkImage Image, VmaAllocation Allocation, uint32_t Mip, uint64_t FrameValue)
+    {
+        _Retire(Tex, FrameValue);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = Image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = Tex._Format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = Tex._MipLevels - Mip;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+        VULKAN_SUCCESS_ASSERT(vkCreateImageView(_Spec.device, &viewInfo, nullptr, &Tex._View), "Streamed Texture View Failed!");
+
+        VmaAllocationInfo Info;
+        vmaGetAllocationInfo(_Spec.Allocator, Allocation, &Info);
+
+        Tex._Image = Image;
+        Tex._Allocation = Allocation;
+        Tex._Bytes = Info.size;
+        Tex._ResidentMip = Mip;
+        // New slot, the old one may still be read by frames in flight
+        Tex._BindlessIndex = _Spec.Bindless->Register(Tex._View, _Spec.Sampler);
+        _ResidentBytes += Tex._Bytes;
+    }
+
+    void VulkanTextureStreamer::_Retire(VulkanStreamedTexture &Tex, uint64_t FrameValue)
+    {
+        if (Tex._Image == VK_NULL_HANDLE)
+            return;
+
+        auto Bindless = _Spec.Bindless;
+        uint32_t Index = Tex._BindlessIndex;
+        _Spec.DeletionQueue->RetireImageView(Tex._View, FrameValue);
+        _Spec.DeletionQueue->RetireImage(Tex._Image, Tex._Allocation, FrameValue);
+        _Spec.DeletionQueue->Retire([Bindless, Index]()
+                                    { Bindless->Release(Index); },
+                                    FrameValue);
+
+        _ResidentBytes -= Tex._Bytes;
+        Tex._Image = VK_NULL_HANDLE;
+        Tex._View = VK_NULL_HANDLE;
+        Tex._Allocation = VK_NULL_HANDLE;
+        Tex._Bytes = 0;
+        Tex._ResidentMip = Tex._MipLevels;
+        Tex._BindlessIndex = _Spec.FallbackIndex;
+    }
+} // namespace VEngine
@@ -0,0 +1,140 @@
+#pragma once
+
+namespace VEngine
+{
+    class VulkanUploadManager;
+    class VulkanBindlessTable;
+    class VulkanDeletionQueue;
+
+    struct VulkanTextureStreamerSpec
+    {
+        VkDevice device;
+        VulkanPhysicalDevice *PhysicalDevice;
+        VmaAllocator Allocator;
+        VulkanUploadManager *Uploads;
+        VulkanBindlessTable *Bindless;
+        VulkanDeletionQueue *DeletionQueue;
+        VkSampler Sampler;
+        // Slot draws use while a texture has nothing resident
+        uint32_t FallbackIndex;
+        // Bytes resident mips may take, 0 takes BudgetHeapShare of what vma reports for the device local heaps
+        VkDeviceSize Budget = 0;
+        float BudgetHeapShare = 0.5f;
+        // Mips this size and smaller are loaded first and never evicted
+        uint32_t MinResidentSize = 64;
+        // Upload bytes committed per frame, more waits for the next one so no frame stalls on a burst
+        VkDeviceSize MaxUploadPerFrame = 16 * 1024 * 1024;
+        uint32_t ThreadCount = 2;
+    };
+
+    class VulkanStreamedTexture : public Texture
+    {
+    public:
+        VulkanStreamedTexture(const TextureDesc &desc) : _Path(desc.Path) {}
+        ~VulkanStreamedTexture() {}
+
+        uint32_t GetBindlessIndex() const { return _BindlessIndex; }
+
+    private:
+        friend class VulkanTextureStreamer;
+
+        enum class LoadState
+        {
+            IDLE,
+            QUEUED,
+            LOADING,
+            FAILED
+        };
+
+        std::string _Path;
+        VkFormat _Format = VK_FORMAT_UNDEFINED;
+        uint32_t _BindlessIndex = UINT32_MAX;
+
+        VkImage _Image = VK_NULL_HANDLE;
+        VkImageView _View = VK_NULL_HANDLE;
+        VmaAllocation _Allocation = VK_NULL_HANDLE;
+        VkDeviceSize _Bytes = 0;
+        // Biggest mip on the gpu, _MipLevels while nothing is
+        uint32_t _ResidentMip = 0;
+        // Smallest mip still at or under MinResidentSize, never evicted past
+        uint32_t _FloorMip = 0;
+        std::vector<VkDeviceSize> _MipBytes;
+        bool _Released = false;
+
+        // Written by the frame's draws
+        uint32_t _WantedMip = 0;
+        float _ScreenSize = 0.0f;
+        float _Distance = 0.0f;
+        uint64_t _LastUsedFrame = 0;
+
+        std::atomic<LoadState> _State{LoadState::IDLE};
+        // Mip the queued load is for
+        uint32_t _TargetMip = 0;
+    };
+
+    // Streams texture mips in on worker threads and keeps what is resident under a memory budget.
+    // A texture first gets its small mips, then whatever its largest on screen draw needs. Every
+    // residency change builds a new image with its own bindless slot, frames in flight keep the old
+    // one until the frame timeline passes them. Everything but the workers runs on the render thread
+    class VulkanTextureStreamer
+    {
+    public:
+        VulkanTextureStreamer() {}
+        ~VulkanTextureStreamer() {}
+
+        void Init(const VulkanTextureStreamerSpec &Spec);
+        // Only once the device is idle
+        void Destroy();
+
+        Ref<VulkanStreamedTexture> Create(const TextureDesc &desc);
+        void Release(const Ref<VulkanStreamedTexture> &Tex, uint64_t FrameValue);
+
+        // A draw of Tex covering ScreenSize pixels at Distance from the camera
+        void Touch(VulkanStreamedTexture &Tex, float ScreenSize, float Distance, uint64_t FrameValue);
+
+        // At the start of a frame. Commits finished loads, evicts over budget and queues what
+        // is still missing. Evictions copy the mips kept on the gpu and are recorded into Cmd
+        void Update(VkCommandBuffer Cmd, uint64_t FrameValue);
+
+        VkDeviceSize GetResidentBytes() const { return _ResidentBytes; }
+        VkDeviceSize GetBudget() const { return _Budget; }
+        uint32_t GetPendingLoads();
+
+    private:
+        struct LoadResult
+        {
+            Ref<VulkanStreamedTexture> Tex;
+            VulkanTextureFile File;
+            bool Success;
+        };
+
+        void _WorkerLoop();
+        VkDeviceSize _QueryBudget();
+        VkDeviceSize _EstimateBytes(const VulkanStreamedTexture &Tex, uint32_t Mip);
+        uint32_t _WantedMipFor(const VulkanStreamedTexture &Tex);
+        // False when the frame's upload limit is reached, Result is tried again next frame
+        bool _Commit(VkCommandBuffer Cmd, LoadResult &Result, uint64_t FrameValue, VkDeviceSize &Uploaded);
+        // Evicts least recently used mips till Bytes more fit, never from Keep
+        void _MakeRoom(VkCommandBuffer Cmd, VkDeviceSize Bytes, const VulkanStreamedTexture *Keep, uint64_t FrameValue);
+        void _Shrink(VkCommandBuffer Cmd, VulkanStreamedTexture &Tex, uint32_t Mip, uint64_t FrameValue);
+        // Swaps in a new image and hands the old one to the deletion queue
+        void _Replace(VulkanStreamedTexture &Tex, VkImage Image, VmaAllocation Allocation, uint32_t Mip, uint64_t FrameValue);
+        void _Retire(VulkanStreamedTexture &Tex, uint64_t FrameValue);
+        void _CreateImage(VulkanStreamedTexture &Tex, uint32_t Mip, VkImage &Image, VmaAllocation &Allocation);
+
+    private:
+        VulkanTextureStreamerSpec _Spec;
+        std::vector<Ref<VulkanStreamedTexture>> _Textures;
+        VkDeviceSize _ResidentBytes = 0;
+        VkDeviceSize _Budget = 0;
+
+        std::vector<std::thread> _Workers;
+        std::mutex _Mutex;
+        std::condition_variable _Wake;
+        bool _Quit = false;
+        // Highest priority last, rebuilt every Update
+        std::vector<Ref<VulkanStreamedTexture>> _Queue;
+        std::deque<LoadResult> _Finished;
+        uint32_t _Loading = 0;
+    };
+} // namespace VEngine
@@ -0,0 +1,378 @@
+#include "VeVPCH.h"
+
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#include "vulkan/vulkan.h"
+
+#include "vk_mem_alloc.h"
+#include "VulkanRenderApi.h"
+#include "VulkanStagingRing.h"
+#include "VulkanUploadManager.h"
+#include "VulkanTextureLoader.h"
+
+namespace VEngine
+{
+    void VulkanUploadManager::Init(const VulkanUploadManagerSpec &Spec)
+    {
+        _Spec = Spec;
+        _Families = {_Spec.QueueFamily};
+        if (_Spec.GraphicsFamily != _Spec.QueueFamily)
+            _Families.push_back(_Spec.GraphicsFamily);
+
+        VkSemaphoreTypeCreateInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        timelineInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &timelineInfo;
+
+        VULKAN_SUCCESS_ASSERT(vkCreateSemaphore(_Spec.device, &semaphoreInfo, nullptr, &_Timeline), "Upload Timeline Semaphore Failed!");
+
+        VulkanStagingRingSpec RingSpec{};
+        RingSpec.Allocator = _Spec.Allocator;
+        RingSpec.SizePerFrame = _Spec.StagingSizePerFrame;
+        RingSpec.FrameCount = _Spec.FrameCount;
+        _Ring.Init(RingSpec);
+        _ChunkSize = _Ring.GetCapacity() / 4;
+        PRINTLN("[VULKAN]: Upload Manager Created!!");
+    }
+
+    void VulkanUploadManager::Destroy()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_Mutex);
+            if (_IsRecording)
+                _FlushLocked();
+        }
+        Wait(_LastSubmitted);
+
+        _Reclaim();
+
+        if (!_FreeCommandBuffers.empty())
+            vkFreeCommandBuffers(_Spec.device, _Spec.CommandPool, _FreeCommandBuffers.size(), _FreeCommandBuffers.data());
+        _FreeCommandBuffers.clear();
+
+        _Ring.Destroy();
+        vkDestroySemaphore(_Spec.device, _Timeline, nullptr);
+    }
+
+    void VulkanUploadManager::SetSharing(VkBufferCreateInfo &Info) const
+    {
+        Info.sharingMode = GetSharingMode();
+        Info.queueFamilyIndexCount = Info.sharingMode == VK_SHARING_MODE_CONCURRENT ? (uint32_t)_Families.size() : 0;
+        Info.pQueueFamilyIndices = Info.queueFamilyIndexCount ? _Families.data() : nullptr;
+    }
+
+    void VulkanUploadManager::SetSharing(VkImageCreateInfo &Info) const
+    {
+        Info.sharingMode = GetSharingMode();
+        Info.queueFamilyIndexCount = Info.sharingMode == VK_SHARING_MODE_CONCURRENT ? (uint32_t)_Families.size() : 0;
+        Info.pQueueFamilyIndices = Info.queueFamilyIndexCount ? _Families.data() : nullptr;
+    }
+
+    UploadToken VulkanUploadManager::UploadBuffer(VkBuffer Dst, const void *Data, VkDeviceSize Size, VkDeviceSize DstOffset)
+    {
+        std::lock_guard<std::mutex> lock(_Mutex);
+
+        // Big uploads are streamed through the ring in chunks instead of one giant staging allocation
+        UploadToken Token = 0;
+        VkDeviceSize Offset = 0;
+        while (Offset < Size)
+        {
+            if (!_IsRecording)
+                _BeginBatch();
+
+            VkDeviceSize Chunk = std::min(Size - Offset, _ChunkSize);
+            VulkanStagingAllocation Staging = _AllocateStaging(Chunk);
+            _Ring.Write(Staging, (const char *)Data + Offset, Chunk);
+
+            VkBufferCopy copyRegion{};
+            copyRegion.srcOffset = Staging.Offset;
+            copyRegion.dstOffset = DstOffset + Offset;
+            copyRegion.size = Chunk;
+            vkCmdCopyBuffer(_Recording.Cmd, Staging.Buffer, Dst, 1, &copyRegion);
+
+            _Recording.Size += Chunk;
+            Offset += Chunk;
+
+            Token = _Recording.Token;
+            if (_Recording.Size >= _Spec.MaxBatchSize)
+                _FlushLocked();
+        }
+
+        return Token;
+    }
+
+    UploadToken VulkanUploadManager::UploadImage(VkImage Dst, VkFormat Format, const void *Data, VkDeviceSize Size, const std::vector<VkBufferImageCopy> &Regions, uint32_t MipLevels)
+    {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        if (!_IsRecording)
+            _BeginBatch();
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = Dst;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = MipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(_Recording.Cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        if (Size <= _ChunkSize)
+        {
+            // Whole image fits, one staging region and one copy for every mip
+            VulkanStagingAllocation Staging = _AllocateStaging(Size);
+            _Ring.Write(Staging, Data, Size);
+
+            std::vector<VkBufferImageCopy> Copies = Regions;
+            for (auto &copy : Copies)
+                copy.bufferOffset += Staging.Offset;
+
+            vkCmdCopyBufferToImage(_Recording.Cmd, Staging.Buffer, Dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, Copies.size(), Copies.data());
+            _Recording.Size += Size;
+        }
+        else
+        {
+            // Stream region by region, a region's bytes run up to the next region's offset
+            std::vector<VkDeviceSize> Offsets;
+            for (auto &region : Regions)
+                Offsets.push_back(region.bufferOffset);
+            Offsets.push_back(Size);
+            std::sort(Offsets.begin(), Offsets.end());
+
+            uint32_t Block = GetBlockExtent(Format);
+            for (auto &region : Regions)
+            {
+                VkDeviceSize RegionSize = *std::upper_bound(Offsets.begin(), Offsets.end(), region.bufferOffset) - region.bufferOffset;
+                const char *Src = (const char *)Data + region.bufferOffset;
+                if (RegionSize <= _ChunkSize)
+                {
+                    _StageImageCopy(Dst, Src, RegionSize, region);
+                    continue;
+                }
+
+                uint32_t RowLength = region.bufferRowLength ? region.bufferRowLength : region.imageExtent.width;
+                uint32_t ImageHeight = region.bufferImageHeight ? region.bufferImageHeight : region.imageExtent.height;
+                VkDeviceSize RowPitch = GetMipSize(Format, RowLength, Block);
+                VkDeviceSize LayerPitch = GetMipSize(Format, RowLength, ImageHeight);
+                if (RowPitch == 0)
+                    throw std::runtime_error("Can't split an image upload of an unknown format!");
+                uint32_t Rows = (region.imageExtent.height + Block - 1) / Block;
+                uint32_t Layers = region.imageSubresource.layerCount;
+
+                if (LayerPitch <= _ChunkSize)
+                {
+                    // Whole layers at a time, the last one only up to its last row
+                    uint32_t LayersPerChunk = (uint32_t)(_ChunkSize / LayerPitch);
+                    for (uint32_t Layer = 0; Layer < Layers; Layer += LayersPerChunk)
+                    {
+                        uint32_t Count = std::min(LayersPerChunk, Layers - Layer);
+                        VkBufferImageCopy copy = region;
+                        copy.imageSubresource.baseArrayLayer += Layer;
+                        copy.imageSubresource.layerCount = Count;
+                        _StageImageCopy(Dst, Src + Layer * LayerPitch, (Count - 1) * LayerPitch + Rows * RowPitch, copy);
+                    }
+                    continue;
+                }
+
+                // A single layer is too big, it goes in bands of block rows
+                uint32_t RowsPerChunk = (uint32_t)std::max<VkDeviceSize>(_ChunkSize / RowPitch, 1);
+                for (uint32_t Layer = 0; Layer < Layers; Layer++)
+                {
+                    for (uint32_t Row = 0; Row < Rows; Row += RowsPerChunk)
+                    {
+                        uint32_t Count = std::min(RowsPerChunk, Rows - Row);
+                        VkBufferImageCopy copy = region;
+                        copy.bufferImageHeight = 0;
+                        copy.imageSubresource.baseArrayLayer += Layer;
+                        copy.imageSubresource.layerCount = 1;
+                        copy.imageOffset.y += Row * Block;
+                        copy.imageExtent.height = std::min(Count * Block, region.imageExtent.height - Row * Block);
+                        _StageImageCopy(Dst, Src + Layer * LayerPitch + Row * RowPitch, Count * RowPitch, copy);
+                    }
+                }
+            }
+        }
+
+        // Transfer queue can't name shader stages. The timeline signal makes the writes available and the graphics
+        // side's wait on it makes them visible, the image is concurrent so no ownership changes hands
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+
+        vkCmdPipelineBarrier(_Recording.Cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        UploadToken Token = _Recording.Token;
+        if (_Recording.Size >= _Spec.MaxBatchSize)
+            _FlushLocked();
+
+        return Token;
+    }
+
+    UploadToken VulkanUploadManager::Flush()
+    {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        if (!_IsRecording)
+            return _LastSubmitted;
+
+        return _FlushLocked();
+    }
+
+    bool VulkanUploadManager::IsComplete(UploadToken Token)
+    {
+        uint64_t Value = 0;
+        vkGetSemaphoreCounterValue(_Spec.device, _Timeline, &Value);
+        return Value >= Token;
+    }
+
+    void VulkanUploadManager::Wait(UploadToken Token)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_Mutex);
+            // Waiting on the batch that is still open would never return
+            if (_IsRecording && Token >= _Recording.Token)
+                _FlushLocked();
+        }
+
+        _WaitLocked(Token);
+    }
+
+    void VulkanUploadManager::_WaitLocked(UploadToken Token)
+    {
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &_Timeline;
+        waitInfo.pValues = &Token;
+
+        vkWaitSemaphores(_Spec.device, &waitInfo, UINT64_MAX);
+    }
+
+    VulkanStagingAllocation VulkanUploadManager::_AllocateStaging(VkDeviceSize Size)
+    {
+        VulkanStagingAllocation Allocation{};
+        while (!_Ring.TryAllocate(Size, _Spec.CopyAlignment, _Recording.Token, Allocation))
+        {
+            if (_Ring.Empty())
+                throw std::runtime_error("Staging allocation bigger than the staging ring!");
+
+            // Only reached when uploads outrun the gpu by a whole ring
+            if (_Ring.OldestToken() >= _Recording.Token)
+            {
+                // Everything in the ring belongs to the open batch, get it moving first
+                _FlushLocked();
+                _WaitLocked(_LastSubmitted);
+                _BeginBatch();
+            }
+            else
+                _WaitLocked(_Ring.OldestToken());
+
+            _Reclaim();
+        }
+        return Allocation;
+    }
+
+    void VulkanUploadManager::_StageImageCopy(VkImage Dst, const char *Src, VkDeviceSize Size, VkBufferImageCopy Copy)
+    {
+        // May have to flush and start a new batch, the image stays in TRANSFER_DST_OPTIMAL across them
+        VulkanStagingAllocation Staging = _AllocateStaging(Size);
+        _Ring.Write(Staging, Src, Size);
+
+        Copy.bufferOffset = Staging.Offset;
+        vkCmdCopyBufferToImage(_Recording.Cmd, Staging.Buffer, Dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Copy);
+        _Recording.Size += Size;
+    }
+
+    void VulkanUploadManager::_BeginBatch()
+    {
+        _Reclaim();
+
+        if (_FreeCommandBuffers.empty())
+        {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandBufferCount = 1;
+            allocInfo.commandPool = _Spec.CommandPool;
+
+            VULKAN_SUCCESS_ASSERT(vkAllocateCommandBuffers(_Spec.device, &allocInfo, &_Recording.Cmd), "Upload Command Buffer Failed!");
+        }
+        else
+        {
+            _Recording.Cmd = _FreeCommandBuffers.back();
+            _FreeCommandBuffers.pop_back();
+            vkResetCommandBuffer(_Recording.Cmd, 0);
+        }
+
+        _Recording.Token = _NextToken;
+        _Recording.Size = 0;
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(_Recording.Cmd, &beginInfo);
+        _IsRecording = true;
+    }
+
+    UploadToken VulkanUploadManager::_FlushLocked()
+    {
+        vkEndCommandBuffer(_Recording.Cmd);
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &_Recording.Token;
+
+        VkSubmitInfo submit{};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.pNext = &timelineInfo;
+        submit.commandBufferCount = 1;
+        submit.pCommandBuffers = &_Recording.Cmd;
+        submit.signalSemaphoreCount = 1;
+        submit.pSignalSemaphores = &_Timeline;
+
+        if (vkQueueSubmit(_Spec.Queue, 1, &submit, VK_NULL_HANDLE) != VK_SUCCESS)
+            throw std::runtime_error("failed to submit upload batch!");
+
+        _LastSubmitted = _Recording.Token;
+        _NextToken++;
+        _InFlight.push_back(std::move(_Recording));
+        _Recording = VulkanUploadBatch();
+        _IsRecording = false;
+
+        return _LastSubmitted;
+    }
+
+    void VulkanUploadManager::_Reclaim()
+    {
+        uint64_t Completed = 0;
+        vkGetSemaphoreCounterValue(_Spec.device, _Timeline, &Completed);
+        _Ring.Reclaim(Completed);
+
+        auto it = _InFlight.begin();
+        while (it != _InFlight.end())
+        {
+            if (it->Token > Completed)
+            {
+                it++;
+                continue;
+            }
+
+            _FreeCommandBuffers.push_back(it->Cmd);
+            it = _InFlight.erase(it);
+        }
+    }
+} // namespace VEngine
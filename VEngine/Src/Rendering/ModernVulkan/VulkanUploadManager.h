@@ -0,0 +1,85 @@
+#pragma once
+
+namespace VEngine
+{
+    struct VulkanUploadManagerSpec
+    {
+        VkDevice device;
+        VmaAllocator Allocator;
+        VkQueue Queue;
+        VkCommandPool CommandPool;
+        // Family of Queue and the one draws read uploaded resources on
+        uint32_t QueueFamily;
+        uint32_t GraphicsFamily;
+        // Batch gets submitted on its own once this many bytes are waiting in it
+        VkDeviceSize MaxBatchSize = 64 * 1024 * 1024;
+        VkDeviceSize StagingSizePerFrame = 32 * 1024 * 1024;
+        int FrameCount = 2;
+        // Offset alignment of every staging region, covers texel blocks of compressed formats
+        VkDeviceSize CopyAlignment = 16;
+    };
+
+    struct VulkanUploadBatch
+    {
+        VkCommandBuffer Cmd = VK_NULL_HANDLE;
+        UploadToken Token = 0;
+        VkDeviceSize Size = 0;
+    };
+
+    class VulkanUploadManager
+    {
+    public:
+        VulkanUploadManager() {}
+        ~VulkanUploadManager() {}
+
+        void Init(const VulkanUploadManagerSpec &Spec);
+        void Destroy();
+
+        // Records a copy into the open batch and returns without touching the queue
+        UploadToken UploadBuffer(VkBuffer Dst, const void *Data, VkDeviceSize Size, VkDeviceSize DstOffset = 0);
+        // Copies Data into Dst and leaves it in SHADER_READ_ONLY_OPTIMAL, regions are relative to the start of Data and
+        // tightly packed in Format. Big regions are split along block rows or array layers and streamed through the ring
+        UploadToken UploadImage(VkImage Dst, VkFormat Format, const void *Data, VkDeviceSize Size, const std::vector<VkBufferImageCopy> &Regions, uint32_t MipLevels = 1);
+
+        // Submits the open batch, returns the value the timeline will reach once it is done
+        UploadToken Flush();
+
+        bool IsComplete(UploadToken Token);
+        void Wait(UploadToken Token);
+
+        // Resources uploads write are read on the graphics queue. Created concurrent over both families when
+        // they differ, an exclusive one written on another family would need an ownership transfer every upload
+        void SetSharing(VkBufferCreateInfo &Info) const;
+        void SetSharing(VkImageCreateInfo &Info) const;
+        VkSharingMode GetSharingMode() const { return _Families.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE; }
+        const std::vector<uint32_t> &GetQueueFamilies() const { return _Families; }
+
+        VkSemaphore GetTimeline() const { return _Timeline; }
+        UploadToken GetLastSubmitted() const { return _LastSubmitted; }
+
+    private:
+        void _BeginBatch();
+        void _Reclaim();
+        UploadToken _FlushLocked();
+        VulkanStagingAllocation _AllocateStaging(VkDeviceSize Size);
+        void _StageImageCopy(VkImage Dst, const char *Src, VkDeviceSize Size, VkBufferImageCopy Copy);
+        void _WaitLocked(UploadToken Token);
+
+    private:
+        VulkanUploadManagerSpec _Spec;
+        std::vector<uint32_t> _Families;
+        VkSemaphore _Timeline = VK_NULL_HANDLE;
+        VulkanStagingRing _Ring;
+        // Largest piece a single upload is split into so big uploads stream through the ring
+        VkDeviceSize _ChunkSize = 0;
+
+        VulkanUploadBatch _Recording;
+        bool _IsRecording = false;
+        std::vector<VulkanUploadBatch> _InFlight;
+        std::vector<VkCommandBuffer> _FreeCommandBuffers;
+
+        UploadToken _NextToken = 1;
+        UploadToken _LastSubmitted = 0;
+        std::mutex _Mutex;
+    };
+} // namespace VEngine
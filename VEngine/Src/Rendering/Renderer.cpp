@@ -1,10 +1,14 @@
 #include "VePCH.h"
 #include "Window.h"
 #include "Renderer.h"
+#include "Trace.h"
 
+#ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
+#endif
 #include "vulkan.h"
 #include "ModernVulkan/VulkanRenderApi.h"
+#include "ModernVulkan/VulkanShader.h"
 
 namespace VEngine
 {
@@ -12,6 +16,8 @@ namespace VEngine
 
     void Renderer::Init(const RendererInitSpec &RenderSpec)
     {
+        // Set first, the backend creates its shaders during Init
+        _API = RenderSpec.Type;
         if (RenderSpec.Type == RenderAPIType::VULKAN)
         {
             Get().Api = new VulkanRenderApi();
@@ -19,14 +25,24 @@ namespace VEngine
             VulkanRenderSpec Spec;
             Spec.EnableValidationLayer = true;
             Spec.Name = "VEngine";
-            Spec.Win32Surface = RenderSpec.window->GetWin32Surface();
-            Spec.FrameBufferSize.x = RenderSpec.window->GetFrameBufferSize().x;
-            Spec.FrameBufferSize.y = RenderSpec.window->GetFrameBufferSize().y;
-            Spec.InFrameFlightCount = 2;
+            Spec.Headless = RenderSpec.Headless;
+            if (RenderSpec.Headless)
+            {
+                Spec.FrameBufferSize.x = RenderSpec.HeadlessWidth;
+                Spec.FrameBufferSize.y = RenderSpec.HeadlessHeight;
+            }
+            else
+            {
+                Spec.Win32Surface = RenderSpec.window->GetWin32Surface();
+                Spec.FrameBufferSize.x = RenderSpec.window->GetFrameBufferSize().x;
+                Spec.FrameBufferSize.y = RenderSpec.window->GetFrameBufferSize().y;
+            }
+            Spec.InFrameFlightCount = std::max(RenderSpec.FramesInFlightCount, 1);
+            Spec.PreferredPresentMode = RenderSpec.PreferredPresentMode;
+            Spec.MaxFrameRate = RenderSpec.MaxFrameRate;
 
             Get().Api->Init((void *)&Spec);
         }
-        _API = RenderSpec.Type;
     }
 
     void Renderer::Terminate()
@@ -37,6 +53,7 @@ namespace VEngine
 
     void Renderer::Render()
     {
+        VENGINE_TRACE_SCOPE("Renderer::Render")
         Get().Api->Render();
     }
 
@@ -47,21 +64,29 @@ namespace VEngine
 
     void Renderer::Begin(const RenderPassSpec &Spec)
     {
+        VENGINE_TRACE_SCOPE("Renderer::Begin")
         Get().Api->Begin(Spec);
     }
 
     void Renderer::End()
     {
+        VENGINE_TRACE_SCOPE("Renderer::End")
         Get().Api->End();
     }
 
-    void Renderer::Submit(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer>& IB)
+    void Renderer::Submit(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer>& IB, const DrawParams &Params)
     {
-        Get().Api->Submit(VB, IB);
+        Get().Api->Submit(VB, IB, Params);
+    }
+
+    void Renderer::SubmitBatched(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer>& IB, const DrawParams &Params)
+    {
+        Get().Api->SubmitBatched(VB, IB, Params);
     }
 
     void Renderer::Present()
     {
+        VENGINE_TRACE_SCOPE("Renderer::Present")
         Get().Api->Present();
     }
 
@@ -70,8 +95,117 @@ namespace VEngine
         Get().Api->Finish();
     }
 
+    std::shared_ptr<Shader> Shader::Create(const ShaderSpec &Spec)
+    {
+        if (_API == RenderAPIType::VULKAN)
+        {
+            // Missing files and bad specs throw out of Prepare, compile errors are logged by Resolve
+            auto shader = std::make_shared<VulkanShader>();
+            try
+            {
+                if (!shader->Init(Spec))
+                    return nullptr;
+            }
+            catch (const std::exception &e)
+            {
+                VENGINE_PRINTLN("[VULKAN]: Shader " << Spec.Name << " failed: " << e.what());
+                return nullptr;
+            }
+            return shader;
+        }
+        return nullptr;
+    }
+
+    std::vector<std::shared_ptr<Shader>> Shader::CreateMany(const std::vector<ShaderSpec> &Specs)
+    {
+        std::vector<std::shared_ptr<Shader>> Shaders;
+        if (_API != RenderAPIType::VULKAN)
+            return Shaders;
+
+        // Kick off every miss before waiting on any of them, one that can't even start is just left out
+        std::vector<std::shared_ptr<VulkanShader>> Pending;
+        for (auto &Spec : Specs)
+        {
+            Pending.push_back(std::make_shared<VulkanShader>());
+            try
+            {
+                Pending.back()->Prepare(Spec);
+            }
+            catch (const std::exception &e)
+            {
+                VENGINE_PRINTLN("[VULKAN]: Shader " << Spec.Name << " failed: " << e.what());
+                Pending.back() = nullptr;
+            }
+        }
+
+        for (auto &shader : Pending)
+            Shaders.push_back(shader && shader->Resolve() ? shader : nullptr);
+        return Shaders;
+    }
+
     Ref<ResourceFactory> Renderer::__GetResouceFactory()
     {
         return Get().Api->GetResourceFactory();
     }
+
+    RendererStats Renderer::GetStats()
+    {
+        return Get().Api->GetStats();
+    }
+
+    std::vector<GpuScopeTiming> Renderer::GetGpuTimings()
+    {
+        return Get().Api->GetGpuTimings();
+    }
+
+    void Renderer::SetPipelineStatistics(bool Enabled)
+    {
+        Get().Api->SetPipelineStatistics(Enabled);
+    }
+
+    void Renderer::SetOverdrawMode(bool Enabled)
+    {
+        Get().Api->SetOverdrawMode(Enabled);
+    }
+
+    std::vector<uint32_t> Renderer::GetOverdrawHistogram()
+    {
+        return Get().Api->GetOverdrawHistogram();
+    }
+
+    uint64_t Renderer::GetSubmittedFrame()
+    {
+        return Get().Api->GetSubmittedFrame();
+    }
+
+    uint64_t Renderer::GetCompletedFrame()
+    {
+        return Get().Api->GetCompletedFrame();
+    }
+
+    void Renderer::WaitForFrame(uint64_t Frame)
+    {
+        Get().Api->WaitForFrame(Frame);
+    }
+
+    void Renderer::SetMemoryBudgetCallback(const MemoryBudgetCallback &Callback)
+    {
+        Get().Api->SetMemoryBudgetCallback(Callback);
+    }
+
+    void Renderer::SetPresentMode(PresentMode Mode)
+    {
+        Get().Api->SetPresentMode(Mode);
+    }
+
+    void Renderer::SetFrameRateLimit(float MaxFrameRate)
+    {
+        Get().Api->SetFrameRateLimit(MaxFrameRate);
+    }
+
+    void Renderer::WaitForNextFrame()
+    {
+        VENGINE_TRACE_SCOPE("Renderer::WaitForNextFrame")
+        Get().Api->WaitForNextFrame();
+    }
 } // namespace VEngine
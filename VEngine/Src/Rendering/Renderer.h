@@ -9,8 +9,13 @@ namespace VEngine
         RenderAPIType Type;
         Window* window;
         // Sepcifices the max number of in flight frames
-        int FramesInFlightCount;
-        
+        int FramesInFlightCount = 2;
+        // No window needed, frames go to offscreen images of HeadlessWidth x HeadlessHeight
+        bool Headless = false;
+        int HeadlessWidth = 1280, HeadlessHeight = 720;
+        PresentMode PreferredPresentMode = PresentMode::MAILBOX;
+        // Frames per second, 0 is unlimited
+        float MaxFrameRate = 0.0f;
     };
 
     class Renderer
@@ -29,10 +34,23 @@ namespace VEngine
 
         static void Begin(const RenderPassSpec& Spec);
         static void End();
-        static void Submit(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer>& IB);
+        static void Submit(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer>& IB, const DrawParams &Params = DrawParams());
+        static void SubmitBatched(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer>& IB, const DrawParams &Params = DrawParams());
         static void Present();
         static void Finish();
         static Ref<ResourceFactory> __GetResouceFactory();
+        static RendererStats GetStats();
+        static std::vector<GpuScopeTiming> GetGpuTimings();
+        static void SetPipelineStatistics(bool Enabled);
+        static void SetOverdrawMode(bool Enabled);
+        static std::vector<uint32_t> GetOverdrawHistogram();
+        static uint64_t GetSubmittedFrame();
+        static uint64_t GetCompletedFrame();
+        static void WaitForFrame(uint64_t Frame);
+        static void SetMemoryBudgetCallback(const MemoryBudgetCallback &Callback);
+        static void SetPresentMode(PresentMode Mode);
+        static void SetFrameRateLimit(float MaxFrameRate);
+        static void WaitForNextFrame();
 
     private:
         RendererAPI *Api;
@@ -11,6 +11,118 @@ namespace VEngine
         {
             float x, y, z, w;
         } ClearColor;
+
+        // Camera for every draw in the pass, uploaded once per frame. Projection is GL style,
+        // the backend flips it for its own clip space
+        glm::mat4 View = glm::mat4(1.0f);
+        glm::mat4 Projection = glm::mat4(1.0f);
+    };
+
+    // Small per draw data, sent with the draw itself instead of through a buffer
+    struct DrawParams
+    {
+        glm::mat4 Transform = glm::mat4(1.0f);
+        glm::vec4 Tint = glm::vec4(1.0f);
+        // Object space bounding sphere (center, radius) batched draws are culled with,
+        // negative radius is always drawn
+        glm::vec4 Bounds = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+        // Null draws with the default texture. Bounds also decide how many of its mips get streamed in
+        Ref<VEngine::Texture> Texture;
+    };
+
+    // Counters the backend fills in, read through Renderer::GetStats
+    struct RendererStats
+    {
+        uint32_t PipelineCacheHits = 0;
+        uint32_t PipelineCacheMisses = 0;
+        // Bytes of per draw data written in the current frame
+        uint64_t FrameAllocatorUsed = 0;
+        // Draws that went through SubmitBatched last frame and the indirect calls they became
+        uint32_t BatchedDraws = 0;
+        uint32_t IndirectBatches = 0;
+        // Batched draws that didn't fit the frame allocator and went out one by one, it grows after
+        uint32_t SpilledDraws = 0;
+        uint64_t FrameAllocatorSize = 0;
+        // Destroyed resources still waiting for the gpu to finish with them
+        uint32_t PendingDeletions = 0;
+        // Gpu time of the last frame the profiler read back, a few frames behind
+        float GpuFrameMs = 0.0f;
+        // Texture streaming, memory of resident mips against the budget it keeps them under
+        uint64_t StreamedTextureBytes = 0;
+        uint64_t StreamingBudget = 0;
+        uint32_t PendingTextureLoads = 0;
+        // Device local memory in use against the budget the driver gives the process
+        uint64_t GpuMemoryUsage = 0;
+        uint64_t GpuMemoryBudget = 0;
+        // Buffers moved by defragmentation so far and their bytes
+        uint32_t DefragmentationMoves = 0;
+        uint64_t DefragmentedBytes = 0;
+        // Static mesh data in the shared geometry buffers against their total size
+        uint64_t GeometryPoolUsed = 0;
+        uint64_t GeometryPoolCapacity = 0;
+        // Render graph of the last frame, barriers it recorded and passes it culled
+        uint32_t RenderGraphBarriers = 0;
+        uint32_t CulledPasses = 0;
+        // Memory of the render graph's transient targets, the aliased heap against what they'd take unaliased
+        uint64_t TransientTargetHeap = 0;
+        uint64_t TransientTargetBytes = 0;
+        // Share of the window's width and height the scene was drawn at
+        float RenderScale = 1.0f;
+        // Cpu time the frame pacer held the last frame back for present wait and the frame rate limit
+        float FramePacingMs = 0.0f;
+    };
+
+    enum class MemoryPressure
+    {
+        NONE,
+        // Past the soft budget, time to drop caches and lower streaming quality
+        SOFT,
+        // Close to the budget, allocations past it may fail or get paged out by the driver
+        HARD
+    };
+
+    struct MemoryBudgetInfo
+    {
+        uint64_t Usage = 0;
+        uint64_t Budget = 0;
+        MemoryPressure Pressure = MemoryPressure::NONE;
+    };
+
+    using MemoryBudgetCallback = std::function<void(const MemoryBudgetInfo &)>;
+
+    // Shader work counted by the gpu inside a scope
+    struct PipelineStatistics
+    {
+        uint64_t VertexInvocations = 0;
+        uint64_t ClippingInvocations = 0;
+        uint64_t ClippingPrimitives = 0;
+        uint64_t FragmentInvocations = 0;
+        uint64_t ComputeInvocations = 0;
+    };
+
+    // One profiler scope of a finished frame, start is relative to the frame's first scope
+    struct GpuScopeTiming
+    {
+        std::string Name;
+        uint32_t Depth;
+        float StartMs;
+        float DurationMs;
+        // Only for the frame's pass scopes while pipeline statistics are on
+        bool HasStatistics = false;
+        PipelineStatistics Statistics;
+    };
+
+    // How finished frames reach the display, a mode the surface lacks falls back to the closest it has
+    enum class PresentMode
+    {
+        // Waits for vblank and queues up, never tears. Always there
+        FIFO,
+        // Fifo, but a frame that missed its vblank is shown at once and may tear
+        FIFO_RELAXED,
+        // Waits for vblank, newer frames replace the queued one so the cpu never blocks on it
+        MAILBOX,
+        // Shown at once, tears
+        IMMEDIATE
     };
 
     enum class RenderAPIType
@@ -31,13 +143,41 @@ namespace VEngine
         virtual void Render() = 0;
         virtual void FrameBufferResize(int x, int y) = 0;
 
-        virtual void Submit(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer>& IB) = 0;
+        virtual void Submit(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer>& IB, const DrawParams &Params) = 0;
+        // Queued till End and drawn with the other batched draws in as few calls as possible
+        virtual void SubmitBatched(const Ref<VertexBuffer> &VB, const Ref<IndexBuffer>& IB, const DrawParams &Params) = 0;
         virtual void Present() = 0;
         virtual void Begin(const RenderPassSpec& Spec) = 0;
         virtual void End() = 0;
         virtual void Finish() = 0;
 
         virtual Ref<ResourceFactory> GetResourceFactory() = 0;
+        virtual RendererStats GetStats() = 0;
+        // Empty when the device can't do timestamps
+        virtual std::vector<GpuScopeTiming> GetGpuTimings() = 0;
+
+        // Instrumentation, both can be flipped any frame and are ignored when the device can't do them
+        virtual void SetPipelineStatistics(bool Enabled) = 0;
+        // Draws count how often every pixel gets shaded instead of shading it
+        virtual void SetOverdrawMode(bool Enabled) = 0;
+        // Pixels per overdraw count, last bin holds everything at or above it. A few frames behind
+        virtual std::vector<uint32_t> GetOverdrawHistogram() = 0;
+
+        // Frames are numbered from 1 in submit order, meant for headless runs that have nothing to present
+        virtual uint64_t GetSubmittedFrame() = 0;
+        virtual uint64_t GetCompletedFrame() = 0;
+        // Blocks until the gpu finished Frame
+        virtual void WaitForFrame(uint64_t Frame) = 0;
+
+        // Called on the render thread whenever device local usage crosses into another pressure level
+        virtual void SetMemoryBudgetCallback(const MemoryBudgetCallback &Callback) = 0;
+
+        // The swapchain is rebuilt with it at the next Begin
+        virtual void SetPresentMode(PresentMode Mode) = 0;
+        // Frames per second the cpu starts at most, 0 is unlimited
+        virtual void SetFrameRateLimit(float MaxFrameRate) = 0;
+        // Blocks until the next frame should start, call it before reading input. Begin does it for loops that don't
+        virtual void WaitForNextFrame() = 0;
     private:
     };
 } // namespace VEngine
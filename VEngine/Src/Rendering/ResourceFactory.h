@@ -16,6 +16,10 @@ namespace VEngine
         virtual bool DeleteVertexBuffer(const Ref<VertexBuffer>& VB) = 0;
         virtual bool DeleteIndexBuffer(const Ref<IndexBuffer>& IB) = 0;
 
+        // Returns right away, draws use a default texture until the first mips are in
+        virtual Ref<Texture> CreateTexture(const TextureDesc& desc) = 0;
+        virtual bool DeleteTexture(const Ref<Texture>& Tex) = 0;
+
     private:
     };
 } // namespace VEngine
@@ -36,12 +36,24 @@ namespace VEngine
         int location = 0;
     };
 
+    struct ShaderDefine
+    {
+        std::string Name;
+        std::string Value;
+    };
+
     struct ShaderSpec
     {
         std::vector<std::string> Paths;
         std::vector<ShaderType> UsingTypes;
         std::vector<VertexBufferAttrib> Attribs;
         std::string Name;
+
+        std::vector<ShaderDefine> Defines;
+        bool Optimize = true;
+        bool DebugInfo = false;
+        // Compiled SPIR-V is kept here, named by the hash of its inputs
+        std::string CacheDirectory = "ShaderCache";
     };
 
     struct GraphicsShaderDesc
@@ -60,6 +72,8 @@ namespace VEngine
 
         const UUID &ID() const { return _ID; }
         static std::shared_ptr<Shader> Create(const ShaderSpec &Spec);
+        // Same as Create but every cache miss of every spec compiles in parallel
+        static std::vector<std::shared_ptr<Shader>> CreateMany(const std::vector<ShaderSpec> &Specs);
 
     private:
         UUID _ID;
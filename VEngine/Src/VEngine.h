@@ -5,6 +5,7 @@
 #include "Window.h"
 #include "Input.h"
 #include "Timer.h"
+#include "Trace.h"
 #include "Timestep.h"
 #include "UUID.h"
 // ---- Maths ----
@@ -10,5 +10,6 @@
 #include <memory>
 #include <functional>
 #include <optional>
+#include <future>
 
 #include "Log.h"
@@ -127,14 +127,6 @@ namespace VEngine
         _Data.Data.Name = Data.Name;
         _Data.Data.Dimensions = Data.Dimensions;
         _Data.Data.VSync = Data.VSync;
-
-        if (GLFW_INIT == false)
-        {
-            int Success = glfwInit();
-            if (Success == GLFW_FALSE)
-                VENGINE_ERROR("GLFW init couldnot be done!")
-        }
-        GLFW_INIT = true;
     }
 
     Window::~Window()
@@ -173,6 +165,15 @@ namespace VEngine
 
     void Window::Init(const WindowData &Data)
     {
+        // Not in the constructor, a headless app never creates a window and may have no display
+        if (GLFW_INIT == false)
+        {
+            int Success = glfwInit();
+            if (Success == GLFW_FALSE)
+                VENGINE_ERROR("GLFW init couldnot be done!")
+        }
+        GLFW_INIT = true;
+
         _Data.Data = Data;
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 
@@ -1,14 +1,16 @@
 #include "VePCH.h"
 #include "Application.h"
 
+#include <glm/gtc/matrix_transform.hpp>
+
 namespace VEngine
 {
 
     class Editor : public Layer
     {
     public:
-        Editor()
-            : Layer("Editor")
+        Editor(const Vec2 &FrameBufferSize)
+            : Layer("Editor"), _Aspect(FrameBufferSize.x / FrameBufferSize.y)
         {
         }
         ~Editor()
@@ -58,11 +60,20 @@ namespace VEngine
             VENGINE_APP_PRINTLN("Fps:  " << ts.GetFPS() << " Time: " << ts.GetMilliSecond());
 
             // TODO: Rename
+            _Time += ts.GetSecond();
+
             RenderPassSpec Spec;
             Spec.ClearColor = {0.2, 0.2, 0.2, 1.0f};
+            Spec.View = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+            Spec.Projection = glm::perspective(glm::radians(45.0f), _Aspect, 0.1f, 10.0f);
+
+            DrawParams Params;
+            Params.Transform = glm::rotate(glm::mat4(1.0f), _Time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+            // Sphere around both quads
+            Params.Bounds = glm::vec4(0.0f, 0.0f, -0.25f, 0.75f);
 
             Renderer::Begin(Spec);
-            Renderer::Submit(_TriangleVB, _TriangleIB);
+            Renderer::SubmitBatched(_TriangleVB, _TriangleIB, Params);
             Renderer::End();
 
             Renderer::Render(); // to a framebuffer
@@ -80,11 +91,20 @@ namespace VEngine
         {
             if (e.GetType() == WindowResizeEvent::GetStaticType())
                 VENGINE_APP_PRINTLN("Window Resize")
+            if (e.GetType() == FrameBufferResizeEvent::GetStaticType())
+            {
+                auto &fbe = static_cast<FrameBufferResizeEvent &>(e);
+                // Minimized windows report 0
+                if (fbe.GetY() > 0)
+                    _Aspect = fbe.GetX() / (float)fbe.GetY();
+            }
         }
 
     private:
         Ref<VertexBuffer> _TriangleVB;
         Ref<IndexBuffer> _TriangleIB;
+        float _Aspect = 1.0f;
+        float _Time = 0.0f;
     };
 }; // namespace VEngine
 
@@ -97,7 +117,7 @@ int main(int argc, char const *argv[])
 
     VEngine::Application app;
     app.OnInit(Spec);
-    app.PushLayer(std::make_shared<VEngine::Editor>());
+    app.PushLayer(std::make_shared<VEngine::Editor>(Spec.Dimensions));
 
     app.OnUpdate();
     app.OnTerminate();